@@ -14,12 +14,22 @@
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 #include <algorithm> // For std::remove_if
 #include <list>
+#include <set>
+#include <map>
+#include <unordered_map>
+#include <memory>
+#include <condition_variable>
+#include <poll.h>
 #include "octopus_ipc_app_client.hpp"
 
 // #define OCTOPUS_MESSAGE_BUS
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 void ipc_redirect_log_to_file();
+void ipc_send_subscribed_topics();
+void ipc_request_shm_transport();
+void ipc_request_container_frames();
+void ipc_container_window_loop();
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 const std::string ipc_server_path_name = "/res/bin/octopus_ipc_server";
@@ -47,6 +57,60 @@ struct CallbackEntry
 
 std::list<CallbackEntry> g_named_callbacks;
 
+struct ViewCallbackEntry
+{
+    std::string func_name;
+    OctopusAppViewCallback cb;
+};
+
+// Copied on register/unregister, so the receiving thread walks it without locking or allocating
+std::shared_ptr<const std::vector<ViewCallbackEntry>> g_view_callbacks = std::make_shared<const std::vector<ViewCallbackEntry>>();
+
+// Requests sent with ipc_send_request() waiting for their reply, by request id
+struct PendingRequest
+{
+    OctopusAppReplyCallback cb;
+    void *context;
+};
+std::unordered_map<uint32_t, PendingRequest> g_pending_requests;
+std::mutex pending_requests_mutex;
+std::atomic<uint32_t> g_next_request_id{1};
+
+// Topics (group << 8 | msg_id) this client subscribed to, re-sent after every reconnect
+std::set<uint16_t> g_subscribed_topics;
+std::map<uint16_t, uint16_t> g_topic_intervals; // Topic -> push interval in ms, re-sent as well
+uint16_t g_keyframe_interval_ms = 0;            // Keyframe interval in ms, re-sent as well
+std::mutex subscribed_topics_mutex;
+
+// Read-only mapping of the server state snapshots, opened on first use
+OctopusShmSnapshotReader g_snapshot_reader;
+std::atomic<bool> g_snapshot_reader_ready{false};
+std::mutex snapshot_reader_mutex;
+
+// Shared memory transport, see ipc_enable_shm_transport()
+OctopusShmChannel g_shm_channel;  // Open once the server accepted, closed with the connection
+std::mutex shm_channel_mutex;     // Serializes senders, opening and closing (the receiver thread reads without it)
+std::atomic<uint32_t> g_shm_ring_bytes{0}; // Requested ring size, 0 for the socket only
+
+// Push frames read from the server broadcast ring, see ipc_enable_broadcast_ring()
+std::atomic<bool> g_broadcast_running{false};
+std::thread ipc_broadcast_thread;
+
+// Transport of the next connection, see ipc_enable_seqpacket_transport()
+std::atomic<int> g_socket_type{SOCK_STREAM};
+int g_connected_socket_type = SOCK_STREAM; // Transport of the current connection (receiver thread only)
+std::vector<uint8_t> g_packet_buffer;      // One whole seqpacket, allocated with the first such connection
+
+// Outbound container frames, see ipc_enable_container_frames()
+std::atomic<uint32_t> g_container_window_us{0}; // 0: every queued message is sent on its own
+FrameContainerBuilder g_container_builder;      // Messages queued during the current window
+std::mutex container_mutex;                     // Guards the container state below, held while it is sent
+std::condition_variable container_cv;           // Wakes the container window thread
+bool container_window_open = false;             // The window thread sends the builder at container_window_end
+std::chrono::steady_clock::time_point container_window_end;
+bool container_thread_running = false;
+std::thread ipc_container_thread; // Ends the container windows, see ipc_container_window_loop()
+
 #ifdef OCTOPUS_MESSAGE_BUS
 // Create an instance of the message bus
 OctopusMessageBus *g_message_bus = &OctopusMessageBus::instance();
@@ -198,6 +262,50 @@ void ipc_init_threadpool()
 }
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Writes one frame into the open shared memory channel, shm_channel_mutex held. A full tx ring
+// parks the writer until the server made room: the frame never goes out on the socket, where it
+// could overtake the frames still in the ring. Returns false if the ring stayed full.
+bool ipc_app_send_shm_locked(const void *data, size_t length)
+{
+    constexpr int wait_interval_ms = 10;   // The receiver thread may consume the wakeup, so look again
+    constexpr int max_wait_time_ms = 2000; // Server not draining its rx ring: drop the frame
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(max_wait_time_ms);
+    while (!g_shm_channel.send(data, length))
+    {
+        // send() parked the writer, the server signals the wake fd once it read from the ring
+        if (std::chrono::steady_clock::now() >= deadline || !socket_running.load())
+        {
+            std::cerr << "Client: Shared memory ring stayed full, dropped a frame of " << length << " bytes.\n";
+            return false;
+        }
+        pollfd fd = {g_shm_channel.get_wake_fd(), POLLIN, 0};
+        if (poll(&fd, 1, wait_interval_ms) < 0 && errno != EINTR)
+            return false;
+    }
+    return true;
+}
+
+// Sends a message through the shared memory channel once it is open, otherwise on the socket.
+// The whole connection switches transports, so the frames of one sender stay in order.
+bool ipc_app_send_message(const DataMessage &message)
+{
+    {
+        std::lock_guard<std::mutex> lock(shm_channel_mutex);
+        if (g_shm_channel.is_open())
+        {
+            // Small frames are serialized on the stack, the ring copies them anyway
+            uint8_t frame[DataMessage::EXTENDED_HEADER_LENGTH + DATA_MESSAGE_INLINE_CAPACITY + 1];
+            size_t length = message.serializeInto(frame, sizeof(frame));
+            if (length > 0)
+                return ipc_app_send_shm_locked(frame, length);
+
+            std::vector<uint8_t> serialized_data = message.serializeMessage();
+            return ipc_app_send_shm_locked(serialized_data.data(), serialized_data.size());
+        }
+    }
+    return client.send_message(socket_client.load(), message);
+}
+
 // Send a query to the server with additional data
 void ipc_app_send_query(uint8_t group, uint8_t msg, const std::vector<uint8_t> &query_array)
 {
@@ -214,8 +322,7 @@ void ipc_app_send_query(uint8_t group, uint8_t msg, const std::vector<uint8_t> &
     query_msg.msg_length = query_msg.data.size();
 
     query_msg.printMessage("Send query");
-    std::vector<uint8_t> serialized_data = query_msg.serializeMessage();
-    client.send_query(socket_client.load(), serialized_data);
+    ipc_app_send_message(query_msg);
 }
 
 // Send a command to the server with additional data
@@ -231,9 +338,9 @@ void ipc_app_send_command(uint8_t group, uint8_t msg, const std::vector<uint8_t>
     query_msg.msg_group = group;
     query_msg.msg_id = msg;
     query_msg.data = parameters;
+    query_msg.msg_length = query_msg.data.size();
 
-    std::vector<uint8_t> serialized_data = query_msg.serializeMessage();
-    client.send_query(socket_client.load(), serialized_data);
+    ipc_app_send_message(query_msg);
 }
 /**
  * @brief Registers a callback function to be invoked upon receiving a response.
@@ -289,6 +396,32 @@ void ipc_unregister_socket_callback(OctopusAppResponseCallback callback)
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+void ipc_register_view_callback(std::string func_name, OctopusAppViewCallback callback)
+{
+    if (!callback)
+        return;
+
+    std::lock_guard<std::mutex> lock(callback_mutex);
+    auto callbacks = std::make_shared<std::vector<ViewCallbackEntry>>(*std::atomic_load(&g_view_callbacks));
+    callbacks->push_back({func_name, callback});
+    std::atomic_store(&g_view_callbacks, std::shared_ptr<const std::vector<ViewCallbackEntry>>(callbacks));
+    LOG_CC("Client: Registered view callback: " + func_name);
+}
+
+void ipc_unregister_view_callback(OctopusAppViewCallback callback)
+{
+    std::lock_guard<std::mutex> lock(callback_mutex);
+    auto callbacks = std::make_shared<std::vector<ViewCallbackEntry>>(*std::atomic_load(&g_view_callbacks));
+    callbacks->erase(std::remove_if(callbacks->begin(), callbacks->end(),
+                                    [callback](const ViewCallbackEntry &entry)
+                                    { return entry.cb == callback; }),
+                     callbacks->end());
+    std::atomic_store(&g_view_callbacks, std::shared_ptr<const std::vector<ViewCallbackEntry>>(callbacks));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+
 /**
  * @brief Invokes the registered callback function with the received response data.
  * @param response The received response vector.
@@ -306,6 +439,11 @@ void ipc_invoke_notify_response(const DataMessage &query_msg, int size)
             active_callbacks.emplace_back(std::make_shared<CallbackEntry>(entry)); // 深拷贝或用智能指针
         }
     }
+    if (active_callbacks.empty())
+        return;
+
+    // One copy of the message shared by all the queued callbacks
+    auto message = std::make_shared<const DataMessage>(query_msg);
 
     constexpr int FAILURE_THRESHOLD = 3;
 
@@ -313,13 +451,13 @@ void ipc_invoke_notify_response(const DataMessage &query_msg, int size)
     {
         // 拷贝数据进入 lambda，确保线程安全
         auto entry_copy = entry_ptr; // shared_ptr 捕获引用计数++
-        g_threadPool.enqueue([entry_copy, query_msg, size]()
+        g_threadPool.enqueue([entry_copy, message, size]()
                              {
             try
             {
                 //一毫秒高频压力测试
                 //std::this_thread::sleep_for(std::chrono::milliseconds(50));
-                entry_copy->cb(query_msg, size); // 执行回调
+                entry_copy->cb(*message, size); // 执行回调
             }
             catch (const std::exception &e)
             {
@@ -357,12 +495,82 @@ void ipc_invoke_notify_response(const DataMessage &query_msg, int size)
     // g_threadPool.print_pool_status(); // test
 }
 
+/**
+ * @brief Hands a received frame to the callbacks.
+ *
+ * View callbacks see the frame in place. An owning copy is only made if response callbacks are
+ * registered, they run later on the thread pool.
+ */
+void ipc_dispatch_response(const DataMessageView &message)
+{
+    if (message.request_id != 0)
+    {
+        // A reply: its request may be waiting with a callback of its own
+        PendingRequest request{nullptr, nullptr};
+        {
+            std::lock_guard<std::mutex> lock(pending_requests_mutex);
+            auto it = g_pending_requests.find(message.request_id);
+            if (it != g_pending_requests.end())
+            {
+                request = it->second;
+                g_pending_requests.erase(it);
+            }
+        }
+        if (request.cb)
+        {
+            try
+            {
+                request.cb(message, request.context);
+            }
+            catch (const std::exception &e)
+            {
+                LOG_CC(std::string("Reply callback exception: ") + e.what());
+            }
+            return;
+        }
+    }
+
+    // The state did not change since the last conditional GET: nothing to decode or redraw
+    if (message.msg_group == MSG_GROUP_CAR && message.msg_id == MSG_IPC_CMD_CAR_NOT_MODIFIED)
+        return;
+
+    std::shared_ptr<const std::vector<ViewCallbackEntry>> view_callbacks = std::atomic_load(&g_view_callbacks);
+    for (const ViewCallbackEntry &entry : *view_callbacks)
+    {
+        try
+        {
+            entry.cb(message);
+        }
+        catch (const std::exception &e)
+        {
+            LOG_CC("View callback [" + entry.func_name + "] exception: " + e.what());
+        }
+    }
+
+    bool has_response_callbacks;
+    {
+        std::lock_guard<std::mutex> lock(callback_mutex);
+        has_response_callbacks = !g_named_callbacks.empty();
+    }
+    if (has_response_callbacks)
+        ipc_invoke_notify_response(message.to_message(), message.get_total_length());
+}
+
 /**
  * @brief Attempts to reconnect to the server if the connection is lost.
  */
 void ipc_reconnect_to_server()
 {
-    // Close the old connection
+    // Close the old connection, the shared memory channel belonged to it
+    {
+        std::lock_guard<std::mutex> lock(shm_channel_mutex);
+        g_shm_channel.close();
+    }
+    // Its pending requests will never be answered
+    {
+        std::lock_guard<std::mutex> lock(pending_requests_mutex);
+        g_pending_requests.clear();
+    }
     int socket_fd = socket_client.load();
     // Close previous socket connection if exists
     client.close_socket(socket_fd);
@@ -376,7 +584,8 @@ void ipc_reconnect_to_server()
     }
     // Step 1: Initialize a new socket
     // Try to reopen the socket and connect to the server
-    socket_fd = client.open_socket(AF_UNIX, SOCK_STREAM, 0);
+    int socket_type = g_socket_type.load();
+    socket_fd = client.open_socket(AF_UNIX, socket_type, 0);
     if (socket_fd < 0)
     {
         std::cout << "Client: Failed to open socket. Retrying...\n";
@@ -394,11 +603,14 @@ void ipc_reconnect_to_server()
         client.close_socket(socket_fd);
         return;
     }
+    g_connected_socket_type = socket_type;
+    if (socket_type == SOCK_SEQPACKET && g_packet_buffer.empty())
+        g_packet_buffer.resize(IPC_SOCKET_PACKET_BUFFER_SIZE);
     socket_client.store(socket_fd);
 
     // Step 4: Try to connect to the serve
     // Try to connect to the IPC server
-    int connect_result = client.connect_to_socket(socket_fd, ipc_socket_path_name);
+    int connect_result = client.connect_to_socket(socket_fd, socket_type == SOCK_SEQPACKET ? IPC_SOCKET_SEQPACKET_PATH : ipc_socket_path_name);
     if (connect_result < 0)
     {
         std::cout << "Client: Failed to reconnect to the server. Retrying...\n";
@@ -407,82 +619,95 @@ void ipc_reconnect_to_server()
     {
         std::cout << "Client: Successfully reconnected to the server.\n";
         // If data pushing is required, start the request to push data
+        ipc_send_subscribed_topics();
+        ipc_request_shm_transport();
+        ipc_request_container_frames();
+        if (g_broadcast_running.load())
+            ipc_app_send_command(MSG_GROUP_IPC_CONFIG, MSG_IPC_CMD_CONFIG_BROADCAST_RING, {1});
     }
 }
 
-// Function to check if data packet is complete
-DataMessage ipc_check_complete_data_packet(std::vector<uint8_t> &buffer, DataMessage &query_msg)
+/**
+ * @brief Continuously listens for incoming responses from the server.
+ * If the connection is lost, the client attempts to reconnect automatically.
+ */
+std::string bool_to_string(bool value)
 {
-    // Reset to invalid state (used for isValid() check later)
-    query_msg.msg_group = -1;
-    query_msg.msg_id = -1;
-
-    const size_t baseLength = query_msg.get_base_length(); // Expected minimum size (header + group + msg + length)
-
-    // If buffer is too small to even contain the base structure, skip processing
-    if (buffer.size() < baseLength)
-        return query_msg;
+    return value ? "true" : "false";
+}
 
-    // Scan the first max_scan bytes to find a valid header and trim junk before it
-    constexpr size_t max_scan = 20;
-    bool header_found = false;
-    for (size_t i = 0; i + 1 < buffer.size() && i < max_scan; ++i)
+// Takes over the channel passed along with a MSG_IPC_CMD_CONFIG_SHM_RING reply, receiver thread only
+void ipc_attach_shm_transport(const DataMessageView &reply, std::vector<int> &received_fds)
+{
+    bool accepted = !reply.data.empty() && reply.data[0] == 1 && received_fds.size() >= SHM_CHANNEL_FD_COUNT;
+    if (!accepted)
     {
-        uint16_t header = (buffer[i] << 8) | buffer[i + 1];
-        if (header == query_msg._HEADER_)
-        {
-            if (i > 0)
-                buffer.erase(buffer.begin(), buffer.begin() + i); // Remove junk bytes before header
-            header_found = true;
-            break;
-        }
+        std::cout << "Client: Server kept the socket transport.\n";
+        return;
     }
 
-    // If no valid header found, erase scanned bytes to avoid buffer bloating
-    if (!header_found)
+    bool attached;
     {
-        size_t remove_count = std::min(buffer.size(), max_scan);
-        buffer.erase(buffer.begin(), buffer.begin() + remove_count);
-        return query_msg;
+        std::lock_guard<std::mutex> lock(shm_channel_mutex);
+        attached = g_shm_channel.attach(received_fds.data());
+    }
+    received_fds.erase(received_fds.begin(), received_fds.begin() + SHM_CHANNEL_FD_COUNT);
+    if (attached)
+    {
+        std::cout << "Client: Switched to shared memory rings of " << g_shm_channel.get_capacity() << " bytes.\n";
+        return;
     }
 
-    // Now that the header is aligned at buffer[0], ensure we can read the full base structure
-    if (buffer.size() < baseLength)
-        return query_msg;
-
-    // Peek into the buffer to get the length field only (without deserializing the full message)
-    uint16_t length = (static_cast<uint16_t>(buffer[4]) << 8) | buffer[5];
-    size_t totalLength = baseLength + length;
-
-    // If the buffer is still not large enough for the full message, wait for more data
-    if (buffer.size() < totalLength)
-        return query_msg;
-
-    // Now we have enough bytes, safely deserialize the message
-    query_msg = DataMessage::deserializeMessage(buffer);
+    // The server already writes into the rings, only a new connection recovers: stay on the socket then
+    std::cerr << "Client: Failed to map the shared memory rings, reconnecting on the socket only.\n";
+    g_shm_ring_bytes.store(0);
+    ipc_reconnect_to_server();
+}
 
-    // Verify integrity using isValid()
-    if (!query_msg.isValid())
-        return query_msg;
+// Waits for frames on the shared memory channel. The socket is still watched for a hang-up.
+// Returns false once the connection is lost.
+bool ipc_receive_shm_frames(FrameDecoder &socket_decoder, FrameDecoder &shm_decoder)
+{
+    if (g_shm_channel.park())
+    {
+        pollfd fds[2] = {{socket_client.load(), POLLIN, 0}, {g_shm_channel.get_wake_fd(), POLLIN, 0}};
+        if (poll(fds, 2, 200) < 0 && errno != EINTR)
+            return false;
 
-    // Remove processed message from buffer
-    buffer.erase(buffer.begin(), buffer.begin() + totalLength);
+        if (fds[0].revents & (POLLIN | POLLHUP | POLLERR))
+        {
+            // A seqpacket must be read whole, MSG_TRUNC reports its real length
+            uint8_t stream_buffer[IPC_SOCKET_RESPONSE_BUFFER_SIZE];
+            bool seqpacket = (g_connected_socket_type == SOCK_SEQPACKET);
+            uint8_t *buffer = seqpacket ? g_packet_buffer.data() : stream_buffer;
+            size_t capacity = seqpacket ? g_packet_buffer.size() : sizeof(stream_buffer);
+            ssize_t received = recv(socket_client.load(), buffer, capacity, MSG_DONTWAIT | (seqpacket ? MSG_TRUNC : 0));
+            if (received == 0 || (received < 0 && errno != EAGAIN && errno != EINTR) || received > static_cast<ssize_t>(capacity))
+                return false;
+            if (received > 0)
+                socket_decoder.feed(buffer, static_cast<size_t>(received));
+        }
+    }
 
-    return query_msg;
-}
+    g_shm_channel.clear_wake();
+    uint8_t buffer[4096];
+    ssize_t received;
+    while ((received = g_shm_channel.receive(buffer, sizeof(buffer))) > 0)
+        shm_decoder.feed(buffer, static_cast<size_t>(received));
+    if (received < 0)
+        return false;
 
-/**
- * @brief Continuously listens for incoming responses from the server.
- * If the connection is lost, the client attempts to reconnect automatically.
- */
-std::string bool_to_string(bool value)
-{
-    return value ? "true" : "false";
+    DataMessageView query_msg;
+    while (socket_decoder.next(query_msg) || shm_decoder.next(query_msg))
+        ipc_dispatch_response(query_msg);
+    return true;
 }
 
 void ipc_receive_response_loop()
 {
-    std::vector<uint8_t> buffer; // Global buffer to hold incoming data
+    FrameDecoder decoder;     // Reassembles frames across reads
+    FrameDecoder shm_decoder; // Same for the shared memory rx ring
+    std::vector<int> received_fds;
     std::string str = "octopus.ipc.app.client";
     std::vector<uint8_t> parameters(str.begin(), str.end());
 
@@ -498,10 +723,47 @@ void ipc_receive_response_loop()
             continue;
         }
 
+        if (g_shm_channel.is_open())
+        {
+            if (!ipc_receive_shm_frames(decoder, shm_decoder))
+            {
+                std::cerr << "Client: Connection closed by server, reconnecting...\n";
+                decoder.clear();
+                shm_decoder.clear();
+                ipc_reconnect_to_server();
+            }
+            continue;
+        }
+
+        auto handle_frame = [&](const DataMessageView &query_msg)
+        {
+            if (query_msg.msg_group == MSG_GROUP_IPC_CONFIG && query_msg.msg_id == MSG_IPC_CMD_CONFIG_SHM_RING)
+            {
+                // Every later frame arrives through the rings
+                shm_decoder.clear();
+                ipc_attach_shm_transport(query_msg, received_fds);
+                return;
+            }
+            ipc_dispatch_response(query_msg);
+        };
+
         // Use epoll-based response method for efficient high-frequency polling
-        QueryResult result = client.get_response_with_epoll(socket_client, 200); // 100ms timeout
+        // A stream connection is drained into the decoder at every wakeup, a seqpacket connection
+        // reads one whole packet per call, into a buffer large enough for any
+        bool seqpacket = (g_connected_socket_type == SOCK_SEQPACKET);
+        size_t received = 0;
+        QueryStatus status = seqpacket ? client.get_response_with_epoll(socket_client, 200, g_packet_buffer.data(), g_packet_buffer.size(), received, received_fds)
+                                       : client.get_response_with_epoll(socket_client, 200, decoder, received, received_fds); // 200ms timeout
+
+        if (!seqpacket)
+        {
+            // Process every complete packet, also those read right before a hang-up
+            DataMessageView query_msg; // Parsed in place, valid until the decoder is used again
+            while (decoder.next(query_msg))
+                handle_frame(query_msg);
+        }
 
-        switch (result.status)
+        switch (status)
         {
         case QueryStatus::Success:
             break; // Continue processing below
@@ -509,32 +771,32 @@ void ipc_receive_response_loop()
             continue; // No data available yet, continue polling
         case QueryStatus::Disconnected:
             std::cerr << "Client: Connection closed by server, reconnecting...\n";
+            decoder.clear(); // Drop any partial frame of the old connection
             ipc_reconnect_to_server();
             continue;
         case QueryStatus::Error:
             std::cerr << "Client: Connection error (errno=" << errno << "), reconnecting...\n";
+            decoder.clear();
             ipc_reconnect_to_server();
             continue;
         }
 
-        // Append received data to buffer
-        buffer.insert(buffer.end(), result.data.begin(), result.data.end());
-        DataMessage query_msg;
-
-        // Extract and process complete packets
-        while (buffer.size() >= query_msg.get_base_length())
+        if (seqpacket)
         {
-            query_msg = ipc_check_complete_data_packet(buffer, query_msg);
-
-            if (query_msg.isValid())
-            {
-                ipc_invoke_notify_response(query_msg, query_msg.get_total_length());
-            }
-            else
+            // Edge-triggered epoll reports the queued packets once, read all of them. Each packet
+            // holds whole frames, they are parsed where they are.
+            do
             {
-                break; // Wait for more data
-            }
+                size_t invalid = frame_packet_for_each(g_packet_buffer.data(), received, handle_frame);
+                if (invalid > 0)
+                    std::cerr << "Client: Dropped " << invalid << " bytes of a malformed packet.\n";
+            } while (client.get_query_nonblocking(socket_client, g_packet_buffer.data(), g_packet_buffer.size(), received, received_fds) == QueryStatus::Success);
         }
+
+        // Descriptors nobody asked for must not leak
+        for (int fd : received_fds)
+            close(fd);
+        received_fds.clear();
         // Optional: reduce CPU load if desired (can be tuned or removed)
         // std::this_thread::sleep_for(std::chrono::milliseconds(10));
     }
@@ -662,6 +924,15 @@ __attribute__((destructor)) void ipc_exit_cleanup()
     }
 #endif
 
+    // Send the open container window, then stop ending windows
+    {
+        std::lock_guard<std::mutex> lock(container_mutex);
+        container_thread_running = false;
+        container_cv.notify_one();
+    }
+    if (ipc_container_thread.joinable())
+        ipc_container_thread.join();
+
     // Safely close the socket connection
     try
     {
@@ -673,6 +944,11 @@ __attribute__((destructor)) void ipc_exit_cleanup()
         std::cerr << "Client: Error closing socket: " << e.what() << std::endl;
     }
 
+    // Stop following the broadcast ring
+    g_broadcast_running.store(false);
+    if (ipc_broadcast_thread.joinable())
+        ipc_broadcast_thread.join();
+
     // Ensure receiver thread is properly joined if it is joinable
     if (ipc_receiver_thread.joinable())
     {
@@ -722,6 +998,267 @@ void ipc_redirect_log_to_file()
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+// Sends every remembered topic subscription in one MSG_IPC_CMD_CONFIG_SUBSCRIBE message
+void ipc_send_subscribed_topics()
+{
+    std::vector<uint8_t> topic_pairs;
+    std::vector<uint8_t> topic_intervals;
+    uint16_t keyframe_interval_ms;
+    {
+        std::lock_guard<std::mutex> lock(subscribed_topics_mutex);
+        for (uint16_t topic : g_subscribed_topics)
+        {
+            topic_pairs.push_back(static_cast<uint8_t>(topic >> 8));
+            topic_pairs.push_back(static_cast<uint8_t>(topic & 0xFF));
+        }
+        for (const auto &interval : g_topic_intervals)
+        {
+            topic_intervals.push_back(static_cast<uint8_t>(interval.first >> 8));
+            topic_intervals.push_back(static_cast<uint8_t>(interval.first & 0xFF));
+            topic_intervals.push_back(static_cast<uint8_t>(interval.second >> 8));
+            topic_intervals.push_back(static_cast<uint8_t>(interval.second & 0xFF));
+        }
+        keyframe_interval_ms = g_keyframe_interval_ms;
+    }
+
+    if (!topic_pairs.empty())
+        ipc_app_send_command(MSG_GROUP_IPC_CONFIG, MSG_IPC_CMD_CONFIG_SUBSCRIBE, topic_pairs);
+    if (!topic_intervals.empty())
+        ipc_app_send_command(MSG_GROUP_IPC_CONFIG, MSG_IPC_CMD_CONFIG_TOPIC_INTERVAL, topic_intervals);
+    if (keyframe_interval_ms > 0)
+        ipc_app_send_command(MSG_GROUP_IPC_CONFIG, MSG_IPC_CMD_CONFIG_KEYFRAME,
+                             {static_cast<uint8_t>(keyframe_interval_ms >> 8), static_cast<uint8_t>(keyframe_interval_ms & 0xFF)});
+}
+
+void ipc_subscribe_topic(uint8_t group, uint8_t msg_id)
+{
+    {
+        std::lock_guard<std::mutex> lock(subscribed_topics_mutex);
+        g_subscribed_topics.insert(static_cast<uint16_t>((group << 8) | msg_id));
+    }
+
+    // Not connected yet: the subscription is sent once the connection is up
+    if (socket_client.load() >= 0)
+        ipc_app_send_command(MSG_GROUP_IPC_CONFIG, MSG_IPC_CMD_CONFIG_SUBSCRIBE, {group, msg_id});
+}
+
+void ipc_unsubscribe_topic(uint8_t group, uint8_t msg_id)
+{
+    {
+        std::lock_guard<std::mutex> lock(subscribed_topics_mutex);
+        g_subscribed_topics.erase(static_cast<uint16_t>((group << 8) | msg_id));
+    }
+
+    if (socket_client.load() >= 0)
+        ipc_app_send_command(MSG_GROUP_IPC_CONFIG, MSG_IPC_CMD_CONFIG_UNSUBSCRIBE, {group, msg_id});
+}
+
+void ipc_set_topic_interval(uint8_t group, uint8_t msg_id, uint16_t interval_ms)
+{
+    uint16_t topic = static_cast<uint16_t>((group << 8) | msg_id);
+    {
+        std::lock_guard<std::mutex> lock(subscribed_topics_mutex);
+        if (interval_ms > 0)
+            g_topic_intervals[topic] = interval_ms;
+        else
+            g_topic_intervals.erase(topic);
+    }
+
+    if (socket_client.load() >= 0)
+        ipc_app_send_command(MSG_GROUP_IPC_CONFIG, MSG_IPC_CMD_CONFIG_TOPIC_INTERVAL,
+                             {group, msg_id, static_cast<uint8_t>(interval_ms >> 8), static_cast<uint8_t>(interval_ms & 0xFF)});
+}
+
+void ipc_set_keyframe_interval(uint16_t interval_ms)
+{
+    {
+        std::lock_guard<std::mutex> lock(subscribed_topics_mutex);
+        g_keyframe_interval_ms = interval_ms;
+    }
+
+    if (socket_client.load() >= 0)
+        ipc_app_send_command(MSG_GROUP_IPC_CONFIG, MSG_IPC_CMD_CONFIG_KEYFRAME,
+                             {static_cast<uint8_t>(interval_ms >> 8), static_cast<uint8_t>(interval_ms & 0xFF)});
+}
+
+// A frame of the broadcast ring is delivered if it matches a subscription, or always while the
+// client subscribed nothing (the legacy "push everything" behaviour)
+static bool ipc_broadcast_topic_wanted(uint8_t group, uint8_t msg_id)
+{
+    std::lock_guard<std::mutex> lock(subscribed_topics_mutex);
+    if (g_subscribed_topics.empty())
+        return true;
+    return g_subscribed_topics.count(static_cast<uint16_t>(group << 8 | msg_id)) ||
+           g_subscribed_topics.count(static_cast<uint16_t>(group << 8 | MSG_IPC_TOPIC_ANY)) ||
+           g_subscribed_topics.count(static_cast<uint16_t>(MSG_IPC_TOPIC_ANY << 8 | MSG_IPC_TOPIC_ANY));
+}
+
+// Follows the server broadcast ring and hands every wanted push frame to the callbacks
+void ipc_broadcast_receive_loop()
+{
+    OctopusShmBroadcastReader reader;
+    FrameDecoder decoder;
+    uint8_t frame[SHM_BROADCAST_SLOT_DATA];
+
+    while (g_broadcast_running.load())
+    {
+        // The ring appears once the server runs
+        if (!reader.is_open() && !reader.open())
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(200));
+            continue;
+        }
+
+        size_t length = 0;
+        ShmBroadcastResult result = reader.read(frame, &length);
+        if (result == ShmBroadcastResult::Empty)
+        {
+            reader.wait(200); // Bounded, so a stop request is noticed
+            continue;
+        }
+        if (result == ShmBroadcastResult::Overrun)
+        {
+            std::cerr << "Client: Broadcast ring overrun, " << reader.get_lost_frames() << " frames lost so far.\n";
+            decoder.clear();
+            continue;
+        }
+
+        decoder.feed(frame, length);
+        DataMessageView push_msg;
+        while (decoder.next(push_msg))
+        {
+            if (ipc_broadcast_topic_wanted(push_msg.msg_group, push_msg.msg_id))
+                ipc_dispatch_response(push_msg);
+        }
+    }
+}
+
+void ipc_enable_broadcast_ring(bool enable)
+{
+    if (enable == g_broadcast_running.load())
+        return;
+
+    if (enable)
+    {
+        // Follow the ring before the server stops the socket pushes, so nothing falls in between
+        g_broadcast_running.store(true);
+        ipc_broadcast_thread = std::thread(ipc_broadcast_receive_loop);
+    }
+    if (socket_client.load() >= 0)
+        ipc_app_send_command(MSG_GROUP_IPC_CONFIG, MSG_IPC_CMD_CONFIG_BROADCAST_RING, {static_cast<uint8_t>(enable ? 1 : 0)});
+    if (!enable)
+    {
+        g_broadcast_running.store(false);
+        if (ipc_broadcast_thread.joinable())
+            ipc_broadcast_thread.join();
+    }
+}
+
+// Asks the server for the shared memory transport, if enabled
+void ipc_request_shm_transport()
+{
+    uint32_t ring_bytes = g_shm_ring_bytes.load();
+    if (ring_bytes == 0 || socket_client.load() < 0)
+        return;
+
+    uint16_t ring_kb = static_cast<uint16_t>(std::min<uint32_t>(ring_bytes / 1024, 0xFFFF));
+    ipc_app_send_command(MSG_GROUP_IPC_CONFIG, MSG_IPC_CMD_CONFIG_SHM_RING,
+                         {static_cast<uint8_t>(ring_kb >> 8), static_cast<uint8_t>(ring_kb & 0xFF)});
+}
+
+void ipc_enable_shm_transport(uint32_t ring_bytes)
+{
+    g_shm_ring_bytes.store(ring_bytes ? ring_bytes : SHM_RING_DEFAULT_CAPACITY);
+    ipc_request_shm_transport();
+}
+
+// Tells the server whether this client unpacks container frames
+void ipc_request_container_frames()
+{
+    if (g_container_window_us.load() == 0 || socket_client.load() < 0)
+        return;
+
+    ipc_app_send_command(MSG_GROUP_IPC_CONFIG, MSG_IPC_CMD_CONFIG_CONTAINER, {1});
+}
+
+void ipc_enable_container_frames(uint32_t window_us)
+{
+    if (window_us != 0)
+    {
+        std::lock_guard<std::mutex> lock(container_mutex);
+        if (!container_thread_running)
+        {
+            container_thread_running = true;
+            ipc_container_thread = std::thread(ipc_container_window_loop);
+        }
+    }
+
+    uint32_t previous = g_container_window_us.exchange(window_us);
+    if (window_us == 0 && previous != 0 && socket_client.load() >= 0)
+        ipc_app_send_command(MSG_GROUP_IPC_CONFIG, MSG_IPC_CMD_CONFIG_CONTAINER, {0});
+    else if (window_us != 0 && previous == 0)
+        ipc_request_container_frames();
+}
+
+void ipc_enable_seqpacket_transport(bool enable)
+{
+    int socket_type = enable ? SOCK_SEQPACKET : SOCK_STREAM;
+    if (g_socket_type.exchange(socket_type) == socket_type)
+        return;
+
+    // The receiver thread sees the hang-up and reconnects on the other endpoint
+    int socket_fd = socket_client.load();
+    if (socket_fd >= 0)
+        shutdown(socket_fd, SHUT_RDWR);
+}
+
+bool ipc_send_large_payload(uint8_t group, uint8_t msg_id, const void *data, size_t size)
+{
+    int socket_fd = socket_client.load();
+    if (socket_fd < 0)
+    {
+        std::cerr << "Client: Cannot send large payload, no active connection.\n";
+        return false;
+    }
+
+    int memfd = large_payload_create(data, size);
+    if (memfd < 0)
+        return false;
+
+    // Only the socket carries file descriptors, the descriptor frame goes there even with the rings open
+    std::vector<uint8_t> serialized_data = large_payload_make_descriptor(group, msg_id, size).serializeMessage();
+    int sent = client.send_buff_with_fds(socket_fd, serialized_data.data(), serialized_data.size(), &memfd, 1);
+    close(memfd);
+    return sent == static_cast<int>(serialized_data.size());
+}
+
+// Maps the snapshot region once the server created it, false while it does not exist
+static bool ipc_snapshot_open()
+{
+    if (g_snapshot_reader_ready.load(std::memory_order_acquire))
+        return true;
+
+    std::lock_guard<std::mutex> lock(snapshot_reader_mutex);
+    if (!g_snapshot_reader.is_open() && !g_snapshot_reader.open())
+        return false;
+    g_snapshot_reader_ready.store(true, std::memory_order_release);
+    return true;
+}
+
+bool ipc_snapshot_read(uint32_t slot, void *buffer, size_t size, uint64_t *version)
+{
+    if (!ipc_snapshot_open())
+        return false;
+    return g_snapshot_reader.read(slot, buffer, size, version);
+}
+
+uint64_t ipc_snapshot_version(uint32_t slot)
+{
+    if (!ipc_snapshot_open())
+        return 0;
+    return g_snapshot_reader.get_version(slot);
+}
+
 void ipc_send_message(DataMessage &message)
 {
     if (socket_client.load() < 0)
@@ -729,8 +1266,49 @@ void ipc_send_message(DataMessage &message)
         std::cerr << "Client: Cannot send command, no active connection.\n";
         return;
     }
-    std::vector<uint8_t> serialized_data = message.serializeMessage();
-    client.send_query(socket_client.load(), serialized_data);
+    ipc_app_send_message(message);
+}
+
+uint32_t ipc_send_request(DataMessage &message, OctopusAppReplyCallback callback, void *context)
+{
+    if (socket_client.load() < 0)
+    {
+        std::cerr << "Client: Cannot send request, no active connection.\n";
+        return 0;
+    }
+
+    uint32_t request_id = g_next_request_id.fetch_add(1);
+    if (request_id == 0)
+        request_id = g_next_request_id.fetch_add(1); // 0 means no request id, skipped on wrap around
+    message.request_id = request_id;
+
+    // Registered first, the reply may arrive before the send returns
+    if (callback)
+    {
+        std::lock_guard<std::mutex> lock(pending_requests_mutex);
+        g_pending_requests[request_id] = {callback, context};
+    }
+    if (!ipc_app_send_message(message))
+    {
+        std::lock_guard<std::mutex> lock(pending_requests_mutex);
+        g_pending_requests.erase(request_id);
+        return 0;
+    }
+    return request_id;
+}
+
+uint32_t ipc_send_car_batch_get(const std::vector<uint8_t> &msg_ids, OctopusAppReplyCallback callback, void *context)
+{
+    DataMessage message(MSG_GROUP_CAR, MSG_IPC_CMD_CAR_GET_BATCH, msg_ids);
+    return ipc_send_request(message, callback, context);
+}
+
+uint32_t ipc_send_car_get_if_modified(uint8_t msg_id, uint64_t known_version, OctopusAppReplyCallback callback, void *context)
+{
+    std::vector<uint8_t> data(1, msg_id);
+    state_version_append(data, known_version);
+    DataMessage message(MSG_GROUP_CAR, MSG_IPC_CMD_CAR_GET_IF_MODIFIED, data);
+    return ipc_send_request(message, callback, context);
 }
 
 /**
@@ -762,15 +1340,91 @@ void ipc_send_message_queue_(DataMessage &message)
         return;  // Exit early if there's no active socket connection
     }
 
-    // Serialize the message into a byte vector for transmission
-    std::vector<uint8_t> serialized_data = copied_msg.serializeMessage();
+    // Send the message over the active transport
+    ipc_app_send_message(copied_msg); });
+}
+
+// Sends the messages gathered in the current container window as one frame, container_mutex held
+void ipc_app_send_container_locked()
+{
+    std::vector<uint8_t> frames = g_container_builder.take();
+    if (frames.empty())
+        return;
+
+    {
+        std::lock_guard<std::mutex> shm_lock(shm_channel_mutex);
+        if (g_shm_channel.is_open())
+        {
+            ipc_app_send_shm_locked(frames.data(), frames.size());
+            return;
+        }
+    }
+    client.send_frames(socket_client.load(), frames.data(), frames.size());
+}
+
+// Sends every container window at its end. Only this thread closes a window, so one is open
+// whenever the builder holds messages.
+void ipc_container_window_loop()
+{
+    std::unique_lock<std::mutex> lock(container_mutex);
+    while (container_thread_running)
+    {
+        if (!container_window_open)
+        {
+            container_cv.wait(lock);
+            continue;
+        }
+
+        container_cv.wait_until(lock, container_window_end, []
+                                { return !container_thread_running; });
+        container_window_open = false;
+        ipc_app_send_container_locked();
+    }
+    ipc_app_send_container_locked();
+}
+
+/**
+ * @brief Adds a message to the current container window.
+ *
+ * The first message opens a window, the window thread sends it when the window ends. A full
+ * container is sent right away, the rest stays in the open window.
+ * @return false if container frames are disabled or the client is not connected.
+ */
+bool ipc_app_queue_container_message(const DataMessage &message)
+{
+    uint32_t window_us = g_container_window_us.load();
+    if (window_us == 0 || socket_client.load() < 0)
+        return false;
 
-    // Send the serialized data over the active socket
-    client.send_query(socket_client.load(), serialized_data); });
+    std::vector<uint8_t> frame = message.serializeMessage();
+    std::lock_guard<std::mutex> lock(container_mutex);
+    if (!container_thread_running)
+        return false;
+    if (!g_container_builder.append(frame.data(), frame.size()))
+    {
+        if (g_container_builder.empty())
+            return false; // Too large for a container, sent on its own
+
+        // Full: sent now, the open window takes the next messages
+        ipc_app_send_container_locked();
+        g_container_builder.append(frame.data(), frame.size());
+    }
+
+    if (!container_window_open)
+    {
+        container_window_open = true;
+        container_window_end = std::chrono::steady_clock::now() + std::chrono::microseconds(window_us);
+        container_cv.notify_one();
+    }
+    return true;
 }
 
 void ipc_send_message_queue_delayed(DataMessage &message, int delay_ms)
 {
+    // Not delayed: gathered with the other messages of the container window, if enabled
+    if (delay_ms == 0 && ipc_app_queue_container_message(message))
+        return;
+
     // Make a copy of the message because the lambda will run asynchronously and possibly after the original goes out of scope.
     DataMessage copied_msg = message;
     // message.printMessage("Client");
@@ -806,9 +1460,8 @@ void ipc_send_message_queue_delayed(DataMessage &message, int delay_ms)
                                      }
 
                                      copied_msg.printMessage("ipc_send_message_queue_delayed client");
-                                     // At this point, socket is valid; serialize and send the message
-                                     std::vector<uint8_t> serialized_data = copied_msg.serializeMessage();
-                                     client.send_query(socket_client.load(), serialized_data); },
+                                     // At this point, socket is valid; send the message
+                                     ipc_app_send_message(copied_msg); },
                                  delay_ms); // Initial delay before starting the check-send task
 }
 
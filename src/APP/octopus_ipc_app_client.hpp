@@ -24,7 +24,12 @@
 #include "../IPC/octopus_ipc_ptl.hpp"
 #include "../IPC/octopus_logger.hpp"
 #include "../IPC/octopus_ipc_socket.hpp"
+#include "../IPC/octopus_ipc_frame_decoder.hpp"
 #include "../IPC/octopus_ipc_threadpool.hpp" 
+#include "../IPC/octopus_ipc_shm_snapshot.hpp"
+#include "../IPC/octopus_ipc_shm_ring.hpp"
+#include "../IPC/octopus_ipc_shm_broadcast.hpp"
+#include "../IPC/octopus_ipc_large_payload.hpp"
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 #ifdef __cplusplus
@@ -47,6 +52,22 @@ extern "C"
     void ipc_register_socket_callback(std::string func_name, OctopusAppResponseCallback callback);
     void ipc_unregister_socket_callback(OctopusAppResponseCallback callback);
 
+    /**
+     * @brief Function pointer type for handling server messages without copying them.
+     * @param message View of the received frame, only valid during the call.
+     *
+     * View callbacks run on the receiving thread, before the response callbacks are queued: they
+     * must return quickly, and call to_message() on the view to keep the message.
+     */
+    typedef void (*OctopusAppViewCallback)(const DataMessageView &message);
+
+    /**
+     * @brief Registers a callback invoked in place for every received message.
+     * When only view callbacks are registered, receiving allocates nothing per message.
+     */
+    void ipc_register_view_callback(std::string func_name, OctopusAppViewCallback callback);
+    void ipc_unregister_view_callback(OctopusAppViewCallback callback);
+
     /**
      * @brief Initializes the client connection and starts the response receiver thread.
      * This function is automatically called when the shared library is loaded.
@@ -70,6 +91,61 @@ extern "C"
      */
     void ipc_send_message(DataMessage &message);
 
+    /**
+     * @brief Function pointer type for the reply to a request sent with ipc_send_request().
+     * @param reply   View of the reply frame, only valid during the call.
+     * @param context The context passed to ipc_send_request().
+     */
+    typedef void (*OctopusAppReplyCallback)(const DataMessageView &reply, void *context);
+
+    /**
+     * @brief Send a request carrying a new request id, without waiting for its reply.
+     *
+     * The server answers every request id with exactly one reply echoing it (same group and
+     * msg, no data for commands without a result), so any number of requests may be in flight
+     * on the connection and the replies are matched as they arrive, in whatever order.
+     * With a callback the reply goes to it alone, on the receiving thread: like a view callback
+     * it must return quickly. Without one the reply reaches the registered callbacks, where
+     * request_id tells it apart from a push. Requests pending when the connection drops never
+     * get a reply.
+     *
+     * @param message  The request, its request_id is set.
+     * @param callback Optional, invoked with the reply.
+     * @param context  Passed to the callback.
+     * @return The request id, 0 if the request could not be sent.
+     */
+    uint32_t ipc_send_request(DataMessage &message, OctopusAppReplyCallback callback = nullptr, void *context = nullptr);
+
+    /**
+     * @brief Request several car state snapshots (MSG_IPC_CMD_CAR_GET_*_INFO) in one frame.
+     *
+     * The reply holds one item per msg_id, in order, all taken from the same consistent cut of the
+     * server state. Walk its data with batch_reply_next_item(). Sent with ipc_send_request().
+     *
+     * @param msg_ids  GET msg_ids of MSG_GROUP_CAR.
+     * @param callback Optional, invoked with the reply.
+     * @param context  Passed to the callback.
+     * @return The request id, 0 if the request could not be sent.
+     */
+    uint32_t ipc_send_car_batch_get(const std::vector<uint8_t> &msg_ids, OctopusAppReplyCallback callback = nullptr, void *context = nullptr);
+
+    /**
+     * @brief Request a car state snapshot only if it changed since known_version.
+     *
+     * A changed state comes back as the usual GET frame of msg_id with the current version
+     * appended (read it with state_version_parse() and pass it next time). If known_version is
+     * still current the reply is a MSG_IPC_CMD_CAR_NOT_MODIFIED frame, which only reaches the
+     * request callback: registered callbacks are not invoked for it. Pass 0 for the first poll and
+     * after a reconnect, the server may have restarted with new versions.
+     *
+     * @param msg_id        GET msg_id of MSG_GROUP_CAR.
+     * @param known_version Version of the last reply, 0 for none.
+     * @param callback      Optional, invoked with the reply.
+     * @param context       Passed to the callback.
+     * @return The request id, 0 if the request could not be sent.
+     */
+    uint32_t ipc_send_car_get_if_modified(uint8_t msg_id, uint64_t known_version, OctopusAppReplyCallback callback = nullptr, void *context = nullptr);
+
     /**
      * @brief Send a message asynchronously by pushing it to the IPC message queue.
      *
@@ -93,6 +169,130 @@ extern "C"
     void ipc_send_message_queue_delayed(DataMessage &message, int delay_ms);
 
     void ipc_send_message_queue(uint8_t group, uint8_t msg_id, const std::vector<uint8_t> &message_data, int delay);
+
+    /**
+     * @brief Subscribe to the server pushes of one topic.
+     *
+     * A connection starts with every topic pushed. The first subscription replaces that, from then on
+     * only subscribed topics are pushed. Subscribe MSG_IPC_TOPIC_ANY, MSG_IPC_TOPIC_ANY to keep everything.
+     * Subscriptions are remembered and sent again after a reconnect.
+     *
+     * @param group  Group of the topic, MSG_IPC_TOPIC_ANY for every group.
+     * @param msg_id Message of the topic, MSG_IPC_TOPIC_ANY for every message of the group.
+     */
+    void ipc_subscribe_topic(uint8_t group, uint8_t msg_id);
+
+    /**
+     * @brief Cancel a subscription made with ipc_subscribe_topic().
+     */
+    void ipc_unsubscribe_topic(uint8_t group, uint8_t msg_id);
+
+    /**
+     * @brief Limit how often the server pushes a state topic to this client.
+     *
+     * The server queues at most one update of the topic per interval, always the latest one.
+     * Other clients are not affected. Key events are never rate limited.
+     *
+     * @param group       Group of the topic.
+     * @param msg_id      Message of the topic, MSG_IPC_TOPIC_ANY for every message of the group.
+     * @param interval_ms Minimum time between two pushes, 0 to receive every update again.
+     */
+    void ipc_set_topic_interval(uint8_t group, uint8_t msg_id, uint16_t interval_ms);
+
+    /**
+     * @brief Request periodic keyframes of unchanged state topics.
+     *
+     * The server only pushes a state topic when its snapshot changed. With a keyframe interval
+     * the current snapshot is pushed again at least this often even if nothing changed.
+     *
+     * @param interval_ms Keyframe interval, 0 to receive changes only.
+     */
+    void ipc_set_keyframe_interval(uint16_t interval_ms);
+
+    /**
+     * @brief Move the data traffic of this client from the socket to shared memory rings.
+     *
+     * The server maps one ring per direction (memfd, passed over the socket) and only wakes the
+     * client through an eventfd when it is waiting. The socket stays connected as the control
+     * channel: it detects a server restart, and frames fall back to it when the ring is full.
+     * The request is repeated after every reconnect. If the server refuses, the socket is used.
+     *
+     * @param ring_bytes Size of each ring, 0 for the default (SHM_RING_DEFAULT_CAPACITY).
+     */
+    void ipc_enable_shm_transport(uint32_t ring_bytes);
+
+    /**
+     * @brief Connect through the SOCK_SEQPACKET endpoint of the server instead of the stream one.
+     *
+     * Every frame then travels as one packet: it is received whole by a single read, without
+     * reassembly across reads. An open connection of the other type is closed, the receiver
+     * thread reconnects on the selected endpoint.
+     *
+     * @param enable true for SOCK_SEQPACKET, false for SOCK_STREAM (default).
+     */
+    void ipc_enable_seqpacket_transport(bool enable);
+
+    /**
+     * @brief Pack bursts of small frames into container frames, in both directions.
+     *
+     * Messages sent with ipc_send_message_queue() without a delay are gathered for window_us and
+     * go out as one container frame: one write instead of one per message. The server packs the
+     * frames of a burst (pushes of one tick, replies to pipelined requests) the same way. The
+     * containers are unpacked transparently, callbacks still see every frame on its own.
+     * The request is repeated after every reconnect.
+     *
+     * @param window_us Time a queued message may wait for others, 0 to send every frame alone.
+     */
+    void ipc_enable_container_frames(uint32_t window_us);
+
+    /**
+     * @brief Receive pushes from the server shared memory broadcast ring instead of the socket.
+     *
+     * The server writes every push frame once into the ring, whatever the number of readers.
+     * A thread of this client follows the ring and invokes the callbacks for the subscribed
+     * topics (every topic if none was subscribed). Per-topic intervals and keyframes do not
+     * apply to ring readers. A reader that falls a whole ring behind loses frames, the latest
+     * state can then be read with ipc_snapshot_read().
+     *
+     * @param enable true to read pushes from the ring, false to get them on the socket again.
+     */
+    void ipc_enable_broadcast_ring(bool enable);
+
+    /**
+     * @brief Send a payload too large for a DataMessage (flash images, logs, trace dumps).
+     *
+     * The payload is copied once into a sealed memfd which is passed over the socket together
+     * with a small MSG_IPC_CMD_CONFIG_LARGE_PAYLOAD descriptor. The server maps it read-only,
+     * the bytes never go through the socket. The server answers with a descriptor reply
+     * (group, msg_id, ok) delivered to the registered callbacks.
+     *
+     * @param group  Group the payload belongs to.
+     * @param msg_id Message the payload belongs to.
+     * @param data   Payload bytes.
+     * @param size   Payload size, 1 byte up to LARGE_PAYLOAD_MAX_SIZE.
+     * @return true if the memfd and its descriptor were handed to the socket.
+     */
+    bool ipc_send_large_payload(uint8_t group, uint8_t msg_id, const void *data, size_t size);
+
+    /**
+     * @brief Read the latest published state straight from the server shared memory.
+     *
+     * No socket round trip and no lock: the snapshot is copied out of a seqlock protected slot.
+     * Fails if the server has not created the region yet, the slot was never published, size
+     * does not match the published struct, or the server kept rewriting the slot meanwhile.
+     *
+     * @param slot    SHM_SNAPSHOT_METER, SHM_SNAPSHOT_INDICATOR, ... see ShmSnapshotSlot.
+     * @param buffer  Receives the struct, e.g. a carinfo_meter_t.
+     * @param size    sizeof the struct.
+     * @param version Optional, receives the version of the copied snapshot.
+     * @return true if buffer holds a consistent snapshot.
+     */
+    bool ipc_snapshot_read(uint32_t slot, void *buffer, size_t size, uint64_t *version = nullptr);
+
+    /**
+     * @brief Version of a snapshot slot, grows with every update. 0 if never published.
+     */
+    uint64_t ipc_snapshot_version(uint32_t slot);
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,438 @@
+/**
+ * @file octopus_bench.hpp
+ * @brief Helpers shared by the benchmarks in src/BENCH.
+ *
+ * - Clocks and percentiles.
+ * - BenchServer: runs octopus_ipc_server as a child process with the syscall counting library
+ *   preloaded, and reports its CPU time, RSS, threads and system calls.
+ * - Raw client sockets speaking the frame format, without the OAPPC client library in the way.
+ *
+ * The server benchmarks bind the usual socket paths: stop an installed server before running them.
+ *
+ * @author ak47
+ * @date 2026-10-16
+ */
+#ifndef OCTOPUS_BENCH_HPP
+#define OCTOPUS_BENCH_HPP
+
+#include "octopus_ipc_ptl.hpp"
+#include "octopus_ipc_socket.hpp"
+#include "octopus_ipc_frame_decoder.hpp"
+#include "octopus_bench_syscalls.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+
+#define BENCH_SERVER_START_TIMEOUT_MS 5000 // Longest wait for a started server to accept connections
+
+inline uint64_t bench_now_ns()
+{
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return static_cast<uint64_t>(now.tv_sec) * 1000000000ull + static_cast<uint64_t>(now.tv_nsec);
+}
+
+// CPU time of the whole calling process
+inline uint64_t bench_process_cpu_ns()
+{
+    timespec now;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &now);
+    return static_cast<uint64_t>(now.tv_sec) * 1000000000ull + static_cast<uint64_t>(now.tv_nsec);
+}
+
+// CPU time of the calling thread
+inline uint64_t bench_thread_cpu_ns()
+{
+    timespec now;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+    return static_cast<uint64_t>(now.tv_sec) * 1000000000ull + static_cast<uint64_t>(now.tv_nsec);
+}
+
+// Sample at percentile (0 to 100) of samples, 0 if there are none
+inline uint64_t bench_percentile(std::vector<uint64_t> samples, double percentile)
+{
+    if (samples.empty())
+        return 0;
+    size_t index = static_cast<size_t>(percentile / 100.0 * (samples.size() - 1) + 0.5);
+    std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+    return samples[index];
+}
+
+// Keeps the optimizer from dropping a computed value
+template <typename T>
+inline void bench_keep(const T &value)
+{
+    asm volatile("" : : "g"(&value) : "memory");
+}
+
+/**
+ * @brief The former DataMessage: payload in a std::vector, serializeMessage() growing its result
+ *        with push_back(). Reference for the message benchmarks.
+ */
+struct BenchVectorMessage
+{
+    uint16_t msg_header = DataMessage::_HEADER_;
+    uint8_t msg_group = 0;
+    uint8_t msg_id = 0;
+    uint16_t msg_length = 0;
+    std::vector<uint8_t> data;
+
+    BenchVectorMessage(uint8_t group, uint8_t id, const std::vector<uint8_t> &bytes)
+        : msg_group(group), msg_id(id), msg_length(static_cast<uint16_t>(bytes.size())), data(bytes) {}
+
+    std::vector<uint8_t> serializeMessage() const
+    {
+        std::vector<uint8_t> serialized;
+        serialized.push_back(static_cast<uint8_t>(msg_header >> 8));
+        serialized.push_back(static_cast<uint8_t>(msg_header & 0xFF));
+        serialized.push_back(msg_group);
+        serialized.push_back(msg_id);
+        serialized.push_back(static_cast<uint8_t>(msg_length >> 8));
+        serialized.push_back(static_cast<uint8_t>(msg_length & 0xFF));
+        serialized.insert(serialized.end(), data.begin(), data.end());
+        return serialized;
+    }
+};
+
+/**
+ * @class BenchServer
+ * @brief octopus_ipc_server running as a child process of the benchmark.
+ */
+class BenchServer
+{
+public:
+    BenchServer() : pid_(-1), counters_(nullptr) {}
+    ~BenchServer() { stop(); }
+
+    /**
+     * @brief Starts the server and waits until it accepts connections.
+     * @param arguments Command line arguments of the server.
+     * @param binary Server executable, the one built with the benchmarks by default.
+     */
+    bool start(const std::vector<std::string> &arguments = {}, const std::string &binary = OCTOPUS_BENCH_SERVER)
+    {
+        stop();
+
+        // The preloaded counters write into this file, created before the server can look for it
+        counters_path_ = "/tmp/octopus_bench_syscalls." + std::to_string(getpid());
+        int fd = open(counters_path_.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+        if (fd < 0 || ftruncate(fd, sizeof(OctopusBenchSyscalls)) == -1)
+        {
+            std::cerr << "Cannot create " << counters_path_ << std::endl;
+            if (fd >= 0)
+                close(fd);
+            return false;
+        }
+        void *address = mmap(nullptr, sizeof(OctopusBenchSyscalls), PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+        counters_ = (address == MAP_FAILED) ? nullptr : static_cast<const OctopusBenchSyscalls *>(address);
+
+        pid_ = fork();
+        if (pid_ == 0)
+        {
+            int null_fd = open("/dev/null", O_WRONLY);
+            dup2(null_fd, STDOUT_FILENO);
+            dup2(null_fd, STDERR_FILENO);
+            // The server dlopen()s libOTSM.so by name
+            std::string library_path = OCTOPUS_BENCH_OTSM_DIRECTORY;
+            if (const char *inherited = getenv("LD_LIBRARY_PATH"))
+                library_path += std::string(":") + inherited;
+            setenv("LD_LIBRARY_PATH", library_path.c_str(), 1);
+            setenv("LD_PRELOAD", OCTOPUS_BENCH_SYSCALLS_LIBRARY, 1);
+            setenv(OCTOPUS_BENCH_SYSCALLS_ENV, counters_path_.c_str(), 1);
+            std::vector<char *> argv;
+            argv.push_back(const_cast<char *>(binary.c_str()));
+            for (const std::string &argument : arguments)
+                argv.push_back(const_cast<char *>(argument.c_str()));
+            argv.push_back(nullptr);
+            execv(binary.c_str(), argv.data());
+            _exit(127);
+        }
+        if (pid_ < 0)
+            return false;
+
+        for (uint64_t start = bench_now_ns(); bench_now_ns() - start < BENCH_SERVER_START_TIMEOUT_MS * 1000000ull;)
+        {
+            int probe = bench_connect_probe();
+            if (probe >= 0)
+            {
+                close(probe);
+                usleep(200 * 1000); // Let the server settle (OTSM start, reactors)
+                return true;
+            }
+            if (waitpid(pid_, nullptr, WNOHANG) == pid_)
+                break;
+            usleep(20 * 1000);
+        }
+        std::cerr << "Server " << binary << " did not start" << std::endl;
+        stop();
+        return false;
+    }
+
+    void stop()
+    {
+        if (pid_ > 0)
+        {
+            kill(pid_, SIGINT);
+            for (int i = 0; i < 100 && waitpid(pid_, nullptr, WNOHANG) != pid_; ++i)
+                usleep(20 * 1000);
+            if (kill(pid_, 0) == 0)
+            {
+                kill(pid_, SIGKILL);
+                waitpid(pid_, nullptr, 0);
+            }
+            pid_ = -1;
+        }
+        if (counters_)
+        {
+            munmap(const_cast<OctopusBenchSyscalls *>(counters_), sizeof(OctopusBenchSyscalls));
+            counters_ = nullptr;
+            unlink(counters_path_.c_str());
+        }
+    }
+
+    pid_t get_pid() const { return pid_; }
+
+    // User plus system CPU time, clock tick resolution
+    uint64_t get_cpu_ns() const
+    {
+        std::ifstream stat("/proc/" + std::to_string(pid_) + "/stat");
+        std::string line;
+        std::getline(stat, line);
+        size_t end_of_name = line.rfind(')');
+        if (end_of_name == std::string::npos)
+            return 0;
+        std::istringstream fields(line.substr(end_of_name + 2));
+        std::string field;
+        uint64_t utime = 0, stime = 0;
+        for (int i = 3; i <= 15 && fields >> field; ++i)
+        {
+            if (i == 14)
+                utime = std::stoull(field);
+            else if (i == 15)
+                stime = std::stoull(field);
+        }
+        return (utime + stime) * 1000000000ull / static_cast<uint64_t>(sysconf(_SC_CLK_TCK));
+    }
+
+    size_t get_rss_kb() const { return get_status_value("VmRSS:"); }
+    size_t get_threads() const { return get_status_value("Threads:"); }
+
+    OctopusBenchSyscalls get_syscalls() const
+    {
+        if (!counters_)
+            return OctopusBenchSyscalls();
+        OctopusBenchSyscalls copy;
+        copy.reads = __atomic_load_n(&counters_->reads, __ATOMIC_RELAXED);
+        copy.writes = __atomic_load_n(&counters_->writes, __ATOMIC_RELAXED);
+        copy.waits = __atomic_load_n(&counters_->waits, __ATOMIC_RELAXED);
+        copy.uring_enters = __atomic_load_n(&counters_->uring_enters, __ATOMIC_RELAXED);
+        return copy;
+    }
+
+private:
+    static int bench_connect_probe()
+    {
+        int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        strncpy(address.sun_path, IPC_SOCKET_STREAM_PATH, sizeof(address.sun_path) - 1);
+        if (connect(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) == 0)
+            return fd;
+        close(fd);
+        return -1;
+    }
+
+    size_t get_status_value(const std::string &key) const
+    {
+        std::ifstream status("/proc/" + std::to_string(pid_) + "/status");
+        std::string line;
+        while (std::getline(status, line))
+        {
+            if (line.compare(0, key.size(), key) == 0)
+                return std::strtoul(line.c_str() + key.size(), nullptr, 10);
+        }
+        return 0;
+    }
+
+    pid_t pid_;
+    std::string counters_path_;
+    const OctopusBenchSyscalls *counters_;
+};
+
+/**
+ * @brief Connects to the server, SOCK_STREAM or SOCK_SEQPACKET endpoint.
+ * @param push Keep the server pushes, a client only sending requests turns them off.
+ * @return The connected socket, -1 on failure.
+ */
+inline int bench_connect(int type = SOCK_STREAM, bool push = false)
+{
+    int fd = socket(AF_UNIX, type | SOCK_CLOEXEC, 0);
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    strncpy(address.sun_path, type == SOCK_SEQPACKET ? IPC_SOCKET_SEQPACKET_PATH : IPC_SOCKET_STREAM_PATH,
+            sizeof(address.sun_path) - 1);
+    if (fd < 0 || connect(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) == -1)
+    {
+        std::cerr << "connect failed: " << strerror(errno) << std::endl;
+        if (fd >= 0)
+            close(fd);
+        return -1;
+    }
+    if (!push)
+    {
+        std::vector<uint8_t> flag_off = DataMessage(MSG_GROUP_IPC_CONFIG, MSG_IPC_CMD_CONFIG_FLAG, {0, 0}).serializeMessage();
+        if (send(fd, flag_off.data(), flag_off.size(), MSG_NOSIGNAL) != static_cast<ssize_t>(flag_off.size()))
+        {
+            close(fd);
+            return -1;
+        }
+    }
+    return fd;
+}
+
+inline std::vector<uint8_t> bench_frame(uint8_t group, uint8_t msg_id, const std::vector<uint8_t> &data = {}, uint32_t request_id = 0)
+{
+    DataMessage message(group, msg_id, data);
+    message.request_id = request_id;
+    return message.serializeMessage();
+}
+
+inline bool bench_send_all(int fd, const uint8_t *bytes, size_t length)
+{
+    while (length > 0)
+    {
+        ssize_t sent = send(fd, bytes, length, MSG_NOSIGNAL);
+        if (sent < 0 && errno == EINTR)
+            continue;
+        if (sent <= 0)
+            return false;
+        bytes += sent;
+        length -= static_cast<size_t>(sent);
+    }
+    return true;
+}
+
+inline bool bench_send_all(int fd, const std::vector<uint8_t> &bytes)
+{
+    return bench_send_all(fd, bytes.data(), bytes.size());
+}
+
+/**
+ * @class BenchReader
+ * @brief Blocking frame reader of a benchmark client socket, stream or seqpacket.
+ */
+class BenchReader
+{
+public:
+    explicit BenchReader(int fd) : fd_(fd), buffer_(IPC_SOCKET_PACKET_BUFFER_SIZE) {}
+
+    /**
+     * @brief Waits for the next frame, container frames are unpacked.
+     * @return false on timeout or when the connection is gone.
+     */
+    bool next(DataMessageView &view, int timeout_ms = 2000)
+    {
+        while (!decoder_.next(view))
+        {
+            pollfd readable = {fd_, POLLIN, 0};
+            if (poll(&readable, 1, timeout_ms) <= 0)
+                return false;
+            ssize_t length = recv(fd_, buffer_.data(), buffer_.size(), 0);
+            if (length <= 0)
+                return false;
+            reads_++;
+            decoder_.feed(buffer_.data(), static_cast<size_t>(length));
+        }
+        return true;
+    }
+
+    /**
+     * @brief Waits for the next frame with the given group and message id, others are skipped.
+     */
+    bool next(uint8_t group, uint8_t msg_id, DataMessageView &view, int timeout_ms = 2000)
+    {
+        while (next(view, timeout_ms))
+        {
+            if (view.msg_group == group && view.msg_id == msg_id)
+                return true;
+        }
+        return false;
+    }
+
+    // Reads and discards whatever arrives within quiet_ms
+    void drain(int quiet_ms = 100)
+    {
+        DataMessageView view;
+        while (next(view, quiet_ms))
+        {
+        }
+    }
+
+    uint64_t get_reads() const { return reads_; }
+
+private:
+    int fd_;
+    std::vector<uint8_t> buffer_;
+    FrameDecoder decoder_;
+    uint64_t reads_ = 0;
+};
+
+/**
+ * @brief Sends carinfo GETs in batches of depth pipelined requests until the deadline or max_batches.
+ *
+ * Each request carries a request id, so replies are never conflated: a batch completes when all
+ * of its depth replies arrived.
+ * @param latencies Optional, receives the round trip of every batch, first send to last reply.
+ * @return Number of replies received, the run stops early if the connection fails.
+ */
+inline uint64_t bench_pipelined_gets(int fd, size_t depth, uint64_t deadline_ns, std::vector<uint64_t> *latencies = nullptr,
+                                     size_t max_batches = SIZE_MAX)
+{
+    BenchReader reader(fd);
+    DataMessageView view;
+    std::vector<uint8_t> batch;
+    uint32_t request_id = 0;
+    uint64_t replies = 0;
+    for (size_t batches = 0; batches < max_batches && bench_now_ns() < deadline_ns; ++batches)
+    {
+        batch.clear();
+        for (size_t i = 0; i < depth; ++i)
+        {
+            std::vector<uint8_t> frame = bench_frame(MSG_GROUP_CAR, MSG_IPC_CMD_CAR_GET_METER_INFO, {}, ++request_id);
+            batch.insert(batch.end(), frame.begin(), frame.end());
+        }
+        uint64_t start = bench_now_ns();
+        if (!bench_send_all(fd, batch))
+            return replies;
+        for (size_t pending = depth; pending > 0; --pending)
+        {
+            do
+            {
+                if (!reader.next(MSG_GROUP_CAR, MSG_IPC_CMD_CAR_GET_METER_INFO, view))
+                    return replies;
+            } while (view.request_id == 0); // A push, not a reply
+            replies++;
+        }
+        if (latencies)
+            latencies->push_back(bench_now_ns() - start);
+    }
+    return replies;
+}
+
+#endif // OCTOPUS_BENCH_HPP
@@ -0,0 +1,62 @@
+/**
+ * @file octopus_bench_allocations.cpp
+ * @brief Replacement of the global operator new counting every allocation.
+ *
+ * @author ak47
+ * @date 2026-10-16
+ */
+#include "octopus_bench_allocations.hpp"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+static std::atomic<uint64_t> bench_allocation_count{0};
+
+uint64_t bench_allocations()
+{
+    return bench_allocation_count.load(std::memory_order_relaxed);
+}
+
+void *operator new(std::size_t size)
+{
+    bench_allocation_count.fetch_add(1, std::memory_order_relaxed);
+    if (void *pointer = std::malloc(size ? size : 1))
+        return pointer;
+    throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+    bench_allocation_count.fetch_add(1, std::memory_order_relaxed);
+    return std::malloc(size ? size : 1);
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &tag) noexcept
+{
+    return operator new(size, tag);
+}
+
+void operator delete(void *pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete[](void *pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void *pointer, std::size_t) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete[](void *pointer, std::size_t) noexcept
+{
+    std::free(pointer);
+}
@@ -0,0 +1,21 @@
+/**
+ * @file octopus_bench_allocations.hpp
+ * @brief Counts heap allocations of a benchmark.
+ *
+ * Link octopus_bench_allocations.cpp into the benchmark: it replaces the global operator new,
+ * so allocations made inside OIPC are counted as well.
+ *
+ * @author ak47
+ * @date 2026-10-16
+ */
+#ifndef OCTOPUS_BENCH_ALLOCATIONS_HPP
+#define OCTOPUS_BENCH_ALLOCATIONS_HPP
+
+#include <cstdint>
+
+/**
+ * @brief Number of operator new calls since the start of the program, all threads.
+ */
+uint64_t bench_allocations();
+
+#endif // OCTOPUS_BENCH_ALLOCATIONS_HPP
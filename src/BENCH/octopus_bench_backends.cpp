@@ -0,0 +1,81 @@
+/**
+ * @file octopus_bench_backends.cpp
+ * @brief Server on the epoll and on the io_uring backend with 1 and 100 clients.
+ *
+ * Every client thread sends carinfo GETs with request ids, one at a time, for a fixed time.
+ * Reports requests per second, p50/p99 round trip, server CPU time and system calls per request
+ * (io_uring_enter included). A server without io_uring support falls back to epoll: compare
+ * the io_uring_enter column to tell.
+ *
+ * Usage: octopus_bench_backends [seconds]
+ *
+ * @author ak47
+ * @date 2026-10-16
+ */
+#include "octopus_bench.hpp"
+#include <iomanip>
+#include <mutex>
+
+#define BENCH_DEFAULT_SECONDS 3 // Measured run per backend and client count
+
+int main(int argc, char **argv)
+{
+    unsigned seconds = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : BENCH_DEFAULT_SECONDS;
+
+    std::cout << std::setw(9) << "backend" << std::setw(9) << "clients" << std::setw(12) << "requests/s" << std::setw(10) << "p50 us"
+              << std::setw(10) << "p99 us" << std::setw(16) << "server CPU us" << std::setw(11) << "syscalls" << std::setw(15) << "uring_enter" << std::endl;
+    for (const char *backend : {"epoll", "io_uring"})
+    {
+        for (size_t client_count : {1, 100})
+        {
+            BenchServer server;
+            if (!server.start({"--backend", backend}))
+                return 1;
+            std::vector<int> clients;
+            for (size_t i = 0; i < client_count; ++i)
+            {
+                int fd = bench_connect();
+                if (fd < 0)
+                    return 1;
+                clients.push_back(fd);
+            }
+
+            std::mutex samples_mutex;
+            std::vector<uint64_t> samples;
+            uint64_t requests = 0;
+            uint64_t server_cpu = server.get_cpu_ns();
+            OctopusBenchSyscalls server_syscalls = server.get_syscalls();
+            uint64_t start = bench_now_ns();
+            uint64_t deadline = start + seconds * 1000000000ull;
+            std::vector<std::thread> threads;
+            for (int fd : clients)
+            {
+                threads.emplace_back([&, fd]
+                {
+                    std::vector<uint64_t> own_samples;
+                    uint64_t replies = bench_pipelined_gets(fd, 1, deadline, &own_samples);
+                    std::lock_guard<std::mutex> lock(samples_mutex);
+                    samples.insert(samples.end(), own_samples.begin(), own_samples.end());
+                    requests += replies;
+                });
+            }
+            for (std::thread &thread : threads)
+                thread.join();
+            double elapsed_s = (bench_now_ns() - start) / 1e9;
+            server_cpu = server.get_cpu_ns() - server_cpu;
+            OctopusBenchSyscalls syscalls = server.get_syscalls() - server_syscalls;
+
+            double per_request = 1.0 / std::max<uint64_t>(1, requests);
+            std::cout << std::setw(9) << backend << std::setw(9) << client_count << std::fixed << std::setprecision(0)
+                      << std::setw(12) << requests / elapsed_s << std::setprecision(1)
+                      << std::setw(10) << bench_percentile(samples, 50) / 1000.0 << std::setw(10) << bench_percentile(samples, 99) / 1000.0
+                      << std::setprecision(2) << std::setw(16) << server_cpu / 1000.0 * per_request
+                      << std::setw(11) << syscalls.total() * per_request << std::setw(15) << syscalls.uring_enters * per_request << std::endl;
+
+            for (int fd : clients)
+                close(fd);
+            server.stop();
+        }
+    }
+    return 0;
+}
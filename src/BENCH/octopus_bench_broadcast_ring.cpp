@@ -0,0 +1,105 @@
+/**
+ * @file octopus_bench_broadcast_ring.cpp
+ * @brief Writer cost of the shared memory broadcast ring with 1 to 64 reader threads.
+ *
+ * The writer publishes meter sized frames back to back while every reader follows the ring
+ * with its own cursor. Reports the writer CPU time per publish (thread CPU clock), its wall time
+ * and the frames the readers received or lost to overruns. Readers run in two modes:
+ * - polling: a reader that caught up yields and reads again, the writer never touches it.
+ *   The writer cost does not depend on the number of readers.
+ * - parked: a reader that caught up sleeps in wait(). The writer wakes one sleeper and the woken
+ *   readers wake each other, so the writer cost stays flat here too.
+ *
+ * Uses its own ring, a running server is not disturbed.
+ *
+ * Usage: octopus_bench_broadcast_ring [frames]
+ *
+ * @author ak47
+ * @date 2026-10-16
+ */
+#include "octopus_bench.hpp"
+#include "octopus_ipc_shm_broadcast.hpp"
+#include <atomic>
+#include <iomanip>
+#include <sys/mman.h>
+
+#define BENCH_DEFAULT_FRAMES 200000                 // Frames published per reader count
+#define BENCH_RING_NAME "/octopus_bench_broadcast" // Not the server ring
+#define BENCH_PAYLOAD_LENGTH 28                     // Size of carinfo_meter_t
+
+int main(int argc, char **argv)
+{
+    size_t frames = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : BENCH_DEFAULT_FRAMES;
+    std::vector<uint8_t> frame = bench_frame(MSG_GROUP_CAR, MSG_IPC_CMD_CAR_GET_METER_INFO, std::vector<uint8_t>(BENCH_PAYLOAD_LENGTH, 0x5A));
+
+    std::cout << std::setw(8) << "mode" << std::setw(8) << "readers" << std::setw(16) << "writer CPU ns" << std::setw(16) << "writer wall ns"
+              << std::setw(14) << "received %" << std::setw(10) << "lost %" << std::endl;
+
+    for (bool parked : {false, true})
+    {
+        for (size_t reader_count : {1, 2, 4, 8, 16, 32, 64})
+        {
+            shm_unlink(BENCH_RING_NAME);
+            OctopusShmBroadcastWriter writer;
+            if (!writer.open(BENCH_RING_NAME))
+            {
+                std::cerr << "Cannot create " << BENCH_RING_NAME << std::endl;
+                return 1;
+            }
+
+            std::atomic<bool> running{true};
+            std::atomic<size_t> ready{0};
+            std::atomic<uint64_t> received{0}, lost{0};
+            std::vector<std::thread> readers;
+            for (size_t i = 0; i < reader_count; ++i)
+            {
+                readers.emplace_back([&]
+                {
+                    OctopusShmBroadcastReader reader;
+                    if (!reader.open(BENCH_RING_NAME))
+                        return;
+                    uint8_t buffer[SHM_BROADCAST_SLOT_DATA];
+                    size_t length;
+                    uint64_t count = 0;
+                    ready++;
+                    while (running)
+                    {
+                        ShmBroadcastResult result = reader.read(buffer, &length);
+                        if (result == ShmBroadcastResult::Frame)
+                            count++;
+                        else if (result == ShmBroadcastResult::Empty && parked)
+                            reader.wait(10);
+                        else if (result == ShmBroadcastResult::Empty)
+                            std::this_thread::yield();
+                    }
+                    // Whatever is left after the writer stopped
+                    while (reader.read(buffer, &length) != ShmBroadcastResult::Empty)
+                        count++;
+                    received += count;
+                    lost += reader.get_lost_frames();
+                });
+            }
+            while (ready < reader_count)
+                usleep(1000);
+
+            uint64_t cpu_start = bench_thread_cpu_ns();
+            uint64_t wall_start = bench_now_ns();
+            for (size_t i = 0; i < frames; ++i)
+                writer.publish(frame.data(), frame.size());
+            uint64_t wall_ns = bench_now_ns() - wall_start;
+            uint64_t cpu_ns = bench_thread_cpu_ns() - cpu_start;
+
+            running = false;
+            for (std::thread &reader : readers)
+                reader.join();
+            writer.close();
+
+            double expected = static_cast<double>(frames) * reader_count;
+            std::cout << std::setw(8) << (parked ? "parked" : "polling") << std::setw(8) << reader_count << std::fixed << std::setprecision(1)
+                      << std::setw(16) << static_cast<double>(cpu_ns) / frames << std::setw(16) << static_cast<double>(wall_ns) / frames
+                      << std::setw(14) << received * 100.0 / expected << std::setw(10) << lost * 100.0 / expected << std::endl;
+        }
+    }
+    shm_unlink(BENCH_RING_NAME);
+    return 0;
+}
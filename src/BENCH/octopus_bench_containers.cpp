@@ -0,0 +1,217 @@
+/**
+ * @file octopus_bench_containers.cpp
+ * @brief System calls and CPU per logical message, container frames against one frame per write.
+ *
+ * Client bursts: one client sends bursts of 8 carinfo GETs with request ids, either one write
+ * per frame or packed into one container frame (as the app client does within its window), and
+ * waits for the 8 replies. Container mode also asks the server for container replies.
+ *
+ * Server pushes: 16 clients subscribe to the meter and indicator pushed every 10 ms, with the
+ * keyframe interval forcing both out on every tick. The pushes of one drain reach a plain client
+ * in one gathered write already; a container client gets them as one frame, and with
+ * --container-window-us the pushes of a whole window.
+ *
+ * Usage: octopus_bench_containers [seconds]
+ *
+ * @author ak47
+ * @date 2026-10-16
+ */
+#include "octopus_bench.hpp"
+#include <atomic>
+#include <iomanip>
+
+#define BENCH_DEFAULT_SECONDS 3    // Measured run per configuration
+#define BENCH_BURST_FRAMES 8       // Frames of one client burst
+#define BENCH_PUSH_SUBSCRIBERS 16  // Clients receiving the pushes
+#define BENCH_PUSH_DELAY_10MS 1    // MSG_IPC_CMD_CONFIG_PUSH_DELAY unit is 10 ms
+#define BENCH_CONTAINER_WINDOW_US "2000"
+
+static bool bench_enable_containers(int fd)
+{
+    return bench_send_all(fd, bench_frame(MSG_GROUP_IPC_CONFIG, MSG_IPC_CMD_CONFIG_CONTAINER, {1}));
+}
+
+// Bursts of GETs until the deadline, returns the number of replies
+static uint64_t bench_client_bursts(int fd, bool containers, uint64_t deadline_ns, uint64_t &client_writes)
+{
+    BenchReader reader(fd);
+    DataMessageView view;
+    FrameContainerBuilder builder;
+    uint32_t request_id = 0;
+    uint64_t replies = 0;
+    while (bench_now_ns() < deadline_ns)
+    {
+        for (size_t i = 0; i < BENCH_BURST_FRAMES; ++i)
+        {
+            std::vector<uint8_t> frame = bench_frame(MSG_GROUP_CAR, MSG_IPC_CMD_CAR_GET_METER_INFO, {}, ++request_id);
+            if (containers)
+            {
+                builder.append(frame.data(), frame.size());
+                continue;
+            }
+            if (!bench_send_all(fd, frame))
+                return replies;
+            client_writes++;
+        }
+        if (containers)
+        {
+            if (!bench_send_all(fd, builder.take()))
+                return replies;
+            client_writes++;
+        }
+
+        for (size_t pending = BENCH_BURST_FRAMES; pending > 0; --pending)
+        {
+            do
+            {
+                if (!reader.next(MSG_GROUP_CAR, MSG_IPC_CMD_CAR_GET_METER_INFO, view))
+                    return replies;
+            } while (view.request_id == 0);
+            replies++;
+        }
+    }
+    return replies;
+}
+
+static bool bench_run_bursts(bool containers, unsigned seconds)
+{
+    BenchServer server;
+    if (!server.start())
+        return false;
+    int fd = bench_connect();
+    if (fd < 0 || (containers && !bench_enable_containers(fd)))
+        return false;
+    BenchReader(fd).drain();
+
+    uint64_t client_writes = 0;
+    uint64_t cpu_before = server.get_cpu_ns();
+    uint64_t client_cpu_before = bench_process_cpu_ns();
+    OctopusBenchSyscalls syscalls_before = server.get_syscalls();
+    uint64_t messages = bench_client_bursts(fd, containers, bench_now_ns() + seconds * 1000000000ull, client_writes);
+    OctopusBenchSyscalls syscalls = server.get_syscalls() - syscalls_before;
+    double server_cpu_us = (server.get_cpu_ns() - cpu_before) / 1000.0;
+    double client_cpu_us = (bench_process_cpu_ns() - client_cpu_before) / 1000.0;
+    double count = static_cast<double>(std::max<uint64_t>(1, messages));
+
+    std::cout << std::setw(20) << (containers ? "container" : "frame per write") << std::fixed
+              << std::setw(13) << std::setprecision(0) << messages / static_cast<double>(seconds)
+              << std::setw(16) << std::setprecision(3) << client_writes / count
+              << std::setw(16) << syscalls.reads / count
+              << std::setw(16) << syscalls.writes / count
+              << std::setw(16) << std::setprecision(2) << server_cpu_us / count
+              << std::setw(16) << client_cpu_us / count << std::endl;
+
+    close(fd);
+    server.stop();
+    return true;
+}
+
+static bool bench_run_pushes(const char *name, bool containers, bool window, unsigned seconds)
+{
+    BenchServer server;
+    std::vector<std::string> arguments;
+    if (window)
+        arguments = {"--container-window-us", BENCH_CONTAINER_WINDOW_US};
+    if (!server.start(arguments))
+        return false;
+
+    std::vector<int> subscribers;
+    for (size_t i = 0; i < BENCH_PUSH_SUBSCRIBERS; ++i)
+    {
+        int fd = bench_connect();
+        if (fd < 0)
+            return false;
+        std::vector<uint8_t> setup = bench_frame(MSG_GROUP_IPC_CONFIG, MSG_IPC_CMD_CONFIG_SUBSCRIBE,
+                                                 {MSG_GROUP_CAR, MSG_IPC_CMD_CAR_GET_METER_INFO, MSG_GROUP_CAR, MSG_IPC_CMD_CAR_GET_INDICATOR_INFO});
+        std::vector<uint8_t> keyframe = bench_frame(MSG_GROUP_IPC_CONFIG, MSG_IPC_CMD_CONFIG_KEYFRAME, {0, 10});
+        std::vector<uint8_t> delay = bench_frame(MSG_GROUP_IPC_CONFIG, MSG_IPC_CMD_CONFIG_PUSH_DELAY, {0, BENCH_PUSH_DELAY_10MS});
+        setup.insert(setup.end(), keyframe.begin(), keyframe.end());
+        setup.insert(setup.end(), delay.begin(), delay.end());
+        if (!bench_send_all(fd, setup) || (containers && !bench_enable_containers(fd)))
+            return false;
+        subscribers.push_back(fd);
+    }
+
+    // One thread keeps every client drained and counts the logical pushes, unpacked from containers
+    std::atomic<bool> running{true};
+    std::atomic<uint64_t> pushes{0};
+    std::atomic<uint64_t> client_reads{0};
+    std::thread drain([&]
+    {
+        std::vector<pollfd> fds;
+        std::vector<FrameDecoder> decoders(subscribers.size());
+        for (int fd : subscribers)
+            fds.push_back({fd, POLLIN, 0});
+        std::vector<uint8_t> buffer(IPC_SOCKET_PACKET_BUFFER_SIZE);
+        DataMessageView view;
+        while (running)
+        {
+            if (poll(fds.data(), fds.size(), 100) <= 0)
+                continue;
+            for (size_t i = 0; i < fds.size(); ++i)
+            {
+                if (!(fds[i].revents & POLLIN))
+                    continue;
+                ssize_t length = recv(fds[i].fd, buffer.data(), buffer.size(), 0);
+                if (length <= 0)
+                    continue;
+                client_reads++;
+                decoders[i].feed(buffer.data(), static_cast<size_t>(length));
+                while (decoders[i].next(view))
+                {
+                    if (view.msg_group == MSG_GROUP_CAR)
+                        pushes++;
+                }
+            }
+        }
+    });
+
+    sleep(1);
+    uint64_t pushes_before = pushes;
+    uint64_t client_reads_before = client_reads;
+    uint64_t cpu_before = server.get_cpu_ns();
+    OctopusBenchSyscalls syscalls_before = server.get_syscalls();
+    sleep(seconds);
+    double push_count = static_cast<double>(std::max<uint64_t>(1, pushes - pushes_before));
+    double cpu_us = (server.get_cpu_ns() - cpu_before) / 1000.0;
+    OctopusBenchSyscalls syscalls = server.get_syscalls() - syscalls_before;
+    uint64_t reads = client_reads - client_reads_before;
+    running = false;
+    drain.join();
+
+    std::cout << std::setw(20) << name << std::fixed
+              << std::setw(13) << std::setprecision(0) << push_count / seconds
+              << std::setw(16) << std::setprecision(3) << syscalls.writes / push_count
+              << std::setw(16) << syscalls.total() / push_count
+              << std::setw(16) << std::setprecision(2) << cpu_us / push_count
+              << std::setw(16) << std::setprecision(3) << reads / push_count << std::endl;
+
+    for (int fd : subscribers)
+        close(fd);
+    server.stop();
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    unsigned seconds = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : BENCH_DEFAULT_SECONDS;
+
+    std::cout << "Client bursts of " << BENCH_BURST_FRAMES << " requests, per logical message:" << std::endl;
+    std::cout << std::setw(20) << "mode" << std::setw(13) << "messages/s" << std::setw(16) << "client writes"
+              << std::setw(16) << "server reads" << std::setw(16) << "server writes"
+              << std::setw(16) << "server CPU us" << std::setw(16) << "client CPU us" << std::endl;
+    for (bool containers : {false, true})
+    {
+        if (!bench_run_bursts(containers, seconds))
+            return 1;
+    }
+
+    std::cout << std::endl << "Server pushes to " << BENCH_PUSH_SUBSCRIBERS << " subscribers, per logical push:" << std::endl;
+    std::cout << std::setw(20) << "mode" << std::setw(13) << "pushes/s" << std::setw(16) << "server writes"
+              << std::setw(16) << "syscalls" << std::setw(16) << "server CPU us" << std::setw(16) << "client reads" << std::endl;
+    if (!bench_run_pushes("frame per write", false, false, seconds) ||
+        !bench_run_pushes("container", true, false, seconds) ||
+        !bench_run_pushes("container window", true, true, seconds))
+        return 1;
+    return 0;
+}
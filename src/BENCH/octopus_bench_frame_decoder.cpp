@@ -0,0 +1,124 @@
+/**
+ * @file octopus_bench_frame_decoder.cpp
+ * @brief Decoding throughput of FrameDecoder against the former vector erase loop, 1 KB to 64 KB bursts.
+ *
+ * A burst of carinfo sized frames is fed to the decoder in chunks as a stream socket would
+ * deliver them, and every frame is extracted. Three decoders are compared:
+ * - legacy: the former client loop, std::vector append and erase() of each frame from the front,
+ * - message: FrameDecoder::next(DataMessage &), one owning message per frame,
+ * - view: FrameDecoder::next(DataMessageView &), no copy.
+ *
+ * Usage: octopus_bench_frame_decoder [read chunk bytes]
+ *
+ * @author ak47
+ * @date 2026-10-16
+ */
+#include "octopus_bench.hpp"
+#include <iomanip>
+
+#define BENCH_DEFAULT_CHUNK 4096    // Bytes handed over per read
+#define BENCH_PAYLOAD_LENGTH 28     // Size of carinfo_meter_t
+#define BENCH_MIN_RUN_NS 200000000u // Each measurement runs at least 200 ms
+
+// The former ipc_check_complete_data_packet(): header search, deserializeMessage() and erase()
+static bool bench_legacy_next(std::vector<uint8_t> &buffer, DataMessage &message)
+{
+    const size_t base_length = FrameDecoder::FRAME_BASE_LENGTH;
+    if (buffer.size() < base_length)
+        return false;
+    size_t skip = 0;
+    while (skip + 1 < buffer.size() && ((buffer[skip] << 8) | buffer[skip + 1]) != DataMessage::_HEADER_)
+        skip++;
+    if (skip > 0)
+        buffer.erase(buffer.begin(), buffer.begin() + skip);
+    if (buffer.size() < base_length)
+        return false;
+    size_t total_length = base_length + ((static_cast<uint16_t>(buffer[4]) << 8) | buffer[5]);
+    if (buffer.size() < total_length)
+        return false;
+    message = DataMessage::deserializeMessage(buffer);
+    buffer.erase(buffer.begin(), buffer.begin() + total_length);
+    return message.isValid();
+}
+
+// Runs decode_burst until BENCH_MIN_RUN_NS elapsed, returns ns per burst
+template <typename Decode>
+static double bench_measure(Decode decode_burst)
+{
+    uint64_t bursts = 0;
+    uint64_t start = bench_now_ns();
+    uint64_t elapsed;
+    do
+    {
+        decode_burst();
+        bursts++;
+        elapsed = bench_now_ns() - start;
+    } while (elapsed < BENCH_MIN_RUN_NS);
+    return static_cast<double>(elapsed) / bursts;
+}
+
+int main(int argc, char **argv)
+{
+    size_t chunk = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : BENCH_DEFAULT_CHUNK;
+    std::vector<uint8_t> payload(BENCH_PAYLOAD_LENGTH, 0x5A);
+    std::vector<uint8_t> frame = bench_frame(MSG_GROUP_CAR, MSG_IPC_CMD_CAR_GET_METER_INFO, payload);
+
+    std::cout << "Frames of " << frame.size() << " bytes, read chunks of " << chunk << " bytes, MB/s" << std::endl;
+    std::cout << std::setw(8) << "burst" << std::setw(8) << "frames" << std::setw(12) << "legacy"
+              << std::setw(12) << "message" << std::setw(12) << "view" << std::setw(16) << "view/legacy" << std::endl;
+
+    for (size_t burst_bytes : {1024, 4096, 16384, 65536})
+    {
+        std::vector<uint8_t> burst;
+        while (burst.size() + frame.size() <= burst_bytes)
+            burst.insert(burst.end(), frame.begin(), frame.end());
+        size_t frame_count = burst.size() / frame.size();
+        size_t decoded = 0;
+
+        std::vector<uint8_t> legacy_buffer;
+        double legacy_ns = bench_measure([&]
+        {
+            DataMessage message;
+            for (size_t offset = 0; offset < burst.size(); offset += chunk)
+            {
+                legacy_buffer.insert(legacy_buffer.end(), burst.begin() + offset, burst.begin() + std::min(burst.size(), offset + chunk));
+                while (bench_legacy_next(legacy_buffer, message))
+                    decoded++;
+            }
+        });
+
+        FrameDecoder decoder;
+        double message_ns = bench_measure([&]
+        {
+            DataMessage message;
+            for (size_t offset = 0; offset < burst.size(); offset += chunk)
+            {
+                decoder.feed(burst.data() + offset, std::min(chunk, burst.size() - offset));
+                while (decoder.next(message))
+                    decoded++;
+            }
+        });
+
+        double view_ns = bench_measure([&]
+        {
+            DataMessageView view;
+            for (size_t offset = 0; offset < burst.size(); offset += chunk)
+            {
+                decoder.feed(burst.data() + offset, std::min(chunk, burst.size() - offset));
+                while (decoder.next(view))
+                {
+                    bench_keep(view.data.data());
+                    decoded++;
+                }
+            }
+        });
+        bench_keep(decoded);
+
+        auto mb_per_s = [&](double ns) { return burst.size() / ns * 1e9 / (1024 * 1024); };
+        std::cout << std::setw(8) << burst_bytes << std::setw(8) << frame_count << std::fixed << std::setprecision(0)
+                  << std::setw(12) << mb_per_s(legacy_ns) << std::setw(12) << mb_per_s(message_ns)
+                  << std::setw(12) << mb_per_s(view_ns) << std::setw(16) << std::setprecision(1)
+                  << legacy_ns / view_ns << std::endl;
+    }
+    return 0;
+}
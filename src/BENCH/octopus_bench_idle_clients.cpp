@@ -0,0 +1,107 @@
+/**
+ * @file octopus_bench_idle_clients.cpp
+ * @brief Idle cost and request latency of the server with 10, 100 and 500 connected clients.
+ *
+ * For each server binary given on the command line (the one built here by default), and each
+ * client count: connects the clients, lets them sit idle and measures the server CPU time, its
+ * system calls per second (wakeups), RSS and thread count. Then one more client measures the round
+ * trip of a carinfo GET while the others stay connected.
+ *
+ * Pass a build of the thread-per-client server next to the current one to compare both models:
+ *   octopus_bench_idle_clients ./octopus_ipc_server /path/to/thread_per_client/octopus_ipc_server
+ *
+ * @author ak47
+ * @date 2026-10-16
+ */
+#include "octopus_bench.hpp"
+#include <iomanip>
+#include <sys/resource.h>
+
+#define BENCH_IDLE_SECONDS 5        // Idle period measured
+#define BENCH_LATENCY_REQUESTS 2000 // Round trips of the latency probe
+
+// Round trip of one request: until the reply bytes arrive, whatever the reply format of the server
+static bool bench_round_trip(int fd, const std::vector<uint8_t> &request, uint64_t &elapsed_ns)
+{
+    uint8_t reply[IPC_SOCKET_PACKET_BUFFER_SIZE];
+    uint64_t start = bench_now_ns();
+    if (!bench_send_all(fd, request))
+        return false;
+    pollfd readable = {fd, POLLIN, 0};
+    if (poll(&readable, 1, 1000) <= 0 || recv(fd, reply, sizeof(reply), 0) <= 0)
+        return false;
+    elapsed_ns = bench_now_ns() - start;
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    std::vector<std::string> binaries;
+    for (int i = 1; i < argc; ++i)
+        binaries.push_back(argv[i]);
+    if (binaries.empty())
+        binaries.push_back(OCTOPUS_BENCH_SERVER);
+
+    // 500 clients and the server each need more descriptors than the usual soft limit
+    rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0)
+    {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+
+    std::cout << std::left << std::setw(48) << "server" << std::right << std::setw(8) << "clients"
+              << std::setw(12) << "idle CPU %" << std::setw(14) << "syscalls/s" << std::setw(10) << "RSS KB"
+              << std::setw(9) << "threads" << std::setw(10) << "p50 us" << std::setw(10) << "p99 us" << std::endl;
+
+    const std::vector<uint8_t> request = bench_frame(MSG_GROUP_CAR, MSG_IPC_CMD_CAR_GET_METER_INFO);
+    for (const std::string &binary : binaries)
+    {
+        for (size_t client_count : {10, 100, 500})
+        {
+            BenchServer server;
+            if (!server.start({}, binary))
+                return 1;
+
+            std::vector<int> clients;
+            for (size_t i = 0; i < client_count; ++i)
+            {
+                int fd = bench_connect();
+                if (fd < 0)
+                    break;
+                clients.push_back(fd);
+            }
+            int probe = bench_connect();
+            sleep(1);
+
+            uint64_t cpu_before = server.get_cpu_ns();
+            OctopusBenchSyscalls syscalls_before = server.get_syscalls();
+            sleep(BENCH_IDLE_SECONDS);
+            uint64_t idle_cpu = server.get_cpu_ns() - cpu_before;
+            OctopusBenchSyscalls idle_syscalls = server.get_syscalls() - syscalls_before;
+
+            std::vector<uint64_t> samples;
+            uint64_t elapsed_ns;
+            for (int i = 0; i < BENCH_LATENCY_REQUESTS && probe >= 0; ++i)
+            {
+                if (bench_round_trip(probe, request, elapsed_ns))
+                    samples.push_back(elapsed_ns);
+            }
+
+            std::cout << std::left << std::setw(48) << binary.substr(binary.size() > 47 ? binary.size() - 47 : 0)
+                      << std::right << std::setw(8) << clients.size()
+                      << std::setw(12) << std::fixed << std::setprecision(2) << idle_cpu * 100.0 / (BENCH_IDLE_SECONDS * 1e9)
+                      << std::setw(14) << std::setprecision(1) << idle_syscalls.total() / static_cast<double>(BENCH_IDLE_SECONDS)
+                      << std::setw(10) << server.get_rss_kb() << std::setw(9) << server.get_threads()
+                      << std::setw(10) << bench_percentile(samples, 50) / 1000.0
+                      << std::setw(10) << bench_percentile(samples, 99) / 1000.0 << std::endl;
+
+            for (int fd : clients)
+                close(fd);
+            if (probe >= 0)
+                close(probe);
+            server.stop();
+        }
+    }
+    return 0;
+}
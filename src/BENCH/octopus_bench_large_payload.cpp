@@ -0,0 +1,158 @@
+/**
+ * @file octopus_bench_large_payload.cpp
+ * @brief Throughput of 1 MB to 64 MB payloads: sealed memfd passed with SCM_RIGHTS versus 64 KB frames.
+ *
+ * The benchmark forks, parent and child talk over a Unix stream socketpair. For each size the
+ * parent hands the same payload to the child twice:
+ * - memfd: large_payload_create() (one copy into the memfd), the descriptor frame and the fd in
+ *   one sendmsg(), the child maps it read-only,
+ * - frames: the payload cut into frames of the largest msg_length, the child reassembles it.
+ * The child reads every byte of the received payload, then acknowledges with the CPU time it spent
+ * receiving. Time runs from the start of the send to the acknowledgement, best of BENCH_ROUNDS.
+ *
+ * @author ak47
+ * @date 2026-10-16
+ */
+#include "octopus_bench.hpp"
+#include "octopus_ipc_large_payload.hpp"
+#include <iomanip>
+
+#define BENCH_FRAME_PAYLOAD 0xFFFF // Largest msg_length
+#define BENCH_RECEIVE_TIMEOUT_MS 10000
+#define BENCH_ROUNDS 3             // Best of, per size and path
+
+static const size_t bench_sizes_mb[] = {1, 4, 16, 64};
+
+// Reads every byte like a consumer of the payload would
+static uint64_t bench_consume(const uint8_t *data, size_t size)
+{
+    uint64_t sum = 0;
+    for (size_t i = 0; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t))
+    {
+        uint64_t word;
+        memcpy(&word, data + i, sizeof(word));
+        sum += word;
+    }
+    return sum;
+}
+
+// Child: receives BENCH_ROUNDS memfd payloads then BENCH_ROUNDS framed payloads per size
+static void bench_child(int fd)
+{
+    Socket socket;
+    FrameDecoder decoder;
+    DataMessageView view;
+    std::vector<int> fds;
+    size_t received;
+    uint64_t cpu_ns;
+    for (size_t size_mb : bench_sizes_mb)
+    {
+        size_t size = size_mb * 1024 * 1024;
+        std::vector<uint8_t> reassembled(size);
+        for (int round = 0; round < BENCH_ROUNDS; ++round)
+        {
+            // memfd: one descriptor frame carrying the fd
+            uint64_t cpu_start = bench_thread_cpu_ns();
+            while (!decoder.next(view))
+            {
+                if (socket.get_response_with_epoll(fd, BENCH_RECEIVE_TIMEOUT_MS, decoder, received, fds) != QueryStatus::Success)
+                    return;
+            }
+            uint8_t group, msg_id;
+            size_t payload_size;
+            OctopusLargePayload payload;
+            if (fds.empty() || !large_payload_parse_descriptor(view, &group, &msg_id, &payload_size) || !payload.map(fds[0], payload_size))
+                return;
+            fds.clear();
+            bench_keep(bench_consume(payload.data(), payload.size()));
+            payload.unmap();
+            cpu_ns = bench_thread_cpu_ns() - cpu_start;
+            socket.send_buff(fd, reinterpret_cast<uint8_t *>(&cpu_ns), sizeof(cpu_ns));
+        }
+        for (int round = 0; round < BENCH_ROUNDS; ++round)
+        {
+            uint64_t cpu_start = bench_thread_cpu_ns();
+            for (size_t offset = 0; offset < size;)
+            {
+                while (!decoder.next(view))
+                {
+                    if (socket.get_response_with_epoll(fd, BENCH_RECEIVE_TIMEOUT_MS, decoder, received, fds) != QueryStatus::Success)
+                        return;
+                }
+                memcpy(reassembled.data() + offset, view.data.data(), view.data.size());
+                offset += view.data.size();
+            }
+            bench_keep(bench_consume(reassembled.data(), size));
+            cpu_ns = bench_thread_cpu_ns() - cpu_start;
+            socket.send_buff(fd, reinterpret_cast<uint8_t *>(&cpu_ns), sizeof(cpu_ns));
+        }
+    }
+}
+
+int main()
+{
+    int socket_fds[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, socket_fds) == -1)
+        return 1;
+    pid_t child = fork();
+    if (child == 0)
+    {
+        close(socket_fds[0]);
+        bench_child(socket_fds[1]);
+        _exit(0);
+    }
+    close(socket_fds[1]);
+    int fd = socket_fds[0];
+    Socket socket;
+    uint64_t receiver_cpu_ns;
+
+    std::cout << std::setw(8) << "size MB" << std::setw(14) << "memfd MB/s" << std::setw(14) << "frames MB/s"
+              << std::setw(10) << "speedup" << std::setw(20) << "receiver CPU ms" << std::endl;
+    for (size_t size_mb : bench_sizes_mb)
+    {
+        size_t size = size_mb * 1024 * 1024;
+        std::vector<uint8_t> source(size);
+        for (size_t i = 0; i < size; ++i)
+            source[i] = static_cast<uint8_t>(i * 31);
+
+        uint64_t memfd_ns = UINT64_MAX, memfd_cpu_ns = UINT64_MAX;
+        for (int round = 0; round < BENCH_ROUNDS; ++round)
+        {
+            uint64_t start = bench_now_ns();
+            int memfd = large_payload_create(source.data(), size);
+            std::vector<uint8_t> descriptor = large_payload_make_descriptor(MSG_GROUP_MCU, 0, size).serializeMessage();
+            if (memfd < 0 || socket.send_buff_with_fds(fd, descriptor.data(), static_cast<int>(descriptor.size()), &memfd, 1) <= 0)
+                return 1;
+            close(memfd);
+            if (read(fd, &receiver_cpu_ns, sizeof(receiver_cpu_ns)) != sizeof(receiver_cpu_ns))
+                return 1;
+            memfd_ns = std::min(memfd_ns, bench_now_ns() - start);
+            memfd_cpu_ns = std::min(memfd_cpu_ns, receiver_cpu_ns);
+        }
+
+        uint64_t frames_ns = UINT64_MAX, frames_cpu_ns = UINT64_MAX;
+        for (int round = 0; round < BENCH_ROUNDS; ++round)
+        {
+            uint64_t start = bench_now_ns();
+            for (size_t offset = 0; offset < size; offset += BENCH_FRAME_PAYLOAD)
+            {
+                size_t length = std::min<size_t>(BENCH_FRAME_PAYLOAD, size - offset);
+                std::vector<uint8_t> frame = DataMessage(MSG_GROUP_MCU, 0, source.data() + offset, length).serializeMessage();
+                socket.send_buff(fd, frame.data(), static_cast<int>(frame.size()));
+            }
+            if (read(fd, &receiver_cpu_ns, sizeof(receiver_cpu_ns)) != sizeof(receiver_cpu_ns))
+                return 1;
+            frames_ns = std::min(frames_ns, bench_now_ns() - start);
+            frames_cpu_ns = std::min(frames_cpu_ns, receiver_cpu_ns);
+        }
+
+        std::cout << std::setw(8) << size_mb << std::fixed << std::setprecision(0)
+                  << std::setw(14) << size_mb / (memfd_ns / 1e9) << std::setw(14) << size_mb / (frames_ns / 1e9)
+                  << std::setw(10) << std::setprecision(2) << static_cast<double>(frames_ns) / memfd_ns
+                  << std::setw(11) << std::setprecision(1) << memfd_cpu_ns / 1e6 << " /" << std::setw(7) << frames_cpu_ns / 1e6 << std::endl;
+    }
+    std::cout << "receiver CPU ms: memfd / frames" << std::endl;
+    close(fd);
+    waitpid(child, nullptr, 0);
+    return 0;
+}
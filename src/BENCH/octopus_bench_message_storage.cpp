@@ -0,0 +1,90 @@
+/**
+ * @file octopus_bench_message_storage.cpp
+ * @brief Construct, serialize and copy of DataMessage with inline payload storage, 0 to 1024 bytes.
+ *
+ * DataMessage keeps payloads of up to DATA_MESSAGE_INLINE_CAPACITY bytes inline. The reference
+ * is the former layout: the payload in a std::vector and a serializeMessage() growing its result
+ * with push_back(). Reports ns and heap allocations per operation.
+ *
+ * @author ak47
+ * @date 2026-10-16
+ */
+#include "octopus_bench.hpp"
+#include "octopus_bench_allocations.hpp"
+#include <iomanip>
+
+#define BENCH_ITERATIONS 200000 // Operations measured per cell
+
+struct BenchCell
+{
+    double ns;
+    double allocations;
+};
+
+template <typename Operation>
+static BenchCell bench_measure(Operation operation)
+{
+    uint64_t allocations = bench_allocations();
+    uint64_t start = bench_now_ns();
+    for (int i = 0; i < BENCH_ITERATIONS; ++i)
+        operation();
+    return {static_cast<double>(bench_now_ns() - start) / BENCH_ITERATIONS,
+            static_cast<double>(bench_allocations() - allocations) / BENCH_ITERATIONS};
+}
+
+static void bench_print(const char *layout, size_t payload_length, const BenchCell &construct, const BenchCell &serialize, const BenchCell &copy)
+{
+    std::cout << std::setw(8) << payload_length << std::setw(9) << layout << std::fixed;
+    for (const BenchCell &cell : {construct, serialize, copy})
+        std::cout << std::setw(10) << std::setprecision(1) << cell.ns << " /" << std::setw(5) << std::setprecision(2) << cell.allocations;
+    std::cout << std::endl;
+}
+
+int main()
+{
+    std::cout << "ns / allocations per operation, inline capacity " << DATA_MESSAGE_INLINE_CAPACITY << " bytes" << std::endl;
+    std::cout << std::setw(8) << "payload" << std::setw(9) << "layout" << std::setw(17) << "construct"
+              << std::setw(17) << "serialize" << std::setw(17) << "copy" << std::endl;
+
+    for (size_t payload_length : {0, 8, 32, 64, 1024})
+    {
+        std::vector<uint8_t> payload(payload_length, 0x5A);
+
+        DataMessage message(MSG_GROUP_CAR, MSG_IPC_CMD_CAR_GET_METER_INFO, payload.data(), payload.size());
+        BenchCell construct = bench_measure([&]
+        {
+            DataMessage constructed(MSG_GROUP_CAR, MSG_IPC_CMD_CAR_GET_METER_INFO, payload.data(), payload.size());
+            bench_keep(constructed);
+        });
+        BenchCell serialize = bench_measure([&]
+        {
+            std::vector<uint8_t> frame = message.serializeMessage();
+            bench_keep(frame);
+        });
+        BenchCell copy = bench_measure([&]
+        {
+            DataMessage copied = message;
+            bench_keep(copied);
+        });
+        bench_print("inline", payload_length, construct, serialize, copy);
+
+        BenchVectorMessage reference(MSG_GROUP_CAR, MSG_IPC_CMD_CAR_GET_METER_INFO, payload);
+        construct = bench_measure([&]
+        {
+            BenchVectorMessage constructed(MSG_GROUP_CAR, MSG_IPC_CMD_CAR_GET_METER_INFO, payload);
+            bench_keep(constructed);
+        });
+        serialize = bench_measure([&]
+        {
+            std::vector<uint8_t> frame = reference.serializeMessage();
+            bench_keep(frame);
+        });
+        copy = bench_measure([&]
+        {
+            BenchVectorMessage copied = reference;
+            bench_keep(copied);
+        });
+        bench_print("vector", payload_length, construct, serialize, copy);
+    }
+    return 0;
+}
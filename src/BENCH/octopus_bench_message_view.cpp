@@ -0,0 +1,102 @@
+/**
+ * @file octopus_bench_message_view.cpp
+ * @brief Heap allocations and time per inbound message: owning DataMessage copies versus DataMessageView.
+ *
+ * Bursts of frames are parsed and handed to a handler in three ways:
+ * - legacy: the frame as a received std::vector, DataMessage::deserializeMessage() and the copy
+ *   of the message the handler task captured,
+ * - message: FrameDecoder::next(DataMessage &), one owning message per frame,
+ * - view: FrameDecoder::next(DataMessageView &) and a handler taking the view.
+ * Payloads up to DATA_MESSAGE_INLINE_CAPACITY bytes fit DataMessage without allocating, larger
+ * ones show what copying costs.
+ *
+ * @author ak47
+ * @date 2026-10-16
+ */
+#include "octopus_bench.hpp"
+#include "octopus_bench_allocations.hpp"
+#include <functional>
+#include <iomanip>
+
+#define BENCH_BURST_FRAMES 64 // Frames per burst
+#define BENCH_BURSTS 20000    // Bursts measured per path
+
+struct BenchResult
+{
+    double allocations_per_message;
+    double ns_per_message;
+};
+
+// Runs handle_burst BENCH_BURSTS times, per message cost
+template <typename HandleBurst>
+static BenchResult bench_measure(HandleBurst handle_burst)
+{
+    uint64_t allocations = bench_allocations();
+    uint64_t start = bench_now_ns();
+    for (int i = 0; i < BENCH_BURSTS; ++i)
+        handle_burst();
+    double messages = static_cast<double>(BENCH_BURSTS) * BENCH_BURST_FRAMES;
+    return {(bench_allocations() - allocations) / messages, (bench_now_ns() - start) / messages};
+}
+
+int main()
+{
+    std::cout << std::setw(8) << "payload" << std::setw(20) << "legacy" << std::setw(20) << "message" << std::setw(20) << "view" << std::endl;
+    std::cout << std::setw(8) << "bytes" << std::setw(20) << "allocs / ns" << std::setw(20) << "allocs / ns" << std::setw(20) << "allocs / ns" << std::endl;
+
+    for (size_t payload_length : {8, 28, 256, 1024})
+    {
+        std::vector<uint8_t> frame = bench_frame(MSG_GROUP_CAR, MSG_IPC_CMD_CAR_GET_METER_INFO, std::vector<uint8_t>(payload_length, 0x5A));
+        std::vector<uint8_t> burst;
+        for (int i = 0; i < BENCH_BURST_FRAMES; ++i)
+            burst.insert(burst.end(), frame.begin(), frame.end());
+        uint64_t checksum = 0;
+
+        // Stand-ins for a handler task (a message copy captured by a lambda) and a handler taking a view
+        std::function<void(const DataMessage &)> message_handler = [&](const DataMessage &message)
+        {
+            DataMessage captured = message;
+            checksum += captured.data[0];
+        };
+        auto view_handler = [&](const DataMessageView &view) { checksum += view.data.data()[0]; };
+
+        BenchResult legacy = bench_measure([&]
+        {
+            for (size_t offset = 0; offset < burst.size(); offset += frame.size())
+            {
+                std::vector<uint8_t> received(burst.begin() + offset, burst.begin() + offset + frame.size());
+                message_handler(DataMessage::deserializeMessage(received));
+            }
+        });
+
+        FrameDecoder decoder;
+        BenchResult message = bench_measure([&]
+        {
+            DataMessage decoded;
+            decoder.feed(burst);
+            while (decoder.next(decoded))
+                message_handler(decoded);
+        });
+
+        BenchResult view = bench_measure([&]
+        {
+            DataMessageView decoded;
+            decoder.feed(burst);
+            while (decoder.next(decoded))
+                view_handler(decoded);
+        });
+        bench_keep(checksum);
+
+        auto print = [](const BenchResult &result)
+        {
+            std::cout << std::setw(11) << std::setprecision(2) << result.allocations_per_message << " /"
+                      << std::setw(7) << std::setprecision(1) << result.ns_per_message;
+        };
+        std::cout << std::setw(8) << payload_length << std::fixed;
+        print(legacy);
+        print(message);
+        print(view);
+        std::cout << std::endl;
+    }
+    return 0;
+}
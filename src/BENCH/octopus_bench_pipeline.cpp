@@ -0,0 +1,51 @@
+/**
+ * @file octopus_bench_pipeline.cpp
+ * @brief Requests per second of one connection with 1, 8 and 64 requests in flight.
+ *
+ * The client sends carinfo GETs with request ids in batches of depth requests and waits for all
+ * replies of a batch. Depth 1 is the former one request per round trip.
+ *
+ * Usage: octopus_bench_pipeline [seconds]
+ *
+ * @author ak47
+ * @date 2026-10-16
+ */
+#include "octopus_bench.hpp"
+#include <iomanip>
+
+#define BENCH_DEFAULT_SECONDS 3 // Measured run per depth
+
+int main(int argc, char **argv)
+{
+    unsigned seconds = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : BENCH_DEFAULT_SECONDS;
+
+    BenchServer server;
+    if (!server.start())
+        return 1;
+    int fd = bench_connect();
+    if (fd < 0)
+        return 1;
+
+    std::cout << std::setw(7) << "depth" << std::setw(13) << "requests/s" << std::setw(10) << "speedup"
+              << std::setw(18) << "batch p99 us" << std::setw(22) << "server syscalls/req" << std::endl;
+    double depth_one_rate = 0;
+    for (size_t depth : {1, 8, 64})
+    {
+        std::vector<uint64_t> samples;
+        OctopusBenchSyscalls server_syscalls = server.get_syscalls();
+        uint64_t start = bench_now_ns();
+        uint64_t replies = bench_pipelined_gets(fd, depth, start + seconds * 1000000000ull, &samples);
+        double rate = replies / ((bench_now_ns() - start) / 1e9);
+        OctopusBenchSyscalls syscalls = server.get_syscalls() - server_syscalls;
+        if (depth == 1)
+            depth_one_rate = rate;
+
+        std::cout << std::setw(7) << depth << std::fixed << std::setw(13) << std::setprecision(0) << rate
+                  << std::setw(10) << std::setprecision(2) << rate / depth_one_rate
+                  << std::setw(18) << std::setprecision(1) << bench_percentile(samples, 99) / 1000.0
+                  << std::setw(22) << std::setprecision(2) << syscalls.total() / static_cast<double>(std::max<uint64_t>(1, replies)) << std::endl;
+    }
+    close(fd);
+    server.stop();
+    return 0;
+}
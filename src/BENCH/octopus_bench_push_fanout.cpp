@@ -0,0 +1,117 @@
+/**
+ * @file octopus_bench_push_fanout.cpp
+ * @brief Server cost of a push as the number of subscribers grows, matching and non-matching topics.
+ *
+ * OTSM pushes the meter every 10 ms. A probe client subscribed to the meter counts the pushes,
+ * 0 to 64 more clients subscribe either to the meter as well (matching) or to a topic that is
+ * never pushed (non-matching). Reports the server CPU time and the system calls per push.
+ *
+ * With the topic index, non-matching subscribers cost nothing per push; matching ones cost one
+ * queued frame and one write each.
+ *
+ * Usage: octopus_bench_push_fanout [seconds]
+ *
+ * @author ak47
+ * @date 2026-10-16
+ */
+#include "octopus_bench.hpp"
+#include <atomic>
+#include <iomanip>
+
+#define BENCH_DEFAULT_SECONDS 5  // Measured run per configuration
+#define BENCH_PUSH_DELAY_10MS 1  // MSG_IPC_CMD_CONFIG_PUSH_DELAY unit is 10 ms
+
+static bool bench_subscribe(int fd, uint8_t group, uint8_t msg_id)
+{
+    return bench_send_all(fd, bench_frame(MSG_GROUP_IPC_CONFIG, MSG_IPC_CMD_CONFIG_SUBSCRIBE, {group, msg_id}));
+}
+
+int main(int argc, char **argv)
+{
+    unsigned seconds = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : BENCH_DEFAULT_SECONDS;
+
+    std::cout << std::setw(14) << "topic" << std::setw(13) << "subscribers" << std::setw(10) << "pushes/s"
+              << std::setw(16) << "CPU us/push" << std::setw(15) << "writes/push" << std::setw(17) << "syscalls/push" << std::endl;
+
+    for (bool matching : {true, false})
+    {
+        for (size_t subscriber_count : {0, 1, 4, 16, 64})
+        {
+            BenchServer server;
+            if (!server.start())
+                return 1;
+
+            int probe = bench_connect();
+            if (probe < 0 || !bench_subscribe(probe, MSG_GROUP_CAR, MSG_IPC_CMD_CAR_GET_METER_INFO) ||
+                !bench_send_all(probe, bench_frame(MSG_GROUP_IPC_CONFIG, MSG_IPC_CMD_CONFIG_PUSH_DELAY, {0, BENCH_PUSH_DELAY_10MS})))
+                return 1;
+            std::vector<int> subscribers;
+            for (size_t i = 0; i < subscriber_count; ++i)
+            {
+                int fd = bench_connect();
+                if (fd < 0)
+                    return 1;
+                if (matching)
+                    bench_subscribe(fd, MSG_GROUP_CAR, MSG_IPC_CMD_CAR_GET_METER_INFO);
+                else
+                    bench_subscribe(fd, MSG_GROUP_SET, 1);
+                subscribers.push_back(fd);
+            }
+
+            // One thread keeps every client drained, the probe counts the meter pushes
+            std::atomic<bool> running{true};
+            std::atomic<uint64_t> pushes{0};
+            std::thread drain([&]
+            {
+                std::vector<pollfd> fds = {{probe, POLLIN, 0}};
+                for (int fd : subscribers)
+                    fds.push_back({fd, POLLIN, 0});
+                std::vector<uint8_t> buffer(IPC_SOCKET_PACKET_BUFFER_SIZE);
+                FrameDecoder decoder;
+                DataMessageView view;
+                while (running)
+                {
+                    if (poll(fds.data(), fds.size(), 100) <= 0)
+                        continue;
+                    for (pollfd &entry : fds)
+                    {
+                        if (!(entry.revents & POLLIN))
+                            continue;
+                        ssize_t length = recv(entry.fd, buffer.data(), buffer.size(), 0);
+                        if (entry.fd != probe || length <= 0)
+                            continue;
+                        decoder.feed(buffer.data(), static_cast<size_t>(length));
+                        while (decoder.next(view))
+                        {
+                            if (view.msg_group == MSG_GROUP_CAR && view.msg_id == MSG_IPC_CMD_CAR_GET_METER_INFO)
+                                pushes++;
+                        }
+                    }
+                }
+            });
+
+            sleep(1);
+            uint64_t pushes_before = pushes;
+            uint64_t cpu_before = server.get_cpu_ns();
+            OctopusBenchSyscalls syscalls_before = server.get_syscalls();
+            sleep(seconds);
+            uint64_t push_count = std::max<uint64_t>(1, pushes - pushes_before);
+            double cpu_us = (server.get_cpu_ns() - cpu_before) / 1000.0;
+            OctopusBenchSyscalls syscalls = server.get_syscalls() - syscalls_before;
+            running = false;
+            drain.join();
+
+            std::cout << std::setw(14) << (matching ? "matching" : "non-matching") << std::setw(13) << subscriber_count
+                      << std::setw(10) << std::fixed << std::setprecision(0) << push_count / static_cast<double>(seconds)
+                      << std::setw(16) << std::setprecision(1) << cpu_us / push_count
+                      << std::setw(15) << std::setprecision(2) << syscalls.writes / static_cast<double>(push_count)
+                      << std::setw(17) << syscalls.total() / static_cast<double>(push_count) << std::endl;
+
+            close(probe);
+            for (int fd : subscribers)
+                close(fd);
+            server.stop();
+        }
+    }
+    return 0;
+}
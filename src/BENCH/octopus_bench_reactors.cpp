@@ -0,0 +1,75 @@
+/**
+ * @file octopus_bench_reactors.cpp
+ * @brief Request throughput of the server with 1, 2, 4 and one reactor per core.
+ *
+ * Many clients, one thread each, send pipelined carinfo GETs for a fixed time against a server
+ * started with --reactors N. Reports replies per second, the server CPU usage and the speedup
+ * over a single reactor. Throughput should grow with the reactor count up to the core count.
+ *
+ * Usage: octopus_bench_reactors [clients] [seconds]
+ *
+ * @author ak47
+ * @date 2026-10-16
+ */
+#include "octopus_bench.hpp"
+#include <atomic>
+#include <iomanip>
+#include <set>
+
+#define BENCH_DEFAULT_CLIENTS 64 // Concurrent clients
+#define BENCH_DEFAULT_SECONDS 3  // Measured run per reactor count
+#define BENCH_PIPELINE_DEPTH 8   // Requests in flight per client
+
+int main(int argc, char **argv)
+{
+    size_t client_count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : BENCH_DEFAULT_CLIENTS;
+    unsigned seconds = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : BENCH_DEFAULT_SECONDS;
+    unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+    std::set<unsigned> reactor_counts = {1, 2, 4, cores};
+
+    std::cout << client_count << " clients, pipeline depth " << BENCH_PIPELINE_DEPTH << ", " << cores << " cores" << std::endl;
+    std::cout << std::setw(9) << "reactors" << std::setw(14) << "replies/s" << std::setw(14) << "server CPU %"
+              << std::setw(10) << "speedup" << std::endl;
+
+    double single_reactor_rate = 0;
+    for (unsigned reactors : reactor_counts)
+    {
+        BenchServer server;
+        if (!server.start({"--reactors", std::to_string(reactors)}))
+            return 1;
+
+        std::vector<int> clients;
+        for (size_t i = 0; i < client_count; ++i)
+        {
+            int fd = bench_connect();
+            if (fd < 0)
+                return 1;
+            clients.push_back(fd);
+        }
+
+        std::atomic<uint64_t> replies{0};
+        uint64_t cpu_before = server.get_cpu_ns();
+        uint64_t start = bench_now_ns();
+        uint64_t deadline = start + seconds * 1000000000ull;
+        std::vector<std::thread> threads;
+        for (int fd : clients)
+            threads.emplace_back([fd, deadline, &replies]
+                                 { replies += bench_pipelined_gets(fd, BENCH_PIPELINE_DEPTH, deadline); });
+        for (std::thread &thread : threads)
+            thread.join();
+        double elapsed_s = (bench_now_ns() - start) / 1e9;
+        double server_cpu = (server.get_cpu_ns() - cpu_before) / 1e9 / elapsed_s;
+
+        double rate = replies / elapsed_s;
+        if (reactors == 1)
+            single_reactor_rate = rate;
+        std::cout << std::setw(9) << reactors << std::setw(14) << std::fixed << std::setprecision(0) << rate
+                  << std::setw(14) << std::setprecision(1) << server_cpu * 100
+                  << std::setw(10) << std::setprecision(2) << (single_reactor_rate > 0 ? rate / single_reactor_rate : 0) << std::endl;
+
+        for (int fd : clients)
+            close(fd);
+        server.stop();
+    }
+    return 0;
+}
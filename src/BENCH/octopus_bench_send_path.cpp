@@ -0,0 +1,84 @@
+/**
+ * @file octopus_bench_send_path.cpp
+ * @brief Send path throughput: the former vector and stack copy against serializeInto() and send_message().
+ *
+ * A thread drains one end of a Unix stream socketpair while the benchmark writes frames into the
+ * other, one message per call:
+ * - legacy: serializeMessage() of the former layout (push_back), copied into a stack buffer, write(),
+ * - into: DataMessage::serializeInto() a reused buffer, Socket::send_frames(),
+ * - writev: Socket::send_message(), header and payload as separate iovecs, nothing copied.
+ * Reports frame MB/s and write system calls per message (OBENCHSC linked in).
+ *
+ * @author ak47
+ * @date 2026-10-16
+ */
+#include "octopus_bench.hpp"
+#include <atomic>
+#include <iomanip>
+
+#define BENCH_MESSAGES 200000 // Messages per path and payload size
+
+// The former Socket::send_query(): a stack copy of the serialized vector, then write()
+static bool bench_legacy_send(int fd, const std::vector<uint8_t> &query_vector)
+{
+    char query_buffer[query_vector.size()];
+    for (size_t i = 0; i < query_vector.size(); i++)
+        query_buffer[i] = query_vector[i];
+    return write(fd, query_buffer, sizeof(query_buffer)) == static_cast<ssize_t>(sizeof(query_buffer));
+}
+
+int main()
+{
+    int fds[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == -1)
+        return 1;
+    std::thread drain([fd = fds[1]]
+    {
+        std::vector<uint8_t> buffer(IPC_SOCKET_PACKET_BUFFER_SIZE);
+        while (read(fd, buffer.data(), buffer.size()) > 0)
+        {
+        }
+    });
+    Socket socket;
+
+    std::cout << std::setw(8) << "payload" << std::setw(8) << "path" << std::setw(10) << "MB/s"
+              << std::setw(14) << "messages/s" << std::setw(14) << "writes/msg" << std::endl;
+    for (size_t payload_length : {8, 28, 256, 1024, 16384})
+    {
+        std::vector<uint8_t> payload(payload_length, 0x5A);
+        BenchVectorMessage legacy_message(MSG_GROUP_CAR, MSG_IPC_CMD_CAR_GET_METER_INFO, payload);
+        DataMessage message(MSG_GROUP_CAR, MSG_IPC_CMD_CAR_GET_METER_INFO, payload);
+        std::vector<uint8_t> buffer(message.get_serialized_length());
+
+        auto run = [&](const char *path, auto send_one)
+        {
+            OctopusBenchSyscalls before = octopus_bench_syscalls();
+            uint64_t start = bench_now_ns();
+            for (int i = 0; i < BENCH_MESSAGES; ++i)
+            {
+                if (!send_one())
+                {
+                    std::cerr << path << " send failed" << std::endl;
+                    return;
+                }
+            }
+            double seconds = (bench_now_ns() - start) / 1e9;
+            OctopusBenchSyscalls syscalls = octopus_bench_syscalls() - before;
+            std::cout << std::setw(8) << payload_length << std::setw(8) << path << std::fixed
+                      << std::setw(10) << std::setprecision(1) << BENCH_MESSAGES * buffer.size() / seconds / (1024 * 1024)
+                      << std::setw(14) << std::setprecision(0) << BENCH_MESSAGES / seconds
+                      << std::setw(14) << std::setprecision(2) << static_cast<double>(syscalls.writes) / BENCH_MESSAGES << std::endl;
+        };
+        run("legacy", [&] { return bench_legacy_send(fds[0], legacy_message.serializeMessage()); });
+        run("into", [&]
+        {
+            size_t length = message.serializeInto(buffer.data(), buffer.size());
+            return length > 0 && socket.send_frames(fds[0], buffer.data(), length);
+        });
+        run("writev", [&] { return socket.send_message(fds[0], message); });
+    }
+    close(fds[0]);
+    drain.join();
+    close(fds[1]);
+    return 0;
+}
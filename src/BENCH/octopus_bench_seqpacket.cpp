@@ -0,0 +1,57 @@
+/**
+ * @file octopus_bench_seqpacket.cpp
+ * @brief Small message round trips on the SOCK_STREAM and the SOCK_SEQPACKET endpoint of the server.
+ *
+ * One client sends carinfo GETs with request ids, one at a time, for a fixed time on each
+ * endpoint. Reports round trip percentiles, the CPU time per message of the client thread and of
+ * the server, and the server system calls per message.
+ *
+ * Usage: octopus_bench_seqpacket [seconds]
+ *
+ * @author ak47
+ * @date 2026-10-16
+ */
+#include "octopus_bench.hpp"
+#include <iomanip>
+
+#define BENCH_DEFAULT_SECONDS 3 // Measured run per endpoint
+
+int main(int argc, char **argv)
+{
+    unsigned seconds = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : BENCH_DEFAULT_SECONDS;
+
+    BenchServer server;
+    if (!server.start())
+        return 1;
+
+    std::cout << std::setw(11) << "endpoint" << std::setw(10) << "p50 us" << std::setw(10) << "p99 us" << std::setw(14) << "messages/s"
+              << std::setw(18) << "client CPU us" << std::setw(18) << "server CPU us" << std::setw(18) << "server syscalls" << std::endl;
+    for (int type : {SOCK_STREAM, SOCK_SEQPACKET})
+    {
+        int fd = bench_connect(type);
+        if (fd < 0)
+            return 1;
+        BenchReader(fd).drain(); // Reply to the push switch
+
+        std::vector<uint64_t> samples;
+        uint64_t server_cpu = server.get_cpu_ns();
+        OctopusBenchSyscalls server_syscalls = server.get_syscalls();
+        uint64_t client_cpu = bench_thread_cpu_ns();
+        uint64_t start = bench_now_ns();
+        uint64_t replies = bench_pipelined_gets(fd, 1, start + seconds * 1000000000ull, &samples);
+        double elapsed_s = (bench_now_ns() - start) / 1e9;
+        client_cpu = bench_thread_cpu_ns() - client_cpu;
+        server_cpu = server.get_cpu_ns() - server_cpu;
+        OctopusBenchSyscalls syscalls = server.get_syscalls() - server_syscalls;
+        close(fd);
+
+        double messages = std::max<uint64_t>(1, replies);
+        std::cout << std::setw(11) << (type == SOCK_STREAM ? "stream" : "seqpacket") << std::fixed << std::setprecision(1)
+                  << std::setw(10) << bench_percentile(samples, 50) / 1000.0 << std::setw(10) << bench_percentile(samples, 99) / 1000.0
+                  << std::setw(14) << std::setprecision(0) << messages / elapsed_s << std::setprecision(2)
+                  << std::setw(18) << client_cpu / 1000.0 / messages << std::setw(18) << server_cpu / 1000.0 / messages
+                  << std::setw(18) << syscalls.total() / messages << std::endl;
+    }
+    server.stop();
+    return 0;
+}
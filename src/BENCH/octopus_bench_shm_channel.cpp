@@ -0,0 +1,200 @@
+/**
+ * @file octopus_bench_shm_channel.cpp
+ * @brief Latency and throughput of OctopusShmChannel against Socket::send_buff() between two processes.
+ *
+ * The benchmark forks: parent and child share a shared memory channel and a Unix stream
+ * socketpair. Both transports carry the same frames.
+ * - ping-pong: the child echoes every frame, the parent times the round trip. The shared memory
+ *   receiver parks and waits on its eventfd like the client library does.
+ * - stream: the parent sends frames back to back, the child counts the bytes and acknowledges.
+ * System calls are those of the parent (sender) only.
+ *
+ * Usage: octopus_bench_shm_channel [frames]
+ *
+ * @author ak47
+ * @date 2026-10-16
+ */
+#include "octopus_bench.hpp"
+#include "octopus_ipc_shm_ring.hpp"
+#include <iomanip>
+
+#define BENCH_DEFAULT_FRAMES 200000 // Frames per stream run, ping-pong uses a tenth
+#define BENCH_READ_SIZE 65536       // Receive buffer of the child
+
+// Blocking receive of exactly length bytes from the channel, parking when it runs dry
+static bool bench_shm_receive(OctopusShmChannel &channel, uint8_t *buffer, size_t length)
+{
+    size_t received = 0;
+    while (received < length)
+    {
+        ssize_t count = channel.receive(buffer + received, length - received);
+        if (count < 0)
+            return false;
+        if (count > 0)
+        {
+            received += static_cast<size_t>(count);
+            continue;
+        }
+        if (!channel.park())
+            continue;
+        pollfd wake = {channel.get_wake_fd(), POLLIN, 0};
+        poll(&wake, 1, -1);
+        channel.clear_wake();
+    }
+    return true;
+}
+
+// Sends a frame, waiting for room when the ring is full
+static bool bench_shm_send(OctopusShmChannel &channel, const std::vector<uint8_t> &frame)
+{
+    while (!channel.send(frame.data(), frame.size()))
+    {
+        pollfd wake = {channel.get_wake_fd(), POLLIN, 0};
+        if (poll(&wake, 1, 1000) <= 0)
+            return false;
+        channel.clear_wake();
+    }
+    return true;
+}
+
+static bool bench_socket_receive(int fd, uint8_t *buffer, size_t length)
+{
+    size_t received = 0;
+    while (received < length)
+    {
+        ssize_t count = read(fd, buffer + received, length - received);
+        if (count <= 0)
+            return false;
+        received += static_cast<size_t>(count);
+    }
+    return true;
+}
+
+// Child: echoes ping-pong frames, then swallows the stream of both transports
+static void bench_child(OctopusShmChannel &channel, int socket_fd, size_t frame_size, size_t ping_pongs, size_t frames)
+{
+    std::vector<uint8_t> buffer(std::max<size_t>(frame_size, BENCH_READ_SIZE));
+    std::vector<uint8_t> frame(frame_size);
+    Socket socket;
+    for (size_t i = 0; i < ping_pongs; ++i)
+    {
+        bench_shm_receive(channel, frame.data(), frame_size);
+        bench_shm_send(channel, frame);
+    }
+    for (size_t i = 0; i < ping_pongs; ++i)
+    {
+        bench_socket_receive(socket_fd, frame.data(), frame_size);
+        socket.send_buff(socket_fd, frame.data(), static_cast<int>(frame_size));
+    }
+    // Each stream is acknowledged on the other transport once it arrived whole
+    uint8_t done = 1;
+    for (size_t remaining = frames * frame_size; remaining > 0;)
+    {
+        size_t chunk = std::min(remaining, buffer.size());
+        if (!bench_shm_receive(channel, buffer.data(), chunk))
+            break;
+        remaining -= chunk;
+    }
+    socket.send_buff(socket_fd, &done, 1);
+    for (size_t remaining = frames * frame_size; remaining > 0;)
+    {
+        ssize_t count = read(socket_fd, buffer.data(), std::min(remaining, buffer.size()));
+        if (count <= 0)
+            break;
+        remaining -= static_cast<size_t>(count);
+    }
+    bench_shm_send(channel, std::vector<uint8_t>(1, done));
+}
+
+int main(int argc, char **argv)
+{
+    size_t frames = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : BENCH_DEFAULT_FRAMES;
+    size_t ping_pongs = frames / 10;
+
+    std::cout << std::setw(7) << "frame" << std::setw(8) << "path" << std::setw(12) << "rtt p50 us" << std::setw(12) << "rtt p99 us"
+              << std::setw(14) << "stream MB/s" << std::setw(14) << "frames/s" << std::setw(18) << "syscalls/frame" << std::endl;
+
+    for (size_t frame_size : {34, 1024})
+    {
+        OctopusShmChannel channel;
+        int peer_fds[SHM_CHANNEL_FD_COUNT];
+        int socket_fds[2];
+        if (!channel.create(SHM_RING_DEFAULT_CAPACITY, peer_fds) || socketpair(AF_UNIX, SOCK_STREAM, 0, socket_fds) == -1)
+            return 1;
+
+        pid_t child = fork();
+        if (child == 0)
+        {
+            channel.close();
+            close(socket_fds[0]);
+            OctopusShmChannel peer;
+            if (peer.attach(peer_fds))
+                bench_child(peer, socket_fds[1], frame_size, ping_pongs, frames);
+            _exit(0);
+        }
+        for (int fd : peer_fds)
+            close(fd);
+        close(socket_fds[1]);
+        int socket_fd = socket_fds[0];
+
+        std::vector<uint8_t> frame = bench_frame(MSG_GROUP_CAR, MSG_IPC_CMD_CAR_GET_METER_INFO,
+                                                 std::vector<uint8_t>(frame_size - FrameDecoder::FRAME_BASE_LENGTH, 0x5A));
+        std::vector<uint8_t> echo(frame_size);
+        Socket socket;
+
+        // Ping-pong, shared memory then socket
+        std::vector<uint64_t> shm_rtt, socket_rtt;
+        OctopusBenchSyscalls before = octopus_bench_syscalls();
+        for (size_t i = 0; i < ping_pongs; ++i)
+        {
+            uint64_t start = bench_now_ns();
+            bench_shm_send(channel, frame);
+            bench_shm_receive(channel, echo.data(), frame_size);
+            shm_rtt.push_back(bench_now_ns() - start);
+        }
+        OctopusBenchSyscalls shm_rtt_syscalls = octopus_bench_syscalls() - before;
+        before = octopus_bench_syscalls();
+        for (size_t i = 0; i < ping_pongs; ++i)
+        {
+            uint64_t start = bench_now_ns();
+            socket.send_buff(socket_fd, frame.data(), static_cast<int>(frame_size));
+            bench_socket_receive(socket_fd, echo.data(), frame_size);
+            socket_rtt.push_back(bench_now_ns() - start);
+        }
+        OctopusBenchSyscalls socket_rtt_syscalls = octopus_bench_syscalls() - before;
+
+        // Stream, shared memory then socket, each timed until the child acknowledged it
+        uint8_t done;
+        before = octopus_bench_syscalls();
+        uint64_t start = bench_now_ns();
+        for (size_t i = 0; i < frames; ++i)
+            bench_shm_send(channel, frame);
+        bench_socket_receive(socket_fd, &done, 1);
+        uint64_t shm_ns = bench_now_ns() - start;
+        OctopusBenchSyscalls shm_syscalls = octopus_bench_syscalls() - before;
+        before = octopus_bench_syscalls();
+        start = bench_now_ns();
+        for (size_t i = 0; i < frames; ++i)
+            socket.send_buff(socket_fd, frame.data(), static_cast<int>(frame_size));
+        bench_shm_receive(channel, &done, 1);
+        uint64_t socket_ns = bench_now_ns() - start;
+        OctopusBenchSyscalls socket_syscalls = octopus_bench_syscalls() - before;
+        waitpid(child, nullptr, 0);
+
+        auto print = [&](const char *path, const std::vector<uint64_t> &rtt, const OctopusBenchSyscalls &rtt_syscalls,
+                         uint64_t stream_ns, const OctopusBenchSyscalls &stream_syscalls)
+        {
+            std::cout << std::setw(7) << frame_size << std::setw(8) << path << std::fixed << std::setprecision(1)
+                      << std::setw(12) << bench_percentile(rtt, 50) / 1000.0 << std::setw(12) << bench_percentile(rtt, 99) / 1000.0
+                      << std::setw(14) << frames * frame_size / (stream_ns / 1e9) / (1024 * 1024)
+                      << std::setw(14) << std::setprecision(0) << frames / (stream_ns / 1e9)
+                      << std::setw(9) << std::setprecision(2) << rtt_syscalls.total() / static_cast<double>(ping_pongs)
+                      << " /" << std::setw(6) << stream_syscalls.total() / static_cast<double>(frames) << std::endl;
+        };
+        print("shm", shm_rtt, shm_rtt_syscalls, shm_ns, shm_syscalls);
+        print("socket", socket_rtt, socket_rtt_syscalls, socket_ns, socket_syscalls);
+        close(socket_fd);
+    }
+    std::cout << "syscalls/frame: ping-pong / stream" << std::endl;
+    return 0;
+}
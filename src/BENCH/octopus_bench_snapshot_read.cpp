@@ -0,0 +1,83 @@
+/**
+ * @file octopus_bench_snapshot_read.cpp
+ * @brief Cost of reading the meter state from the shared memory snapshot versus a socket GET.
+ *
+ * The server publishes the meter every 10 ms, so shared memory reads race a live writer.
+ * - shm: OctopusShmSnapshotReader::read() of SHM_SNAPSHOT_METER (what ipc_snapshot_read() does),
+ * - socket: MSG_IPC_CMD_CAR_GET_METER_INFO round trip with a request id on the stream socket.
+ *
+ * Usage: octopus_bench_snapshot_read [socket round trips]
+ *
+ * @author ak47
+ * @date 2026-10-16
+ */
+#include "octopus_bench.hpp"
+#include "octopus_ipc_shm_snapshot.hpp"
+#include "../OTSM/octopus_vehicle.h"
+#include <iomanip>
+
+#define BENCH_DEFAULT_ROUND_TRIPS 20000 // Socket GETs measured
+#define BENCH_SHM_READS 1000000         // Shared memory reads measured
+#define BENCH_PUSH_DELAY_10MS 1         // MSG_IPC_CMD_CONFIG_PUSH_DELAY unit is 10 ms
+
+static void bench_print(const char *path, double mean_ns, const std::vector<uint64_t> &samples)
+{
+    std::cout << std::setw(8) << path << std::setw(12) << std::fixed << std::setprecision(1) << mean_ns
+              << std::setw(10) << bench_percentile(samples, 50) << std::setw(10) << bench_percentile(samples, 99) << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+    size_t round_trips = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : BENCH_DEFAULT_ROUND_TRIPS;
+
+    BenchServer server;
+    if (!server.start())
+        return 1;
+    int fd = bench_connect();
+    if (fd < 0 || !bench_send_all(fd, bench_frame(MSG_GROUP_IPC_CONFIG, MSG_IPC_CMD_CONFIG_PUSH_DELAY, {0, BENCH_PUSH_DELAY_10MS})))
+        return 1;
+
+    OctopusShmSnapshotReader reader;
+    if (!reader.open())
+    {
+        std::cerr << "Cannot open the snapshot region " << SHM_SNAPSHOT_NAME << std::endl;
+        return 1;
+    }
+    usleep(100 * 1000); // The first meter snapshot is published
+
+    std::cout << std::setw(8) << "path" << std::setw(12) << "mean ns" << std::setw(10) << "p50 ns" << std::setw(10) << "p99 ns" << std::endl;
+
+    // Mean from one timed loop, percentiles from individually timed reads (include the clock cost)
+    carinfo_meter_t meter;
+    uint64_t version;
+    size_t failed = 0;
+    uint64_t start = bench_now_ns();
+    for (size_t i = 0; i < BENCH_SHM_READS; ++i)
+    {
+        if (!reader.read(SHM_SNAPSHOT_METER, &meter, sizeof(meter), &version))
+            failed++;
+        bench_keep(meter);
+    }
+    double shm_mean = static_cast<double>(bench_now_ns() - start) / BENCH_SHM_READS;
+    std::vector<uint64_t> samples;
+    samples.reserve(BENCH_SHM_READS / 10);
+    for (size_t i = 0; i < BENCH_SHM_READS / 10; ++i)
+    {
+        uint64_t read_start = bench_now_ns();
+        reader.read(SHM_SNAPSHOT_METER, &meter, sizeof(meter), &version);
+        samples.push_back(bench_now_ns() - read_start);
+    }
+    bench_print("shm", shm_mean, samples);
+
+    samples.clear();
+    start = bench_now_ns();
+    bench_pipelined_gets(fd, 1, UINT64_MAX, &samples, round_trips);
+    double socket_mean = static_cast<double>(bench_now_ns() - start) / std::max<size_t>(1, samples.size());
+    bench_print("socket", socket_mean, samples);
+
+    if (failed > 0)
+        std::cout << failed << " shm reads gave up racing the writer" << std::endl;
+    close(fd);
+    server.stop();
+    return 0;
+}
@@ -0,0 +1,197 @@
+/**
+ * @file octopus_bench_syscalls.cpp
+ * @brief Counting wrappers of the libc system call entry points used by the IPC code.
+ *
+ * Each wrapper bumps a counter and forwards to the next definition of the symbol (libc).
+ *
+ * @author ak47
+ * @date 2026-10-16
+ */
+#include "octopus_bench_syscalls.hpp"
+#include <cstdarg>
+#include <cstdlib>
+#include <dlfcn.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/mman.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+
+static OctopusBenchSyscalls bench_local_counters;
+static OctopusBenchSyscalls *bench_counters = &bench_local_counters;
+
+// Preloaded into a benchmarked process: count into the file the benchmark maps as well
+__attribute__((constructor)) static void bench_syscalls_init()
+{
+    const char *path = getenv(OCTOPUS_BENCH_SYSCALLS_ENV);
+    if (!path)
+        return;
+    int fd = open(path, O_RDWR | O_CLOEXEC);
+    if (fd < 0)
+        return;
+    void *address = mmap(nullptr, sizeof(OctopusBenchSyscalls), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (address != MAP_FAILED)
+        bench_counters = static_cast<OctopusBenchSyscalls *>(address);
+}
+
+#define BENCH_COUNT(counter) __atomic_fetch_add(&bench_counters->counter, 1, __ATOMIC_RELAXED)
+#define BENCH_COUNT_FD(fd, counter) \
+    if ((fd) > 2)                    \
+    BENCH_COUNT(counter)
+#define BENCH_NEXT(name)                                       \
+    static __typeof__(&name) next_##name = nullptr;            \
+    if (!next_##name)                                          \
+        next_##name = reinterpret_cast<__typeof__(&name)>(dlsym(RTLD_NEXT, #name))
+
+extern "C"
+{
+    OctopusBenchSyscalls octopus_bench_syscalls()
+    {
+        OctopusBenchSyscalls copy;
+        copy.reads = __atomic_load_n(&bench_counters->reads, __ATOMIC_RELAXED);
+        copy.writes = __atomic_load_n(&bench_counters->writes, __ATOMIC_RELAXED);
+        copy.waits = __atomic_load_n(&bench_counters->waits, __ATOMIC_RELAXED);
+        copy.uring_enters = __atomic_load_n(&bench_counters->uring_enters, __ATOMIC_RELAXED);
+        return copy;
+    }
+
+    ssize_t read(int fd, void *buffer, size_t length)
+    {
+        BENCH_NEXT(read);
+        BENCH_COUNT_FD(fd, reads);
+        return next_read(fd, buffer, length);
+    }
+
+    ssize_t readv(int fd, const iovec *iov, int count)
+    {
+        BENCH_NEXT(readv);
+        BENCH_COUNT_FD(fd, reads);
+        return next_readv(fd, iov, count);
+    }
+
+    ssize_t recv(int fd, void *buffer, size_t length, int flags)
+    {
+        BENCH_NEXT(recv);
+        BENCH_COUNT(reads);
+        return next_recv(fd, buffer, length, flags);
+    }
+
+    ssize_t recvfrom(int fd, void *buffer, size_t length, int flags, sockaddr *address, socklen_t *address_length)
+    {
+        BENCH_NEXT(recvfrom);
+        BENCH_COUNT(reads);
+        return next_recvfrom(fd, buffer, length, flags, address, address_length);
+    }
+
+    ssize_t recvmsg(int fd, msghdr *message, int flags)
+    {
+        BENCH_NEXT(recvmsg);
+        BENCH_COUNT(reads);
+        return next_recvmsg(fd, message, flags);
+    }
+
+    int recvmmsg(int fd, mmsghdr *messages, unsigned int count, int flags, timespec *timeout)
+    {
+        BENCH_NEXT(recvmmsg);
+        BENCH_COUNT(reads);
+        return next_recvmmsg(fd, messages, count, flags, timeout);
+    }
+
+    ssize_t write(int fd, const void *buffer, size_t length)
+    {
+        BENCH_NEXT(write);
+        BENCH_COUNT_FD(fd, writes);
+        return next_write(fd, buffer, length);
+    }
+
+    ssize_t writev(int fd, const iovec *iov, int count)
+    {
+        BENCH_NEXT(writev);
+        BENCH_COUNT_FD(fd, writes);
+        return next_writev(fd, iov, count);
+    }
+
+    ssize_t send(int fd, const void *buffer, size_t length, int flags)
+    {
+        BENCH_NEXT(send);
+        BENCH_COUNT(writes);
+        return next_send(fd, buffer, length, flags);
+    }
+
+    ssize_t sendto(int fd, const void *buffer, size_t length, int flags, const sockaddr *address, socklen_t address_length)
+    {
+        BENCH_NEXT(sendto);
+        BENCH_COUNT(writes);
+        return next_sendto(fd, buffer, length, flags, address, address_length);
+    }
+
+    ssize_t sendmsg(int fd, const msghdr *message, int flags)
+    {
+        BENCH_NEXT(sendmsg);
+        BENCH_COUNT(writes);
+        return next_sendmsg(fd, message, flags);
+    }
+
+    int sendmmsg(int fd, mmsghdr *messages, unsigned int count, int flags)
+    {
+        BENCH_NEXT(sendmmsg);
+        BENCH_COUNT(writes);
+        return next_sendmmsg(fd, messages, count, flags);
+    }
+
+    int poll(pollfd *fds, nfds_t count, int timeout)
+    {
+        BENCH_NEXT(poll);
+        BENCH_COUNT(waits);
+        return next_poll(fds, count, timeout);
+    }
+
+    int ppoll(pollfd *fds, nfds_t count, const timespec *timeout, const sigset_t *mask)
+    {
+        BENCH_NEXT(ppoll);
+        BENCH_COUNT(waits);
+        return next_ppoll(fds, count, timeout, mask);
+    }
+
+    int select(int count, fd_set *read_fds, fd_set *write_fds, fd_set *except_fds, timeval *timeout)
+    {
+        BENCH_NEXT(select);
+        BENCH_COUNT(waits);
+        return next_select(count, read_fds, write_fds, except_fds, timeout);
+    }
+
+    int epoll_wait(int epoll_fd, epoll_event *events, int max_events, int timeout)
+    {
+        BENCH_NEXT(epoll_wait);
+        BENCH_COUNT(waits);
+        return next_epoll_wait(epoll_fd, events, max_events, timeout);
+    }
+
+    int epoll_pwait(int epoll_fd, epoll_event *events, int max_events, int timeout, const sigset_t *mask)
+    {
+        BENCH_NEXT(epoll_pwait);
+        BENCH_COUNT(waits);
+        return next_epoll_pwait(epoll_fd, events, max_events, timeout, mask);
+    }
+
+    long syscall(long number, ...)
+    {
+        BENCH_NEXT(syscall);
+        va_list arguments;
+        va_start(arguments, number);
+        long a[6];
+        for (long &argument : a)
+            argument = va_arg(arguments, long);
+        va_end(arguments);
+#ifdef __NR_io_uring_enter
+        if (number == __NR_io_uring_enter)
+            BENCH_COUNT(uring_enters);
+#endif
+        return next_syscall(number, a[0], a[1], a[2], a[3], a[4], a[5]);
+    }
+}
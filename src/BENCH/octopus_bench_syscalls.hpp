@@ -0,0 +1,45 @@
+/**
+ * @file octopus_bench_syscalls.hpp
+ * @brief System call counters of the benchmark interposer library (OBENCHSC).
+ *
+ * OBENCHSC wraps the libc socket I/O, readiness wait and io_uring entry points and counts every
+ * call before forwarding it. Linked into a benchmark it counts the benchmark's own calls. Preloaded
+ * into a server (LD_PRELOAD) with OCTOPUS_BENCH_SYSCALLS naming a file, the counters live in that
+ * file so the benchmark can read them from its own process (see BenchServer).
+ *
+ * Calls on the standard streams (fd 0 to 2) are not counted, they are logging.
+ *
+ * @author ak47
+ * @date 2026-10-16
+ */
+#ifndef OCTOPUS_BENCH_SYSCALLS_HPP
+#define OCTOPUS_BENCH_SYSCALLS_HPP
+
+#include <cstdint>
+
+#define OCTOPUS_BENCH_SYSCALLS_ENV "OCTOPUS_BENCH_SYSCALLS" // File holding the counters of a preloaded process
+
+struct OctopusBenchSyscalls
+{
+    uint64_t reads;        ///< read, readv, recv, recvfrom, recvmsg, recvmmsg
+    uint64_t writes;       ///< write, writev, send, sendto, sendmsg, sendmmsg
+    uint64_t waits;        ///< poll, ppoll, select, epoll_wait, epoll_pwait
+    uint64_t uring_enters; ///< io_uring_enter through syscall()
+
+    uint64_t total() const { return reads + writes + waits + uring_enters; }
+};
+
+inline OctopusBenchSyscalls operator-(const OctopusBenchSyscalls &a, const OctopusBenchSyscalls &b)
+{
+    return {a.reads - b.reads, a.writes - b.writes, a.waits - b.waits, a.uring_enters - b.uring_enters};
+}
+
+extern "C"
+{
+    /**
+     * @brief Counters of the calling process, a consistent enough copy while other threads count.
+     */
+    OctopusBenchSyscalls octopus_bench_syscalls();
+}
+
+#endif // OCTOPUS_BENCH_SYSCALLS_HPP
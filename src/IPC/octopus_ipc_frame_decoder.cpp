@@ -0,0 +1,262 @@
+/**
+ * @file octopus_ipc_frame_decoder.cpp
+ * @brief Implementation of the incremental DataMessage frame decoder.
+ *
+ * @author ak47
+ * @date 2026-10-16
+ */
+#include "octopus_ipc_frame_decoder.hpp"
+#include <cstring>
+#include <algorithm>
+
+FrameDecoder::FrameDecoder(size_t initial_capacity)
+    : mask_(0),
+      head_(0),
+      size_(0),
+      dropped_bytes_(0),
+      container_length_(0),
+      container_offset_(0)
+{
+    reserve(std::max<size_t>(initial_capacity, 64));
+}
+
+void FrameDecoder::reserve(size_t capacity)
+{
+    if (capacity <= ring_.size())
+        return;
+
+    size_t new_capacity = ring_.empty() ? 64 : ring_.size();
+    while (new_capacity < capacity)
+        new_capacity <<= 1;
+
+    // Linearize the buffered bytes into the new storage
+    std::vector<uint8_t> new_ring(new_capacity);
+    copy_out(0, new_ring.data(), size_);
+    ring_.swap(new_ring);
+    mask_ = new_capacity - 1;
+    head_ = 0;
+}
+
+void FrameDecoder::copy_out(size_t offset, uint8_t *dst, size_t length) const
+{
+    if (length == 0)
+        return;
+
+    size_t start = (head_ + offset) & mask_;
+    size_t first = std::min(length, ring_.size() - start);
+    std::memcpy(dst, ring_.data() + start, first);
+    if (first < length)
+        std::memcpy(dst + first, ring_.data(), length - first);
+}
+
+void FrameDecoder::consume(size_t length)
+{
+    head_ = (head_ + length) & mask_;
+    size_ -= length;
+    if (size_ == 0)
+        head_ = 0; // Keep the next frame contiguous when possible
+}
+
+void FrameDecoder::feed(const uint8_t *bytes, size_t length)
+{
+    if (length == 0)
+        return;
+
+    reserve(size_ + length);
+
+    size_t tail = (head_ + size_) & mask_;
+    size_t first = std::min(length, ring_.size() - tail);
+    std::memcpy(ring_.data() + tail, bytes, first);
+    if (first < length)
+        std::memcpy(ring_.data(), bytes + first, length - first);
+    size_ += length;
+}
+
+uint8_t *FrameDecoder::prepare(size_t length)
+{
+    reserve(size_ + length);
+
+    if (head_ + size_ + length > ring_.size())
+    {
+        // Move the buffered bytes (usually the start of a frame) to the front, the space behind
+        // them is then contiguous
+        if (head_ + size_ <= ring_.size())
+            std::memmove(ring_.data(), ring_.data() + head_, size_);
+        else
+            linearize();
+        head_ = 0;
+    }
+    return ring_.data() + head_ + size_;
+}
+
+void FrameDecoder::feed(const std::vector<uint8_t> &bytes)
+{
+    feed(bytes.data(), bytes.size());
+}
+
+bool FrameDecoder::frame_ready(uint16_t &length, size_t &header_length)
+{
+    // Align the stream on a frame header, skipping junk bytes
+    uint16_t header = 0;
+    while (size_ >= 2)
+    {
+        header = (static_cast<uint16_t>(peek(0)) << 8) | peek(1);
+        if (header == DataMessage::_HEADER_ || header == DataMessage::_HEADER_EXT_ || header == DataMessage::_HEADER_CONTAINER_)
+            break;
+        consume(1);
+        dropped_bytes_++;
+    }
+
+    header_length = (header == DataMessage::_HEADER_EXT_) ? FRAME_EXTENDED_LENGTH : FRAME_BASE_LENGTH;
+    if (size_ < header_length)
+        return false;
+
+    // Wait for the rest of the frame
+    length = (static_cast<uint16_t>(peek(4)) << 8) | peek(5);
+    return size_ >= header_length + length;
+}
+
+uint32_t FrameDecoder::peek_request_id(size_t header_length) const
+{
+    if (header_length == FRAME_BASE_LENGTH)
+        return 0;
+    return (static_cast<uint32_t>(peek(6)) << 24) | (static_cast<uint32_t>(peek(7)) << 16) |
+           (static_cast<uint32_t>(peek(8)) << 8) | peek(9);
+}
+
+void FrameDecoder::linearize()
+{
+    // Called when the buffered bytes wrap: [head_, end) continues at [0, wrapped)
+    size_t first = ring_.size() - head_;
+    size_t wrapped = size_ - first;
+    if (size_ <= head_)
+    {
+        // Usual case, the gap in front of head_ holds both parts: only the buffered bytes move
+        std::memmove(ring_.data() + first, ring_.data(), wrapped);
+        std::memcpy(ring_.data(), ring_.data() + head_, first);
+    }
+    else
+    {
+        std::rotate(ring_.begin(), ring_.begin() + head_, ring_.end());
+    }
+    head_ = 0;
+}
+
+bool FrameDecoder::next(DataMessage &message)
+{
+    DataMessageView view;
+    if (!next(view))
+        return false;
+
+    message = view.to_message();
+    return true;
+}
+
+bool FrameDecoder::next(DataMessageView &view)
+{
+    for (;;)
+    {
+        if (container_length_ != 0)
+        {
+            if (next_in_container(view))
+                return true;
+            continue;
+        }
+
+        uint16_t length;
+        size_t header_length;
+        if (!frame_ready(length, header_length))
+            return false;
+
+        size_t total_length = header_length + length;
+        if (head_ + total_length > ring_.size())
+            linearize(); // Rare: only a frame straddling the end of the ring is moved
+
+        const uint8_t *frame = ring_.data() + head_;
+        uint16_t header = (static_cast<uint16_t>(frame[0]) << 8) | frame[1];
+        if (header == DataMessage::_HEADER_CONTAINER_)
+        {
+            // Unpacked in place: the container stays buffered until its last frame is returned
+            container_length_ = total_length;
+            container_offset_ = FRAME_BASE_LENGTH;
+            continue;
+        }
+
+        view.msg_header = header;
+        view.msg_group = frame[2];
+        view.msg_id = frame[3];
+        view.msg_length = length;
+        view.request_id = peek_request_id(header_length);
+        view.data = DataMessageSpan(frame + header_length, length);
+
+        consume(total_length);
+        return true;
+    }
+}
+
+bool FrameDecoder::next_in_container(DataMessageView &view)
+{
+    const uint8_t *container = ring_.data() + head_;
+    bool found = container_offset_ < container_length_ &&
+                 DataMessageView::parse(container + container_offset_, container_length_ - container_offset_, view) &&
+                 view.msg_header != DataMessage::_HEADER_CONTAINER_;
+    if (found)
+        container_offset_ += view.get_total_length();
+    else
+        dropped_bytes_ += container_length_ - container_offset_; // Malformed rest, or a nested container
+
+    // The view stays valid: consumed bytes are only overwritten by the next feed()
+    if (!found || container_offset_ == container_length_)
+    {
+        consume(container_length_);
+        container_length_ = 0;
+        container_offset_ = 0;
+    }
+    return found;
+}
+
+void FrameDecoder::clear()
+{
+    head_ = 0;
+    size_ = 0;
+    container_length_ = 0;
+    container_offset_ = 0;
+}
+
+FrameContainerBuilder::FrameContainerBuilder()
+    : count_(0)
+{
+}
+
+bool FrameContainerBuilder::append(const uint8_t *frame, size_t length)
+{
+    if (bytes_.empty())
+        bytes_.resize(FrameDecoder::FRAME_BASE_LENGTH); // Header, written by take()
+    if (bytes_.size() - FrameDecoder::FRAME_BASE_LENGTH + length > 0xFFFF)
+        return false;
+
+    bytes_.insert(bytes_.end(), frame, frame + length);
+    count_++;
+    return true;
+}
+
+std::vector<uint8_t> FrameContainerBuilder::take()
+{
+    std::vector<uint8_t> bytes;
+    if (count_ == 1)
+    {
+        bytes.assign(bytes_.begin() + FrameDecoder::FRAME_BASE_LENGTH, bytes_.end());
+    }
+    else if (count_ > 1)
+    {
+        size_t length = bytes_.size() - FrameDecoder::FRAME_BASE_LENGTH;
+        const uint8_t header[FrameDecoder::FRAME_BASE_LENGTH] = {
+            static_cast<uint8_t>(DataMessage::_HEADER_CONTAINER_ >> 8), static_cast<uint8_t>(DataMessage::_HEADER_CONTAINER_ & 0xFF),
+            0, 0, static_cast<uint8_t>(length >> 8), static_cast<uint8_t>(length & 0xFF)};
+        std::memcpy(bytes_.data(), header, sizeof(header));
+        bytes.swap(bytes_);
+    }
+    bytes_.clear();
+    count_ = 0;
+    return bytes;
+}
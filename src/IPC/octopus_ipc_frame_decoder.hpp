@@ -0,0 +1,197 @@
+/**
+ * @file octopus_ipc_frame_decoder.hpp
+ * @brief Incremental, stream safe decoder for DataMessage frames.
+ *
+ * Bytes read from a stream socket are appended to a ring buffer in whatever chunks the
+ * kernel delivers them. The decoder yields zero or more complete frames per feed: a frame
+ * split across several reads is kept until it is complete, and several pipelined frames in
+ * one read are all returned. Garbage in front of a frame header is skipped byte by byte
+ * until the stream is aligned on a header again.
+ *
+ * Frames can be extracted as owning DataMessages or, without copying or allocating anything, as
+ * DataMessageViews pointing into the ring.
+ *
+ * Frame layout: [Header:2][Group:1][Msg:1][Length:2][Data:Length], Length is 16 bit.
+ * Extended frames (header 0xA5A6) carry a [RequestId:4] between Length and Data.
+ * Container frames (header 0xA5A7) carry whole frames as their data. They are unpacked
+ * transparently: the frames inside are returned one by one, the container itself never is.
+ *
+ * @author ak47
+ * @date 2026-10-16
+ */
+#ifndef OCTOPUS_IPC_FRAME_DECODER_HPP
+#define OCTOPUS_IPC_FRAME_DECODER_HPP
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "octopus_ipc_ptl.hpp"
+
+/**
+ * @class FrameDecoder
+ * @brief Reassembles DataMessage frames from a byte stream using a growable ring buffer.
+ */
+class FrameDecoder
+{
+public:
+    static constexpr size_t FRAME_BASE_LENGTH = 6;                             ///< Header + group + msg + length
+    static constexpr size_t FRAME_EXTENDED_LENGTH = 10;                        ///< FRAME_BASE_LENGTH + request id
+    static constexpr size_t FRAME_MAX_LENGTH = FRAME_EXTENDED_LENGTH + 0xFFFF; ///< Largest possible frame
+
+    /**
+     * @brief Construct a decoder.
+     * @param initial_capacity Initial ring capacity in bytes (rounded up to a power of two).
+     */
+    explicit FrameDecoder(size_t initial_capacity = 1024);
+
+    /**
+     * @brief Appends received bytes to the ring. The ring grows as needed.
+     */
+    void feed(const uint8_t *bytes, size_t length);
+
+    /**
+     * @brief Appends received bytes to the ring. The ring grows as needed.
+     */
+    void feed(const std::vector<uint8_t> &bytes);
+
+    /**
+     * @brief Makes room for length bytes behind the buffered ones, so a read can go straight
+     *        into the ring. The bytes become part of the stream with commit().
+     * @return Contiguous space of at least length bytes, valid until the next call.
+     */
+    uint8_t *prepare(size_t length);
+
+    /**
+     * @brief Appends length bytes written into the space returned by prepare().
+     */
+    void commit(size_t length) { size_ += length; }
+
+    /**
+     * @brief Bytes prepare() can provide without growing the ring.
+     */
+    size_t free_space() const { return ring_.size() - size_; }
+
+    /**
+     * @brief Extracts the next complete frame, if any.
+     * @param message Receives the decoded frame.
+     * @return true if a complete frame was decoded, false if more data is needed.
+     */
+    bool next(DataMessage &message);
+
+    /**
+     * @brief Extracts the next complete frame in place, if any.
+     *
+     * The view points into the ring: it is valid until the next call to feed(), next() or clear().
+     * A frame wrapping around the end of the ring is moved to the front first. A container stays
+     * buffered until its last frame was returned.
+     *
+     * @param view Receives the frame.
+     * @return true if a complete frame was decoded, false if more data is needed.
+     */
+    bool next(DataMessageView &view);
+
+    /**
+     * @brief Drops all buffered bytes (e.g. after a reconnect).
+     */
+    void clear();
+
+    /**
+     * @brief Number of bytes currently buffered.
+     */
+    size_t size() const { return size_; }
+
+    /**
+     * @brief Number of bytes skipped so far while searching for a frame header.
+     */
+    size_t get_dropped_bytes() const { return dropped_bytes_; }
+
+private:
+    uint8_t peek(size_t offset) const { return ring_[(head_ + offset) & mask_]; }
+    void copy_out(size_t offset, uint8_t *dst, size_t length) const;
+    void consume(size_t length);
+    bool frame_ready(uint16_t &length, size_t &header_length);
+    uint32_t peek_request_id(size_t header_length) const;
+    bool next_in_container(DataMessageView &view);
+    void linearize();
+    void reserve(size_t capacity);
+
+    std::vector<uint8_t> ring_; ///< Ring storage, size is always a power of two
+    size_t mask_;               ///< ring_.size() - 1
+    size_t head_;               ///< Index of the first buffered byte
+    size_t size_;               ///< Number of buffered bytes
+    size_t dropped_bytes_;      ///< Bytes discarded during header resynchronization
+    size_t container_length_;   ///< Length of the container at the head being unpacked, 0 for none
+    size_t container_offset_;   ///< Offset of its next frame
+};
+
+/**
+ * @class FrameContainerBuilder
+ * @brief Packs serialized frames into one container frame.
+ *
+ * Container layout: [0xA5A7][Group:0][Msg:0][Length:2][Frame][Frame]..., each frame complete with
+ * its own (plain or extended) header. Containers are not nested. A burst of small frames then
+ * costs one write and one read, one packet on SOCK_SEQPACKET, one record in a shared memory ring.
+ */
+class FrameContainerBuilder
+{
+public:
+    FrameContainerBuilder();
+
+    /**
+     * @brief Appends a serialized frame.
+     * @return false if the frame does not fit into the container any more, nothing is appended.
+     */
+    bool append(const uint8_t *frame, size_t length);
+
+    /**
+     * @brief Moves the packed frames out and leaves the builder empty.
+     * @return A single frame as is, several wrapped into a container, nothing if empty.
+     */
+    std::vector<uint8_t> take();
+
+    size_t get_count() const { return count_; }
+    bool empty() const { return count_ == 0; }
+
+private:
+    std::vector<uint8_t> bytes_; ///< Container header followed by the frames
+    size_t count_;               ///< Frames appended
+};
+
+/**
+ * @brief Hands every frame of a SOCK_SEQPACKET packet to handler as a DataMessageView.
+ *
+ * A packet only holds whole frames, they are parsed in place: no decoder, no reassembly.
+ * Containers are unpacked in place as well, a malformed rest of a container is skipped.
+ *
+ * @param handler Called with each frame, the view points into the packet.
+ * @return Bytes at the end of the packet not forming a whole frame, 0 for a valid packet.
+ */
+template <typename Handler>
+size_t frame_packet_for_each(const uint8_t *packet, size_t length, Handler &&handler)
+{
+    size_t offset = 0;
+    DataMessageView view;
+    while (offset < length && DataMessageView::parse(packet + offset, length - offset, view))
+    {
+        offset += view.get_total_length();
+        if (view.msg_header != DataMessage::_HEADER_CONTAINER_)
+        {
+            handler(view);
+            continue;
+        }
+
+        const uint8_t *frames = view.data.data();
+        size_t frames_length = view.data.size();
+        size_t frame_offset = 0;
+        DataMessageView frame;
+        while (frame_offset < frames_length && DataMessageView::parse(frames + frame_offset, frames_length - frame_offset, frame) &&
+               frame.msg_header != DataMessage::_HEADER_CONTAINER_)
+        {
+            handler(frame);
+            frame_offset += frame.get_total_length();
+        }
+    }
+    return length - offset;
+}
+
+#endif // OCTOPUS_IPC_FRAME_DECODER_HPP
@@ -0,0 +1,171 @@
+/**
+ * @file octopus_ipc_large_payload.cpp
+ * @brief Implementation of the sealed memfd large payloads.
+ *
+ * @author ak47
+ * @date 2026-10-16
+ */
+#include "octopus_ipc_large_payload.hpp"
+#include <iostream>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// Seals a receiver insists on: the sender can neither rewrite nor truncate the mapped bytes (SIGBUS)
+#define LARGE_PAYLOAD_REQUIRED_SEALS (F_SEAL_SHRINK | F_SEAL_WRITE)
+
+OctopusLargePayloadWriter::OctopusLargePayloadWriter()
+    : fd_(-1), data_(nullptr), size_(0)
+{
+}
+
+OctopusLargePayloadWriter::~OctopusLargePayloadWriter()
+{
+    discard();
+}
+
+bool OctopusLargePayloadWriter::create(size_t size)
+{
+    discard();
+    if (size == 0 || size > LARGE_PAYLOAD_MAX_SIZE)
+        return false;
+
+    fd_ = memfd_create("octopus_ipc_payload", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (fd_ == -1)
+    {
+        std::cerr << "[LargePayload] memfd_create failed: " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    if (ftruncate(fd_, size) == -1)
+    {
+        std::cerr << "[LargePayload] ftruncate failed: " << strerror(errno) << std::endl;
+        discard();
+        return false;
+    }
+
+    void *address = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (address == MAP_FAILED)
+    {
+        std::cerr << "[LargePayload] mmap failed: " << strerror(errno) << std::endl;
+        discard();
+        return false;
+    }
+
+    data_ = static_cast<uint8_t *>(address);
+    size_ = size;
+    return true;
+}
+
+int OctopusLargePayloadWriter::seal()
+{
+    if (!data_)
+        return -1;
+
+    // F_SEAL_WRITE is refused while a writable shared mapping exists
+    munmap(data_, size_);
+    data_ = nullptr;
+    size_ = 0;
+
+    if (fcntl(fd_, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL) == -1)
+    {
+        std::cerr << "[LargePayload] sealing failed: " << strerror(errno) << std::endl;
+        discard();
+        return -1;
+    }
+
+    int fd = fd_;
+    fd_ = -1;
+    return fd;
+}
+
+void OctopusLargePayloadWriter::discard()
+{
+    if (data_)
+        munmap(data_, size_);
+    if (fd_ >= 0)
+        close(fd_);
+    fd_ = -1;
+    data_ = nullptr;
+    size_ = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+OctopusLargePayload::OctopusLargePayload()
+    : data_(nullptr), size_(0)
+{
+}
+
+OctopusLargePayload::~OctopusLargePayload()
+{
+    unmap();
+}
+
+bool OctopusLargePayload::map(int memfd, size_t size)
+{
+    unmap();
+
+    struct stat st;
+    int seals = fcntl(memfd, F_GET_SEALS);
+    bool valid = size > 0 && size <= LARGE_PAYLOAD_MAX_SIZE && seals != -1 &&
+                 (seals & LARGE_PAYLOAD_REQUIRED_SEALS) == LARGE_PAYLOAD_REQUIRED_SEALS &&
+                 fstat(memfd, &st) == 0 && static_cast<size_t>(st.st_size) == size;
+
+    void *address = valid ? mmap(nullptr, size, PROT_READ, MAP_SHARED, memfd, 0) : MAP_FAILED;
+    close(memfd);
+    if (address == MAP_FAILED)
+        return false;
+
+    data_ = static_cast<const uint8_t *>(address);
+    size_ = size;
+    return true;
+}
+
+void OctopusLargePayload::unmap()
+{
+    if (!data_)
+        return;
+    munmap(const_cast<uint8_t *>(data_), size_);
+    data_ = nullptr;
+    size_ = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+int large_payload_create(const void *data, size_t size)
+{
+    OctopusLargePayloadWriter writer;
+    if (!writer.create(size))
+        return -1;
+
+    memcpy(writer.data(), data, size);
+    return writer.seal();
+}
+
+DataMessage large_payload_make_descriptor(uint8_t msg_group, uint8_t msg_id, size_t size)
+{
+    DataMessage descriptor;
+    descriptor.msg_group = MSG_GROUP_IPC_CONFIG;
+    descriptor.msg_id = MSG_IPC_CMD_CONFIG_LARGE_PAYLOAD;
+    descriptor.data = {msg_group, msg_id,
+                       static_cast<uint8_t>(size >> 24), static_cast<uint8_t>(size >> 16),
+                       static_cast<uint8_t>(size >> 8), static_cast<uint8_t>(size)};
+    descriptor.msg_length = descriptor.data.size();
+    return descriptor;
+}
+
+bool large_payload_parse_descriptor(const DataMessageView &descriptor, uint8_t *msg_group, uint8_t *msg_id, size_t *size)
+{
+    if (descriptor.msg_group != MSG_GROUP_IPC_CONFIG || descriptor.msg_id != MSG_IPC_CMD_CONFIG_LARGE_PAYLOAD ||
+        descriptor.data.size() < LARGE_PAYLOAD_DESCRIPTOR_LENGTH)
+        return false;
+
+    const DataMessageSpan &data = descriptor.data;
+    *msg_group = data[0];
+    *msg_id = data[1];
+    *size = (static_cast<size_t>(data[2]) << 24) | (static_cast<size_t>(data[3]) << 16) |
+            (static_cast<size_t>(data[4]) << 8) | static_cast<size_t>(data[5]);
+    return true;
+}
@@ -0,0 +1,118 @@
+/**
+ * @file octopus_ipc_large_payload.hpp
+ * @brief Large payloads passed as sealed memfds next to a small descriptor frame.
+ *
+ * A DataMessage carries at most 64 KiB and is read from the socket in small chunks, which makes
+ * bulk data (MCU flash images, error logs, trace dumps) slow. A large payload is written once
+ * into a memfd instead, which is then sealed against writes and resizing and passed over the
+ * socket (SCM_RIGHTS) together with a MSG_IPC_CMD_CONFIG_LARGE_PAYLOAD descriptor frame naming
+ * the (group, msg) the payload belongs to and its size.
+ *
+ * The receiver checks the seals and the size and maps the payload read-only: its bytes never go
+ * through the socket, and the sender can neither change nor shrink them under the mapping.
+ *
+ * Frames and memfds are matched in order: every descriptor frame consumes the next file
+ * descriptor received on the same connection.
+ *
+ * @author ak47
+ * @date 2026-10-16
+ */
+#ifndef OCTOPUS_IPC_LARGE_PAYLOAD_HPP
+#define OCTOPUS_IPC_LARGE_PAYLOAD_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include "octopus_ipc_ptl.hpp"
+
+#define LARGE_PAYLOAD_MAX_SIZE (256u * 1024 * 1024) // Largest payload accepted by a receiver
+#define LARGE_PAYLOAD_DESCRIPTOR_LENGTH 6           // (group, msg_id, size 32 bit BE)
+
+/**
+ * @class OctopusLargePayloadWriter
+ * @brief Builds a sealed memfd. The producer may write straight into the mapping, no extra copy.
+ */
+class OctopusLargePayloadWriter
+{
+public:
+    OctopusLargePayloadWriter();
+    ~OctopusLargePayloadWriter();
+
+    OctopusLargePayloadWriter(const OctopusLargePayloadWriter &) = delete;
+    OctopusLargePayloadWriter &operator=(const OctopusLargePayloadWriter &) = delete;
+
+    /**
+     * @brief Creates a memfd of size bytes and maps it writable.
+     */
+    bool create(size_t size);
+
+    uint8_t *data() { return data_; }
+    size_t size() const { return size_; }
+
+    /**
+     * @brief Unmaps the payload and seals it against writes, shrinking and growing.
+     * @return The memfd, -1 on failure. The caller owns it.
+     */
+    int seal();
+
+    /**
+     * @brief Drops the payload without sealing it.
+     */
+    void discard();
+
+private:
+    int fd_;
+    uint8_t *data_;
+    size_t size_;
+};
+
+/**
+ * @class OctopusLargePayload
+ * @brief Read-only mapping of a received payload, unmapped on destruction.
+ */
+class OctopusLargePayload
+{
+public:
+    OctopusLargePayload();
+    ~OctopusLargePayload();
+
+    OctopusLargePayload(const OctopusLargePayload &) = delete;
+    OctopusLargePayload &operator=(const OctopusLargePayload &) = delete;
+
+    /**
+     * @brief Maps a payload created by OctopusLargePayloadWriter.
+     *
+     * Fails if the memfd is not sealed against writes and shrinking, or its size differs from
+     * the size announced by the descriptor.
+     *
+     * @param memfd The received descriptor, always closed (the mapping keeps the payload alive).
+     * @param size  Size announced by the descriptor frame.
+     */
+    bool map(int memfd, size_t size);
+    void unmap();
+
+    const uint8_t *data() const { return data_; }
+    size_t size() const { return size_; }
+
+private:
+    const uint8_t *data_;
+    size_t size_;
+};
+
+/**
+ * @brief Copies data into a new sealed memfd.
+ * @return The memfd, -1 on failure. The caller owns it.
+ */
+int large_payload_create(const void *data, size_t size);
+
+/**
+ * @brief Builds the descriptor frame sent together with the memfd.
+ */
+DataMessage large_payload_make_descriptor(uint8_t msg_group, uint8_t msg_id, size_t size);
+
+/**
+ * @brief Reads a descriptor frame built by large_payload_make_descriptor().
+ * @return false if the frame is not a valid descriptor.
+ */
+bool large_payload_parse_descriptor(const DataMessageView &descriptor, uint8_t *msg_group, uint8_t *msg_id, size_t *size);
+
+#endif // OCTOPUS_IPC_LARGE_PAYLOAD_HPP
@@ -0,0 +1,129 @@
+/**
+ * @file octopus_ipc_lockfree_queue.hpp
+ * @brief Bounded lock-free queue for handing records from foreign threads to the IPC server.
+ *
+ * The queue is a fixed array of cells, each carrying its own sequence number (D. Vyukov's bounded
+ * MPMC queue). Producers and consumers claim cells with a single compare-and-swap and never take
+ * a lock or allocate, so a producer running on a real-time thread (e.g. the OTSM state machine)
+ * never waits for the IPC side. When the queue is full, try_push() fails instead of blocking.
+ *
+ * @author ak47
+ * @date 2026-10-16
+ */
+#ifndef OCTOPUS_IPC_LOCKFREE_QUEUE_HPP
+#define OCTOPUS_IPC_LOCKFREE_QUEUE_HPP
+
+#include <atomic>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @class OctopusLockFreeQueue
+ * @brief Bounded, wait-free-on-full multi producer / multi consumer queue of trivially copyable records.
+ */
+template <typename T>
+class OctopusLockFreeQueue
+{
+public:
+    /**
+     * @brief Construct the queue.
+     * @param capacity Number of cells, rounded up to a power of two.
+     */
+    explicit OctopusLockFreeQueue(size_t capacity)
+        : enqueue_pos_(0), dequeue_pos_(0)
+    {
+        size_t size = 2;
+        while (size < capacity)
+            size <<= 1;
+
+        cells_.reset(new Cell[size]);
+        mask_ = size - 1;
+        for (size_t i = 0; i < size; ++i)
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    OctopusLockFreeQueue(const OctopusLockFreeQueue &) = delete;
+    OctopusLockFreeQueue &operator=(const OctopusLockFreeQueue &) = delete;
+
+    /**
+     * @brief Appends a record.
+     * @return false if the queue is full, the record is not queued.
+     */
+    bool try_push(const T &value)
+    {
+        size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            Cell &cell = cells_[pos & mask_];
+            size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+            if (diff == 0)
+            {
+                if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    cell.value = value;
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (diff < 0)
+            {
+                return false; // Full
+            }
+            else
+            {
+                pos = enqueue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /**
+     * @brief Removes the oldest record.
+     * @return false if the queue is empty.
+     */
+    bool try_pop(T &value)
+    {
+        size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            Cell &cell = cells_[pos & mask_];
+            size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos + 1);
+            if (diff == 0)
+            {
+                if (dequeue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    value = cell.value;
+                    cell.sequence.store(pos + mask_ + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (diff < 0)
+            {
+                return false; // Empty
+            }
+            else
+            {
+                pos = dequeue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    size_t capacity() const { return mask_ + 1; }
+
+private:
+    struct Cell
+    {
+        std::atomic<size_t> sequence{0}; ///< Tells producers and consumers whose turn the cell is
+        T value;                         ///< The record
+    };
+
+    // Producers and consumers update different counters, keep them on different cache lines
+    std::unique_ptr<Cell[]> cells_;
+    size_t mask_;
+    alignas(64) std::atomic<size_t> enqueue_pos_;
+    alignas(64) std::atomic<size_t> dequeue_pos_;
+};
+
+#endif // OCTOPUS_IPC_LOCKFREE_QUEUE_HPP
@@ -0,0 +1,390 @@
+/**
+ * @file octopus_ipc_outbound_queue.cpp
+ * @brief Implementation of the bounded per-connection outbound frame queue.
+ *
+ * @author ak47
+ * @date 2026-10-16
+ */
+#include "octopus_ipc_outbound_queue.hpp"
+#include "octopus_ipc_shm_ring.hpp"
+#include "octopus_ipc_frame_decoder.hpp"
+#include <cerrno>
+#include <sys/uio.h>
+#include <sys/socket.h>
+
+#define OUTBOUND_MAX_IOV 64 // Maximum number of frames gathered into one writev()
+
+OutboundQueue::OutboundQueue(size_t max_bytes, SlowConsumerPolicy policy)
+    : head_offset_(0),
+      queued_bytes_(0),
+      max_bytes_(max_bytes),
+      policy_(policy),
+      containers_(false)
+{
+}
+
+size_t OutboundQueue::entry_size(const Entry &entry) const
+{
+    if (entry.bytes)
+        return entry.bytes->size();
+
+    auto it = mailboxes_.find(entry.mailbox_key);
+    return (it != mailboxes_.end()) ? it->second->size() : 0;
+}
+
+void OutboundQueue::drop_entry(size_t index)
+{
+    Entry &entry = frames_[index];
+    queued_bytes_ -= entry_size(entry);
+    if (!entry.bytes)
+        mailboxes_.erase(entry.mailbox_key);
+    frames_.erase(frames_.begin() + index);
+}
+
+const OutboundFrame &OutboundQueue::entry_bytes(const Entry &entry)
+{
+    // Mailbox entries are written from the mailbox, it stays untouched until written
+    return entry.bytes ? entry.bytes : mailboxes_[entry.mailbox_key];
+}
+
+size_t OutboundQueue::pack_front(std::vector<uint8_t> &container)
+{
+    // A partially written front frame must be completed as is
+    if (!containers_ || head_offset_ > 0 || frames_.size() < 2)
+        return 0;
+
+    FrameContainerBuilder builder;
+    size_t count = 0;
+    for (const Entry &entry : frames_)
+    {
+        const OutboundFrame &bytes = entry_bytes(entry);
+        bool is_container = bytes->size() >= 2 && ((bytes->at(0) << 8) | bytes->at(1)) == DataMessage::_HEADER_CONTAINER_;
+        if (is_container || !builder.append(bytes->data(), bytes->size()))
+            break; // Containers are not nested, an oversized frame goes out alone
+        count++;
+    }
+    if (count < 2)
+        return 0;
+
+    container = builder.take();
+    return count;
+}
+
+void OutboundQueue::replace_packed(size_t count, std::vector<uint8_t> container)
+{
+    // Packed frames are written: mailboxes are free for newer values, the keys are not needed any more
+    for (size_t i = 0; i < count; ++i)
+    {
+        Entry &front = frames_.front();
+        queued_bytes_ -= entry_size(front);
+        if (!front.bytes)
+            mailboxes_.erase(front.mailbox_key);
+        frames_.pop_front();
+    }
+    queued_bytes_ += container.size();
+    frames_.push_front({make_outbound_frame(std::move(container)), -1, -1});
+}
+
+OutboundPushResult OutboundQueue::push(OutboundFrame frame, int conflate_key, size_t *dropped_frames)
+{
+    if (dropped_frames)
+        *dropped_frames = 0;
+    if (!frame)
+        return OutboundPushResult::DroppedNewest;
+
+    size_t frame_size = frame->size();
+    return append({std::move(frame), conflate_key, -1}, frame_size, dropped_frames);
+}
+
+OutboundPushResult OutboundQueue::push_latest(OutboundFrame frame, int mailbox_key, size_t *dropped_frames)
+{
+    if (dropped_frames)
+        *dropped_frames = 0;
+    if (!frame)
+        return OutboundPushResult::DroppedNewest;
+
+    // An unsent value is pending: replace it, it keeps its place in the queue
+    auto it = mailboxes_.find(mailbox_key);
+    if (it != mailboxes_.end())
+    {
+        queued_bytes_ = queued_bytes_ - it->second->size() + frame->size();
+        it->second = std::move(frame);
+        return OutboundPushResult::Conflated;
+    }
+
+    size_t frame_size = frame->size();
+    mailboxes_[mailbox_key] = std::move(frame);
+    OutboundPushResult result = append({nullptr, -1, mailbox_key}, frame_size, dropped_frames);
+    if (result == OutboundPushResult::DroppedNewest || result == OutboundPushResult::Overflow)
+        mailboxes_.erase(mailbox_key);
+    return result;
+}
+
+OutboundPushResult OutboundQueue::append(Entry entry, size_t frame_size, size_t *dropped_frames)
+{
+    if (queued_bytes_ + frame_size <= max_bytes_)
+    {
+        frames_.push_back(std::move(entry));
+        queued_bytes_ += frame_size;
+        return OutboundPushResult::Queued;
+    }
+
+    // A partially written front frame must be completed, otherwise the stream gets corrupted
+    size_t first_droppable = (head_offset_ > 0) ? 1 : 0;
+
+    switch (policy_)
+    {
+    case SlowConsumerPolicy::DropOldest:
+    {
+        size_t dropped = 0;
+        while (queued_bytes_ + frame_size > max_bytes_ && frames_.size() > first_droppable)
+        {
+            drop_entry(first_droppable);
+            dropped++;
+        }
+        if (dropped_frames)
+            *dropped_frames = dropped;
+
+        if (queued_bytes_ + frame_size > max_bytes_)
+            return OutboundPushResult::DroppedNewest; // Larger than the whole queue
+
+        frames_.push_back(std::move(entry));
+        queued_bytes_ += frame_size;
+        return dropped > 0 ? OutboundPushResult::DroppedOldest : OutboundPushResult::Queued;
+    }
+
+    case SlowConsumerPolicy::Conflate:
+        if (entry.conflate_key >= 0)
+        {
+            // Replace the newest queued frame carrying the same key with the fresh value
+            for (size_t i = frames_.size(); i > first_droppable; --i)
+            {
+                Entry &queued = frames_[i - 1];
+                if (queued.conflate_key == entry.conflate_key)
+                {
+                    queued_bytes_ = queued_bytes_ - queued.bytes->size() + frame_size;
+                    queued.bytes = std::move(entry.bytes);
+                    return OutboundPushResult::Conflated;
+                }
+            }
+        }
+        return OutboundPushResult::DroppedNewest;
+
+    case SlowConsumerPolicy::DropConnection:
+    default:
+        return OutboundPushResult::Overflow;
+    }
+}
+
+OutboundFlushResult OutboundQueue::flush(int socket_fd)
+{
+    while (!frames_.empty())
+    {
+        iovec iov[OUTBOUND_MAX_IOV];
+        int iov_count = 0;
+        auto it = frames_.begin();
+
+        // The front frames are packed for this write only, the queue keeps them until it succeeds
+        std::vector<uint8_t> container;
+        size_t packed = pack_front(container);
+        if (packed > 0)
+        {
+            iov[iov_count].iov_base = container.data();
+            iov[iov_count++].iov_len = container.size();
+            it += packed;
+        }
+        for (; it != frames_.end() && iov_count < OUTBOUND_MAX_IOV; ++it, ++iov_count)
+        {
+            const OutboundFrame &bytes = entry_bytes(*it);
+            size_t offset = (iov_count == 0) ? head_offset_ : 0;
+            iov[iov_count].iov_base = const_cast<uint8_t *>(bytes->data()) + offset;
+            iov[iov_count].iov_len = bytes->size() - offset;
+        }
+
+        ssize_t written = writev(socket_fd, iov, iov_count);
+        if (written < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+                return OutboundFlushResult::Pending;
+            return OutboundFlushResult::Error;
+        }
+        if (written > 0 && packed > 0)
+            replace_packed(packed, std::move(container));
+
+        // Pop every fully written frame, remember how far the next one got
+        size_t remaining = static_cast<size_t>(written);
+        queued_bytes_ -= remaining;
+        while (remaining > 0)
+        {
+            // Once written to, a mailbox value is pinned, a newer value goes into a new entry
+            Entry &front = frames_.front();
+            if (!front.bytes)
+            {
+                auto mailbox = mailboxes_.find(front.mailbox_key);
+                front.bytes = std::move(mailbox->second);
+                mailboxes_.erase(mailbox);
+            }
+
+            size_t left_in_front = front.bytes->size() - head_offset_;
+            if (remaining < left_in_front)
+            {
+                head_offset_ += remaining;
+                break;
+            }
+            remaining -= left_in_front;
+            frames_.pop_front();
+            head_offset_ = 0;
+        }
+    }
+
+    return OutboundFlushResult::Drained;
+}
+
+OutboundFlushResult OutboundQueue::flush_packets(int socket_fd)
+{
+    while (!frames_.empty())
+    {
+        iovec iov[OUTBOUND_MAX_IOV];
+        mmsghdr packets[OUTBOUND_MAX_IOV];
+        int packet_count = 0;
+        auto it = frames_.begin();
+
+        // The front frames go out as one packet, the queue keeps them until it is sent
+        std::vector<uint8_t> container;
+        size_t packed = pack_front(container);
+        if (packed > 0)
+        {
+            iov[packet_count].iov_base = container.data();
+            iov[packet_count++].iov_len = container.size();
+            it += packed;
+        }
+        for (; it != frames_.end() && packet_count < OUTBOUND_MAX_IOV; ++it, ++packet_count)
+        {
+            const OutboundFrame &bytes = entry_bytes(*it);
+            iov[packet_count].iov_base = const_cast<uint8_t *>(bytes->data());
+            iov[packet_count].iov_len = bytes->size();
+        }
+        for (int i = 0; i < packet_count; ++i)
+        {
+            packets[i] = mmsghdr{};
+            packets[i].msg_hdr.msg_iov = &iov[i];
+            packets[i].msg_hdr.msg_iovlen = 1;
+        }
+
+        int sent = sendmmsg(socket_fd, packets, packet_count, MSG_NOSIGNAL);
+        if (sent < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+                return OutboundFlushResult::Pending;
+            return OutboundFlushResult::Error;
+        }
+        if (sent > 0 && packed > 0)
+            replace_packed(packed, std::move(container));
+
+        // Every packet sent is a whole frame
+        for (int i = 0; i < sent; ++i)
+        {
+            Entry &front = frames_.front();
+            queued_bytes_ -= iov[i].iov_len;
+            if (!front.bytes)
+                mailboxes_.erase(front.mailbox_key);
+            frames_.pop_front();
+        }
+        if (sent < packet_count)
+            return OutboundFlushResult::Pending;
+    }
+
+    return OutboundFlushResult::Drained;
+}
+
+OutboundFlushResult OutboundQueue::flush(OctopusShmChannel &channel)
+{
+    while (!frames_.empty())
+    {
+        // The front frames go out as one ring record, the queue keeps them until it is written
+        std::vector<uint8_t> container;
+        size_t packed = pack_front(container);
+        if (packed > 0)
+        {
+            if (!channel.send(container.data(), container.size()))
+                return channel.is_open() ? OutboundFlushResult::Pending : OutboundFlushResult::Error;
+            replace_packed(packed, std::move(container));
+            queued_bytes_ -= frames_.front().bytes->size();
+            frames_.pop_front();
+            continue;
+        }
+
+        Entry &front = frames_.front();
+        const OutboundFrame &bytes = entry_bytes(front);
+        if (!channel.send(bytes->data() + head_offset_, bytes->size() - head_offset_))
+            return channel.is_open() ? OutboundFlushResult::Pending : OutboundFlushResult::Error;
+
+        queued_bytes_ -= bytes->size() - head_offset_;
+        if (!front.bytes)
+            mailboxes_.erase(front.mailbox_key);
+        frames_.pop_front();
+        head_offset_ = 0;
+    }
+
+    return OutboundFlushResult::Drained;
+}
+
+void OutboundQueue::take(std::vector<OutboundFrame> &frames, size_t max_frames, size_t &offset)
+{
+    // Taken frames count as written, the front ones may go out as one container
+    std::vector<uint8_t> container;
+    size_t packed = pack_front(container);
+    if (packed > 0)
+        replace_packed(packed, std::move(container));
+
+    offset = head_offset_;
+    while (!frames_.empty() && frames.size() < max_frames)
+    {
+        Entry &front = frames_.front();
+        if (!front.bytes)
+        {
+            auto mailbox = mailboxes_.find(front.mailbox_key);
+            front.bytes = std::move(mailbox->second);
+            mailboxes_.erase(mailbox);
+        }
+        queued_bytes_ -= front.bytes->size() - head_offset_;
+        frames.push_back(std::move(front.bytes));
+        frames_.pop_front();
+        head_offset_ = 0;
+    }
+}
+
+void OutboundQueue::restore(const std::vector<OutboundFrame> &frames, size_t offset, size_t written)
+{
+    // Skip the written frames, the first unwritten one may be partially written
+    size_t index = 0;
+    written += offset;
+    while (index < frames.size() && written >= frames[index]->size())
+    {
+        written -= frames[index]->size();
+        index++;
+    }
+    if (index == frames.size())
+        return;
+
+    // Frames pushed meanwhile are behind them, so a partially written frame is the front again
+    for (size_t i = frames.size(); i > index; --i)
+    {
+        frames_.push_front({frames[i - 1], -1, -1});
+        queued_bytes_ += frames[i - 1]->size();
+    }
+    queued_bytes_ -= written;
+    head_offset_ = written;
+}
+
+void OutboundQueue::clear()
+{
+    frames_.clear();
+    mailboxes_.clear();
+    head_offset_ = 0;
+    queued_bytes_ = 0;
+}
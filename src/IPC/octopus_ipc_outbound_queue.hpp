@@ -0,0 +1,196 @@
+/**
+ * @file octopus_ipc_outbound_queue.hpp
+ * @brief Bounded per-connection queue of outgoing frames, flushed with non-blocking writes.
+ *
+ * Senders append serialized frames and never wait for the peer. The owner flushes the queue
+ * whenever the socket is writable (e.g. on EPOLLOUT). When a slow consumer lets the queue
+ * reach its byte limit, the configured SlowConsumerPolicy decides what is sacrificed.
+ *
+ * State-like frames can be pushed into a latest-value mailbox instead (push_latest()). A mailbox
+ * holds at most one unsent frame per key: a newer value replaces the pending one in place, so
+ * a client that falls behind gets the newest snapshot once it drains rather than a backlog of
+ * stale ones, and the memory used by mailboxes is bounded by the number of keys.
+ *
+ * Frames are immutable and reference counted (OutboundFrame), so a broadcast serializes a frame
+ * once and the very same buffer is queued to every subscriber.
+ *
+ * For peers which unpack container frames (set_containers()), each write packs the frames at the
+ * front of the queue into one container: one packet, one ring record and one read on the other
+ * side. Packing happens at write time, so queued frames keep their conflate and mailbox keys.
+ *
+ * The queue itself is not thread safe: callers serialize push() and flush() with the lock
+ * of the connection owning the queue.
+ *
+ * @author ak47
+ * @date 2026-10-16
+ */
+#ifndef OCTOPUS_IPC_OUTBOUND_QUEUE_HPP
+#define OCTOPUS_IPC_OUTBOUND_QUEUE_HPP
+
+#include <deque>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+class OctopusShmChannel;
+
+// A serialized frame shared by every queue it was pushed to, never modified once built
+typedef std::shared_ptr<const std::vector<uint8_t>> OutboundFrame;
+
+/**
+ * @brief Wraps serialized bytes into a shareable OutboundFrame without copying them.
+ */
+inline OutboundFrame make_outbound_frame(std::vector<uint8_t> bytes)
+{
+    return std::make_shared<const std::vector<uint8_t>>(std::move(bytes));
+}
+
+// What to do when a frame does not fit into a full outbound queue
+enum class SlowConsumerPolicy
+{
+    DropOldest,     // 丢弃最老的帧，为新帧腾出空间
+    DropConnection, // 断开慢速客户端
+    Conflate        // 用新值替换队列中同一 (group, msg) 的旧帧
+};
+
+// Outcome of OutboundQueue::push()
+enum class OutboundPushResult
+{
+    Queued,        // Frame appended, nothing dropped
+    DroppedOldest, // Frame appended after dropping older frames
+    Conflated,     // Frame replaced a queued frame with the same conflate (or mailbox) key
+    DroppedNewest, // Frame could not be queued and was discarded
+    Overflow       // Queue is full and the policy asks to drop the connection
+};
+
+// Outcome of OutboundQueue::flush()
+enum class OutboundFlushResult
+{
+    Drained, // Everything was written
+    Pending, // The socket would block, data is still queued
+    Error    // The socket failed, the connection should be closed
+};
+
+/**
+ * @class OutboundQueue
+ * @brief Byte bounded FIFO of frames written with writev() on a non-blocking socket.
+ */
+class OutboundQueue
+{
+public:
+    /**
+     * @brief Construct the queue.
+     * @param max_bytes Maximum number of queued bytes before the policy applies.
+     * @param policy Slow consumer policy applied on overflow.
+     */
+    OutboundQueue(size_t max_bytes, SlowConsumerPolicy policy);
+
+    /**
+     * @brief Appends a serialized frame.
+     * @param frame The serialized frame, shared with other queues.
+     * @param conflate_key Key identifying frames that may replace each other, -1 if the frame must
+     *                     never be conflated (e.g. key events and command responses).
+     * @param dropped_frames Optional, receives the number of frames dropped to make room.
+     * @return The outcome, see OutboundPushResult.
+     */
+    OutboundPushResult push(OutboundFrame frame, int conflate_key = -1, size_t *dropped_frames = nullptr);
+
+    /**
+     * @brief Stores a frame in the latest-value mailbox of a key.
+     *
+     * If the mailbox still holds an unsent frame, that frame is replaced and keeps its place in the
+     * queue. Otherwise the frame is appended like push() would, the byte limit and policy apply.
+     *
+     * @param frame The serialized frame, shared with other queues.
+     * @param mailbox_key Key of the mailbox, e.g. the (group, msg) of a state topic.
+     * @param dropped_frames Optional, receives the number of frames dropped to make room.
+     * @return The outcome, Conflated if a pending frame was replaced.
+     */
+    OutboundPushResult push_latest(OutboundFrame frame, int mailbox_key, size_t *dropped_frames = nullptr);
+
+    /**
+     * @brief Writes as much queued data as the socket accepts without blocking.
+     * @param socket_fd Non-blocking socket to write to.
+     */
+    OutboundFlushResult flush(int socket_fd);
+
+    /**
+     * @brief Writes queued frames as one packet each (SOCK_SEQPACKET), batched with sendmmsg().
+     *
+     * A packet is sent whole or not at all, so the receiver gets one frame per read.
+     * @param socket_fd Non-blocking SOCK_SEQPACKET socket to write to.
+     */
+    OutboundFlushResult flush_packets(int socket_fd);
+
+    /**
+     * @brief Copies queued frames into a shared memory channel until its ring is full.
+     *
+     * Frames are written whole: the ring never holds part of a frame the reader could see.
+     * @param channel Channel whose tx ring receives the frames.
+     */
+    OutboundFlushResult flush(OctopusShmChannel &channel);
+
+    /**
+     * @brief Moves frames out of the queue for an asynchronous write (io_uring linked sends).
+     *
+     * Mailbox values are pinned like by a write, the front frames are packed first if containers
+     * are enabled. Until restore() the frames are not part of the queue: the byte limit and the
+     * policy ignore them.
+     *
+     * @param frames Receives up to max_frames frames, front first.
+     * @param offset Receives the bytes of the first frame already written.
+     */
+    void take(std::vector<OutboundFrame> &frames, size_t max_frames, size_t &offset);
+
+    /**
+     * @brief Puts back the unwritten part of frames taken with take(), in front of the queue.
+     * @param frames The taken frames.
+     * @param offset The offset returned by take().
+     * @param written Bytes the asynchronous write got out, counted from offset.
+     */
+    void restore(const std::vector<OutboundFrame> &frames, size_t offset, size_t written);
+
+    /**
+     * @brief Lets writes pack the front frames into a container frame (see FrameContainerBuilder).
+     *
+     * Only enable it for a peer which unpacks containers. The queue keeps the packed frames with
+     * their keys until the write got the container out.
+     */
+    void set_containers(bool enabled) { containers_ = enabled; }
+
+    /**
+     * @brief Discards all queued frames.
+     */
+    void clear();
+
+    bool empty() const { return frames_.empty(); }
+    size_t get_queued_bytes() const { return queued_bytes_; }
+    size_t get_queued_frames() const { return frames_.size(); }
+
+private:
+    struct Entry
+    {
+        OutboundFrame bytes; ///< Serialized frame, null while it is still taken from the mailbox
+        int conflate_key;    ///< -1 if the frame is never conflated
+        int mailbox_key;     ///< Mailbox the frame is taken from, -1 for a plain frame
+    };
+
+    OutboundPushResult append(Entry entry, size_t frame_size, size_t *dropped_frames);
+    size_t entry_size(const Entry &entry) const;
+    void drop_entry(size_t index);
+    const OutboundFrame &entry_bytes(const Entry &entry);
+    size_t pack_front(std::vector<uint8_t> &container);
+    void replace_packed(size_t count, std::vector<uint8_t> container);
+
+    std::deque<Entry> frames_;  ///< Queued frames, front is being written
+    std::unordered_map<int, OutboundFrame> mailboxes_; ///< Latest unsent frame per mailbox key
+    size_t head_offset_;        ///< Bytes of the front frame already written
+    size_t queued_bytes_;       ///< Unwritten bytes in the queue
+    size_t max_bytes_;          ///< Byte limit
+    SlowConsumerPolicy policy_; ///< Overflow policy
+    bool containers_;           ///< Writes pack the front frames into a container
+};
+
+#endif // OCTOPUS_IPC_OUTBOUND_QUEUE_HPP
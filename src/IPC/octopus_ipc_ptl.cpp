@@ -16,16 +16,101 @@
 #include "octopus_ipc_ptl.hpp"
 
 // #define CHECKSUM_CRC_256
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// DataMessagePayload, spills from the inline buffer to the heap when it grows past it
+void DataMessagePayload::reserve(size_t capacity)
+{
+    if (capacity <= capacity_)
+        return;
+
+    uint8_t *bytes = new uint8_t[capacity];
+    if (size_ > 0)
+        memcpy(bytes, bytes_, size_);
+    release();
+    bytes_ = bytes;
+    capacity_ = capacity;
+}
+
+void DataMessagePayload::resize(size_t size, uint8_t value)
+{
+    if (size > capacity_)
+        reserve(std::max(size, capacity_ * 2));
+    if (size > size_)
+        memset(bytes_ + size_, value, size - size_);
+    size_ = size;
+}
+
+void DataMessagePayload::copy_from(const uint8_t *bytes, size_t size)
+{
+    if (size > capacity_)
+    {
+        // Exact size, the old bytes are replaced anyway
+        release();
+        bytes_ = new uint8_t[size];
+        capacity_ = size;
+    }
+    if (size > 0)
+        memcpy(bytes_, bytes, size);
+    size_ = size;
+}
+
+void DataMessagePayload::make_gap(size_t offset, size_t count)
+{
+    if (size_ + count > capacity_)
+        reserve(std::max(size_ + count, capacity_ * 2));
+    if (offset < size_)
+        memmove(bytes_ + offset + count, bytes_ + offset, size_ - offset);
+    size_ += count;
+}
+
+DataMessagePayload::iterator DataMessagePayload::erase(const_iterator first, const_iterator last)
+{
+    size_t offset = first - bytes_;
+    size_t count = last - first;
+    memmove(bytes_ + offset, bytes_ + offset + count, size_ - offset - count);
+    size_ -= count;
+    return bytes_ + offset;
+}
+
+void DataMessagePayload::steal(DataMessagePayload &other)
+{
+    if (other.is_inline())
+    {
+        // Inline bytes are copied, there is no block to take over
+        memcpy(inline_, other.inline_, other.size_);
+        bytes_ = inline_;
+        capacity_ = DATA_MESSAGE_INLINE_CAPACITY;
+    }
+    else
+    {
+        bytes_ = other.bytes_;
+        capacity_ = other.capacity_;
+        other.bytes_ = other.inline_;
+        other.capacity_ = DATA_MESSAGE_INLINE_CAPACITY;
+    }
+    size_ = other.size_;
+    other.size_ = 0;
+}
+
+void DataMessagePayload::release()
+{
+    if (!is_inline())
+        delete[] bytes_;
+    bytes_ = inline_;
+    capacity_ = DATA_MESSAGE_INLINE_CAPACITY;
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //[Header:2字节][Group:1字节][Msg:1字节][Length:2字节][Data:Length字节]
+//[0xA5A6][Group:1字节][Msg:1字节][Length:2字节][RequestId:4字节][Data:Length字节] 带请求 ID 的扩展帧头
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Serialize the DataMessage into a binary format for transmission
 
-DataMessage::DataMessage() : msg_header(_HEADER_), msg_group(0), msg_id(0), msg_length(0)
+DataMessage::DataMessage() : msg_header(_HEADER_), msg_group(0), msg_id(0), msg_length(0), request_id(0)
 {
     // Default constructor initializes the header with HEADER and all other fields to 0.
 }
-DataMessage::DataMessage(const std::vector<uint8_t> &data_array)
+DataMessage::DataMessage(const std::vector<uint8_t> &data_array) : request_id(0)
 {
     size_t baseSize = sizeof(this->msg_header) + sizeof(this->msg_group) + sizeof(this->msg_id) + sizeof(this->msg_length);
 
@@ -59,7 +144,7 @@ DataMessage::DataMessage(const std::vector<uint8_t> &data_array)
     //}
 }
 
-DataMessage::DataMessage(uint8_t msg_group, uint8_t msg_id, const std::vector<uint8_t> &data_array)
+DataMessage::DataMessage(uint8_t msg_group, uint8_t msg_id, const std::vector<uint8_t> &data_array) : request_id(0)
 {
     /// size_t head_Size = sizeof(this->header) + sizeof(this->group) + sizeof(this->msg) + sizeof(this->length);
 
@@ -85,6 +170,11 @@ DataMessage::DataMessage(uint8_t msg_group, uint8_t msg_id, const std::vector<ui
     // Update the length based on the size of the data portion
     this->msg_length = this->data.size();
 }
+DataMessage::DataMessage(uint8_t msg_group, uint8_t msg_id, const uint8_t *bytes, size_t size)
+    : msg_header(_HEADER_), msg_group(msg_group), msg_id(msg_id), msg_length(static_cast<uint16_t>(size)), request_id(0), data(bytes, size)
+{
+}
+
 /**
  * @brief Serializes the DataMessage object into a byte vector.
  *
@@ -94,36 +184,63 @@ DataMessage::DataMessage(uint8_t msg_group, uint8_t msg_id, const std::vector<ui
  */
 std::vector<uint8_t> DataMessage::serializeMessage() const
 {
-    std::vector<uint8_t> serializedData;
-
-    // Add header (2 bytes)
-    serializedData.push_back(static_cast<uint8_t>(msg_header >> 8));   // High byte of header
-    serializedData.push_back(static_cast<uint8_t>(msg_header & 0xFF)); // Low byte of header
-
-    // Add group (1 byte)
-    serializedData.push_back(msg_group);
-
-    // Add msg (1 byte)
-    serializedData.push_back(msg_id);
+    std::vector<uint8_t> serializedData(get_serialized_length());
+    serializeInto(serializedData.data(), serializedData.size());
+    return serializedData;
+}
 
-    // Add length (2 bytes)
-    serializedData.push_back(static_cast<uint8_t>(msg_length >> 8));   // High byte
-    serializedData.push_back(static_cast<uint8_t>(msg_length & 0xFF)); // Low byte
+size_t DataMessage::serializeInto(uint8_t *buffer, size_t capacity) const
+{
+    size_t length = get_serialized_length();
+    if (buffer == nullptr || capacity < length)
+    {
+        return 0;
+    }
 
-    // Add data elements
-    serializedData.insert(serializedData.end(), data.begin(), data.end());
+    serializeHeader(buffer);
+    if (!data.empty())
+    {
+        memcpy(buffer + get_header_length(), data.data(), data.size());
+    }
 
 #ifdef CHECKSUM_CRC_256
     // Calculate checksum only for the data section
     uint8_t checksum = 0;
-    for (size_t i = 0; i < serializedData.size(); ++i)
+    for (size_t i = 0; i < length - 1; ++i)
     {
-        checksum += serializedData[i];
+        checksum += buffer[i];
     }
     // Append checksum
-    serializedData.push_back(checksum & 0xFF);
+    buffer[length - 1] = checksum & 0xFF;
+#endif
+    return length;
+}
+
+void DataMessage::serializeHeader(uint8_t *header) const
+{
+    // Big endian fields, written at once. The request id decides between the two headers.
+    uint16_t magic = request_id ? _HEADER_EXT_ : msg_header;
+    const uint8_t bytes[EXTENDED_HEADER_LENGTH] = {
+        static_cast<uint8_t>(magic >> 8), static_cast<uint8_t>(magic & 0xFF),
+        msg_group, msg_id,
+        static_cast<uint8_t>(msg_length >> 8), static_cast<uint8_t>(msg_length & 0xFF),
+        static_cast<uint8_t>(request_id >> 24), static_cast<uint8_t>(request_id >> 16),
+        static_cast<uint8_t>(request_id >> 8), static_cast<uint8_t>(request_id)};
+    memcpy(header, bytes, get_header_length());
+}
+
+size_t DataMessage::get_header_length() const
+{
+    return request_id ? EXTENDED_HEADER_LENGTH : HEADER_LENGTH;
+}
+
+size_t DataMessage::get_serialized_length() const
+{
+#ifdef CHECKSUM_CRC_256
+    return get_total_length() + 1;
+#else
+    return get_total_length();
 #endif
-    return serializedData;
 }
 
 /**
@@ -160,6 +277,17 @@ DataMessage DataMessage::deserializeMessage(const std::vector<uint8_t> &buffer)
     // Extract length (2 bytes)
     data_message.msg_length = (static_cast<uint16_t>(buffer[4]) << 8) | buffer[5];
 
+    // Extended header: a request id follows, the message keeps the plain header value
+    if (data_message.msg_header == _HEADER_EXT_)
+    {
+        if (buffer.size() < EXTENDED_HEADER_LENGTH)
+            return data_message;
+        data_message.msg_header = _HEADER_;
+        data_message.request_id = (static_cast<uint32_t>(buffer[6]) << 24) | (static_cast<uint32_t>(buffer[7]) << 16) |
+                                  (static_cast<uint32_t>(buffer[8]) << 8) | buffer[9];
+        baseSize = EXTENDED_HEADER_LENGTH;
+    }
+
     // Check if remaining buffer matches length
     // if (buffer.size() < (baseSize + data_message.length))
     //{
@@ -202,8 +330,10 @@ void DataMessage::printMessage(const std::string &tag) const
               << msg_header
               << ", Group: 0x" << std::setw(2) << static_cast<int>(msg_group)
               << ", Msg: 0x" << std::setw(2) << static_cast<int>(msg_id)
-              << ", Length: " << std::dec << static_cast<int>(msg_length)
-              << ", Data: ";
+              << ", Length: " << std::dec << static_cast<int>(msg_length);
+    if (request_id)
+        std::cout << ", Request: " << request_id;
+    std::cout << ", Data: ";
 
     for (auto byte : data)
     {
@@ -222,13 +352,13 @@ void DataMessage::printMessage(const std::string &tag) const
  */
 size_t DataMessage::get_total_length() const
 {
-    return sizeof(msg_header) + sizeof(msg_group) + sizeof(msg_id) + sizeof(msg_length) + data.size();
+    return get_header_length() + data.size();
     // return sizeof(header) + sizeof(group) + sizeof(msg) + sizeof(length) + data.length();
 }
 
 size_t DataMessage::get_base_length() const
 {
-    return sizeof(msg_header) + sizeof(msg_group) + sizeof(msg_id) + sizeof(msg_length);
+    return get_header_length();
 }
 
 /**
@@ -242,3 +372,133 @@ size_t DataMessage::get_data_length() const
 {
     return data.size();
 }
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+DataMessageView::DataMessageView() : msg_header(DataMessage::_HEADER_), msg_group(0), msg_id(0), msg_length(0), request_id(0)
+{
+}
+
+DataMessageView::DataMessageView(const DataMessage &message)
+    : msg_header(message.request_id ? DataMessage::_HEADER_EXT_ : message.msg_header), msg_group(message.msg_group), msg_id(message.msg_id),
+      msg_length(message.msg_length), request_id(message.request_id), data(message.data.data(), message.data.size())
+{
+}
+
+bool DataMessageView::parse(const uint8_t *buffer, size_t size, DataMessageView &view)
+{
+    const size_t baseSize = 6; // Header + group + msg + length
+    if (buffer == nullptr || size < baseSize)
+    {
+        return false;
+    }
+
+    uint16_t header = (static_cast<uint16_t>(buffer[0]) << 8) | buffer[1];
+    uint16_t length = (static_cast<uint16_t>(buffer[4]) << 8) | buffer[5];
+    size_t header_length = (header == DataMessage::_HEADER_EXT_) ? DataMessage::EXTENDED_HEADER_LENGTH : baseSize;
+    bool known_header = (header == DataMessage::_HEADER_ || header == DataMessage::_HEADER_EXT_ || header == DataMessage::_HEADER_CONTAINER_);
+    if (!known_header || size < header_length + length)
+    {
+        return false;
+    }
+
+    view.msg_header = header;
+    view.msg_group = buffer[2];
+    view.msg_id = buffer[3];
+    view.msg_length = length;
+    view.request_id = 0;
+    if (header_length == DataMessage::EXTENDED_HEADER_LENGTH)
+    {
+        view.request_id = (static_cast<uint32_t>(buffer[6]) << 24) | (static_cast<uint32_t>(buffer[7]) << 16) |
+                          (static_cast<uint32_t>(buffer[8]) << 8) | buffer[9];
+    }
+    view.data = DataMessageSpan(buffer + header_length, length);
+    return true;
+}
+
+DataMessage DataMessageView::to_message() const
+{
+    DataMessage message; // Keeps the plain header value, the request id selects the header when serialized
+    message.msg_group = msg_group;
+    message.msg_id = msg_id;
+    message.msg_length = msg_length;
+    message.request_id = request_id;
+    message.data.assign(data.begin(), data.end());
+    return message;
+}
+
+bool DataMessageView::isValid() const
+{
+    return ((msg_header == DataMessage::_HEADER_ || msg_header == DataMessage::_HEADER_EXT_ || msg_header == DataMessage::_HEADER_CONTAINER_) &&
+            msg_length == data.size());
+}
+
+void DataMessageView::printMessage(const std::string &tag) const
+{
+    std::cout << tag << ": Header 0x" << std::hex << std::setw(2) << std::setfill('0')
+              << msg_header
+              << ", Group: 0x" << std::setw(2) << static_cast<int>(msg_group)
+              << ", Msg: 0x" << std::setw(2) << static_cast<int>(msg_id)
+              << ", Length: " << std::dec << static_cast<int>(msg_length);
+    if (request_id)
+        std::cout << ", Request: " << request_id;
+    std::cout << ", Data: ";
+
+    for (auto byte : data)
+    {
+        std::cout << std::hex << "0x" << static_cast<int>(byte) << " ";
+    }
+    std::cout << std::dec << std::endl;
+}
+
+size_t DataMessageView::get_total_length() const
+{
+    return (msg_header == DataMessage::_HEADER_EXT_ ? DataMessage::EXTENDED_HEADER_LENGTH : DataMessage::HEADER_LENGTH) + data.size();
+}
+
+bool batch_reply_add_item(std::vector<uint8_t> &reply_data, uint8_t msg_id, const void *data, uint16_t length)
+{
+    if (reply_data.size() + BATCH_ITEM_HEADER_LENGTH + length > 0xFFFF)
+        return false;
+
+    const uint8_t header[BATCH_ITEM_HEADER_LENGTH] = {msg_id, static_cast<uint8_t>(length >> 8), static_cast<uint8_t>(length & 0xFF)};
+    reply_data.insert(reply_data.end(), header, header + BATCH_ITEM_HEADER_LENGTH);
+    if (length)
+    {
+        const uint8_t *bytes = static_cast<const uint8_t *>(data);
+        reply_data.insert(reply_data.end(), bytes, bytes + length);
+    }
+    return true;
+}
+
+bool batch_reply_next_item(const DataMessageSpan &reply_data, size_t &offset, uint8_t *msg_id, DataMessageSpan *item)
+{
+    if (offset + BATCH_ITEM_HEADER_LENGTH > reply_data.size())
+        return false;
+
+    size_t length = (static_cast<size_t>(reply_data[offset + 1]) << 8) | reply_data[offset + 2];
+    if (offset + BATCH_ITEM_HEADER_LENGTH + length > reply_data.size())
+        return false;
+
+    *msg_id = reply_data[offset];
+    *item = DataMessageSpan(reply_data.data() + offset + BATCH_ITEM_HEADER_LENGTH, length);
+    offset += BATCH_ITEM_HEADER_LENGTH + length;
+    return true;
+}
+
+void state_version_append(std::vector<uint8_t> &data, uint64_t version)
+{
+    for (int shift = 56; shift >= 0; shift -= 8)
+        data.push_back(static_cast<uint8_t>(version >> shift));
+}
+
+bool state_version_parse(const DataMessageSpan &data, uint64_t *version)
+{
+    if (data.size() < STATE_VERSION_LENGTH)
+        return false;
+
+    uint64_t value = 0;
+    for (size_t i = data.size() - STATE_VERSION_LENGTH; i < data.size(); ++i)
+        value = (value << 8) | data[i];
+    *version = value;
+    return true;
+}
@@ -28,21 +28,235 @@
 #include <iostream>
 #include <iomanip>
 #include <stdexcept>
+#include <iterator>
+#include <algorithm>
+#include <initializer_list>
+#include <cstring>
 #include "../OTSM/octopus_message.h"
 
+/// @brief ///////////////////////////////////////////////////////////////////////////////////////////////////////
+// IPC configuration commands (MSG_GROUP_IPC_CONFIG) handled by the IPC server itself, numbered
+// above the OTSM commands of the group.
+enum
+{
+    MSG_IPC_CMD_CONFIG_SUBSCRIBE = 0x40,      ///< Data: (group, msg_id) pairs to receive pushes for
+    MSG_IPC_CMD_CONFIG_UNSUBSCRIBE = 0x41,    ///< Data: (group, msg_id) pairs to stop receiving
+    MSG_IPC_CMD_CONFIG_TOPIC_INTERVAL = 0x42, ///< Data: (group, msg_id, interval_ms hi, interval_ms lo) tuples
+    MSG_IPC_CMD_CONFIG_KEYFRAME = 0x43,       ///< Data: (interval_ms hi, interval_ms lo), resend unchanged snapshots this often
+    MSG_IPC_CMD_CONFIG_SHM_RING = 0x44,       ///< Data: (ring_kb hi, ring_kb lo). Reply: (ok, ring bytes 32 bit BE) + 4 fds
+    MSG_IPC_CMD_CONFIG_BROADCAST_RING = 0x45, ///< Data: (enabled), pushes are read from the shared memory broadcast ring
+    MSG_IPC_CMD_CONFIG_LARGE_PAYLOAD = 0x46,  ///< Data: (group, msg_id, size 32 bit BE) + sealed memfd. Reply: (group, msg_id, ok)
+    MSG_IPC_CMD_CONFIG_CONTAINER = 0x47,      ///< Data: (enabled), frames to the client may be packed into container frames
+};
+
+// Carinfo commands (MSG_GROUP_CAR) handled by the IPC server itself, numbered above the OTSM ones.
+enum
+{
+    MSG_IPC_CMD_CAR_GET_BATCH = 0x60,       ///< Data: msg_ids of GETs. Reply: one batch item per msg_id
+    MSG_IPC_CMD_CAR_GET_IF_MODIFIED = 0x61, ///< Data: (msg_id of a GET, known version 64 bit BE). Reply: GET frame + version, or NOT_MODIFIED
+    MSG_IPC_CMD_CAR_NOT_MODIFIED = 0x62,    ///< Reply only. Data: (msg_id), the known version is current
+};
+
+// Wildcard msg_id (whole group) or group (everything) in a topic pair
+enum
+{
+    MSG_IPC_TOPIC_ANY = 0xFF
+};
+
+// True if every id is below limit: the server ids above must not collide with the OTSM table
+constexpr bool ipc_ptl_ids_below(int limit, std::initializer_list<int> ids)
+{
+    for (int id : ids)
+    {
+        if (id >= limit)
+            return false;
+    }
+    return true;
+}
+static_assert(ipc_ptl_ids_below(MSG_IPC_CMD_CONFIG_SUBSCRIBE,
+                                {MSG_IPC_CMD_CONFIG_FLAG, MSG_IPC_CMD_CONFIG_IP, MSG_IPC_CMD_CONFIG_PUSH_DELAY, MSG_IPC_SOCKET_CONFIG_IP}),
+              "OTSM config commands overlap the IPC server config commands");
+static_assert(ipc_ptl_ids_below(MSG_IPC_CMD_CAR_GET_BATCH,
+                                {MSG_IPC_CMD_CAR_GET_INDICATOR_INFO, MSG_IPC_CMD_CAR_GET_METER_INFO, MSG_IPC_CMD_CAR_GET_BATTERY_INFO,
+                                 MSG_IPC_CMD_CAR_GET_ERROR_INFO, MSG_IPC_CMD_CAR_GET_DRIVINFO_INFO, MSG_IPC_CMD_CAR_SET_LIGHT,
+                                 MSG_IPC_CMD_CAR_SET_GEAR_LEVEL, MSG_IPC_CMD_CAR_SETTING_SAVE, MSG_IPC_CMD_CAR_METER_ODO_CLEAR,
+                                 MSG_IPC_CMD_CAR_METER_TIME_CLEAR, MSG_IPC_CMD_CAR_METER_TRIP_DISTANCE_CLEAR, MSG_IPC_CMD_CAR_SET_INDICATOR,
+                                 MSG_IPC_CMD_CAR_SET_METER, MSG_IPC_CMD_CAR_SET_BATTERY}),
+              "OTSM carinfo commands overlap the IPC server carinfo commands");
+static_assert(ipc_ptl_ids_below(MSG_IPC_TOPIC_ANY,
+                                {MSG_GROUP_0, MSG_GROUP_HELP, MSG_GROUP_SET, MSG_GROUP_IPC_CONFIG, MSG_GROUP_CAR, MSG_GROUP_MCU}),
+              "An OTSM group collides with the topic wildcard");
+
+/// @brief ///////////////////////////////////////////////////////////////////////////////////////////////////////
+// Payloads up to this size are stored inside the DataMessage, larger ones on the heap.
+// Commands, key events and the carinfo structs all fit.
+#define DATA_MESSAGE_INLINE_CAPACITY 64
+
+/**
+ * @brief Byte container of DataMessage::data with inline storage for small payloads.
+ *
+ * Offers the std::vector<uint8_t> members used with message payloads (and converts to and from
+ * std::vector), so code written against the vector keeps compiling. Constructing, copying and
+ * filling a message with at most DATA_MESSAGE_INLINE_CAPACITY bytes allocates nothing.
+ */
+class DataMessagePayload
+{
+public:
+    typedef uint8_t value_type;
+    typedef size_t size_type;
+    typedef uint8_t &reference;
+    typedef const uint8_t &const_reference;
+    typedef uint8_t *iterator;
+    typedef const uint8_t *const_iterator;
+
+    DataMessagePayload() : bytes_(inline_), size_(0), capacity_(DATA_MESSAGE_INLINE_CAPACITY) {}
+    DataMessagePayload(const uint8_t *bytes, size_t size) : DataMessagePayload() { copy_from(bytes, size); }
+    DataMessagePayload(const std::vector<uint8_t> &bytes) : DataMessagePayload() { copy_from(bytes.data(), bytes.size()); }
+    DataMessagePayload(std::initializer_list<uint8_t> bytes) : DataMessagePayload() { copy_from(bytes.begin(), bytes.size()); }
+    DataMessagePayload(const DataMessagePayload &other) : DataMessagePayload() { copy_from(other.bytes_, other.size_); }
+    DataMessagePayload(DataMessagePayload &&other) noexcept : DataMessagePayload() { steal(other); }
+    ~DataMessagePayload() { release(); }
+
+    DataMessagePayload &operator=(const DataMessagePayload &other)
+    {
+        if (this != &other)
+            copy_from(other.bytes_, other.size_);
+        return *this;
+    }
+    DataMessagePayload &operator=(DataMessagePayload &&other) noexcept
+    {
+        if (this != &other)
+        {
+            release();
+            steal(other);
+        }
+        return *this;
+    }
+    DataMessagePayload &operator=(const std::vector<uint8_t> &bytes)
+    {
+        copy_from(bytes.data(), bytes.size());
+        return *this;
+    }
+    DataMessagePayload &operator=(std::initializer_list<uint8_t> bytes)
+    {
+        copy_from(bytes.begin(), bytes.size());
+        return *this;
+    }
+
+    operator std::vector<uint8_t>() const { return std::vector<uint8_t>(begin(), end()); }
+
+    uint8_t *data() { return bytes_; }
+    const uint8_t *data() const { return bytes_; }
+    size_t size() const { return size_; }
+    size_t capacity() const { return capacity_; }
+    bool empty() const { return size_ == 0; }
+    bool is_inline() const { return bytes_ == inline_; }
+
+    iterator begin() { return bytes_; }
+    iterator end() { return bytes_ + size_; }
+    const_iterator begin() const { return bytes_; }
+    const_iterator end() const { return bytes_ + size_; }
+    const_iterator cbegin() const { return bytes_; }
+    const_iterator cend() const { return bytes_ + size_; }
+
+    uint8_t &operator[](size_t index) { return bytes_[index]; }
+    uint8_t operator[](size_t index) const { return bytes_[index]; }
+    uint8_t &at(size_t index)
+    {
+        if (index >= size_)
+            throw std::out_of_range("DataMessagePayload::at");
+        return bytes_[index];
+    }
+    uint8_t at(size_t index) const
+    {
+        if (index >= size_)
+            throw std::out_of_range("DataMessagePayload::at");
+        return bytes_[index];
+    }
+    uint8_t &front() { return bytes_[0]; }
+    uint8_t front() const { return bytes_[0]; }
+    uint8_t &back() { return bytes_[size_ - 1]; }
+    uint8_t back() const { return bytes_[size_ - 1]; }
+
+    void clear() { size_ = 0; }
+    void reserve(size_t capacity);
+    void resize(size_t size, uint8_t value = 0);
+    void push_back(uint8_t value)
+    {
+        if (size_ == capacity_)
+            reserve(capacity_ * 2);
+        bytes_[size_++] = value;
+    }
+    void pop_back() { size_--; }
+
+    template <typename InputIt>
+    void assign(InputIt first, InputIt last)
+    {
+        clear();
+        insert(end(), first, last);
+    }
+    void assign(size_t count, uint8_t value)
+    {
+        clear();
+        resize(count, value);
+    }
+
+    template <typename InputIt>
+    iterator insert(const_iterator position, InputIt first, InputIt last)
+    {
+        size_t offset = position - bytes_;
+        size_t count = static_cast<size_t>(std::distance(first, last));
+        make_gap(offset, count);
+        std::copy(first, last, bytes_ + offset);
+        return bytes_ + offset;
+    }
+    iterator insert(const_iterator position, uint8_t value)
+    {
+        size_t offset = position - bytes_;
+        make_gap(offset, 1);
+        bytes_[offset] = value;
+        return bytes_ + offset;
+    }
+    iterator erase(const_iterator first, const_iterator last);
+    iterator erase(const_iterator position) { return erase(position, position + 1); }
+
+    bool operator==(const DataMessagePayload &other) const
+    {
+        return size_ == other.size_ && (size_ == 0 || memcmp(bytes_, other.bytes_, size_) == 0);
+    }
+    bool operator!=(const DataMessagePayload &other) const { return !(*this == other); }
+
+private:
+    void copy_from(const uint8_t *bytes, size_t size);
+    void make_gap(size_t offset, size_t count);
+    void steal(DataMessagePayload &other);
+    void release();
+
+    uint8_t *bytes_;   ///< inline_ or a heap block
+    size_t size_;      ///< Bytes in use
+    size_t capacity_;  ///< Bytes available at bytes_
+    uint8_t inline_[DATA_MESSAGE_INLINE_CAPACITY];
+};
+
 /// @brief ///////////////////////////////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 class DataMessage
 {
 public:
     // A constant for the fixed header value
-    static constexpr uint16_t _HEADER_ = 0xA5A5; ///< Fixed header value indicating the start of a message
+    static constexpr uint16_t _HEADER_ = 0xA5A5;           ///< Fixed header value indicating the start of a message
+    static constexpr uint16_t _HEADER_EXT_ = 0xA5A6;       ///< Start of a message carrying a request id
+    static constexpr uint16_t _HEADER_CONTAINER_ = 0xA5A7; ///< Start of a container frame, its data are whole frames
+    static constexpr size_t HEADER_LENGTH = 6;             ///< [Header:2][Group:1][Msg:1][Length:2] in front of the data
+    static constexpr size_t EXTENDED_HEADER_LENGTH = 10;   ///< HEADER_LENGTH followed by [RequestId:4], big endian
 
     uint16_t msg_header;       ///< Header for identifying the message (usually fixed)
     uint8_t msg_group;         ///< Group ID for categorizing the message type
     uint8_t msg_id;            ///< Message ID within the group
-    uint16_t msg_length;       ///< Length of the data in the message (max 255) msg_length = data.size();
-    std::vector<uint8_t> data; ///< Message data (content of the message)
+    uint16_t msg_length;       ///< Length of the data in the message (16 bit, max 0xFFFF) msg_length = data.size();
+    uint32_t request_id;       ///< Correlation id, 0 for none. Non-zero ids are sent in the extended header
+                               ///< and echoed by the reply, so replies can be matched to pipelined requests.
+    DataMessagePayload data;   ///< Message data (content of the message), inline up to DATA_MESSAGE_INLINE_CAPACITY bytes
 
     /**
      * @brief Default constructor for the DataMessage object.
@@ -54,6 +268,8 @@ public:
     DataMessage(const std::vector<uint8_t> &data_array);
 
     DataMessage(uint8_t msg_group, uint8_t msg_id, const std::vector<uint8_t> &data_array); // Constructor declaration
+
+    DataMessage(uint8_t msg_group, uint8_t msg_id, const uint8_t *bytes, size_t size); ///< Copies size bytes as the data
     /**
      * @brief Serializes the DataMessage object into a byte vector.
      *
@@ -63,6 +279,26 @@ public:
      */
     std::vector<uint8_t> serializeMessage() const;
 
+    /**
+     * @brief Serializes the message into a caller provided buffer, nothing is allocated.
+     *
+     * @param buffer   Receives the frame.
+     * @param capacity Size of the buffer, at least get_serialized_length().
+     * @return Bytes written, 0 if the buffer is too small.
+     */
+    size_t serializeInto(uint8_t *buffer, size_t capacity) const;
+
+    /**
+     * @brief Writes the get_header_length() bytes in front of the data, e.g. to send them with the
+     *        data as separate pieces (writev) instead of copying both into one frame.
+     *        EXTENDED_HEADER_LENGTH bytes always suffice.
+     */
+    void serializeHeader(uint8_t *header) const;
+
+    size_t get_header_length() const; ///< HEADER_LENGTH, or EXTENDED_HEADER_LENGTH with a request id.
+
+    size_t get_serialized_length() const; ///< Bytes written by serializeInto(), the total length plus the optional checksum.
+
     /**
      * @brief Deserializes a byte vector into a DataMessage object.
      *
@@ -98,4 +334,107 @@ public:
     size_t get_data_length() const; ///< Returns the length of the data portion of the message.
 };
 
+/// @brief ///////////////////////////////////////////////////////////////////////////////////////////////////////
+// Read-only byte range, the payload of a DataMessageView. Offers the read accessors of std::vector.
+class DataMessageSpan
+{
+public:
+    DataMessageSpan() : bytes_(nullptr), size_(0) {}
+    DataMessageSpan(const uint8_t *bytes, size_t size) : bytes_(bytes), size_(size) {}
+
+    const uint8_t *data() const { return bytes_; }
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    const uint8_t *begin() const { return bytes_; }
+    const uint8_t *end() const { return bytes_ + size_; }
+    uint8_t operator[](size_t index) const { return bytes_[index]; }
+
+private:
+    const uint8_t *bytes_;
+    size_t size_;
+};
+
+/**
+ * @brief Non-owning view of a frame, parsed in place in a receive buffer.
+ *
+ * Same fields as DataMessage, but the payload is not copied: data points into the buffer the frame
+ * was parsed from, so a view is only valid as long as that buffer is left untouched (for a
+ * FrameDecoder, until its next feed(), next() or clear()). Use to_message() for an owning copy.
+ */
+class DataMessageView
+{
+public:
+    uint16_t msg_header;  ///< Header as received: DataMessage::_HEADER_, _HEADER_EXT_ or _HEADER_CONTAINER_
+    uint8_t msg_group;    ///< Group ID for categorizing the message type
+    uint8_t msg_id;       ///< Message ID within the group
+    uint16_t msg_length;  ///< Length of the data in the message
+    uint32_t request_id;  ///< Correlation id of the extended header, 0 for none
+    DataMessageSpan data; ///< Message data, points into the receive buffer
+
+    DataMessageView();
+
+    /**
+     * @brief View of an owning message, valid while the message is alive and unchanged.
+     */
+    DataMessageView(const DataMessage &message);
+
+    /**
+     * @brief Parses a serialized frame without copying it.
+     *
+     * Checks the header and that the buffer holds the whole frame announced by the length field.
+     * The plain, the extended (request id) and the container header are accepted.
+     *
+     * @param buffer Serialized frame, must outlive the view.
+     * @param size   Bytes available in the buffer, may be more than the frame.
+     * @param view   Receives the parsed frame.
+     * @return true if the buffer starts with a valid, complete frame.
+     */
+    static bool parse(const uint8_t *buffer, size_t size, DataMessageView &view);
+
+    /**
+     * @brief Makes an owning copy, e.g. to keep the message beyond the lifetime of the buffer.
+     */
+    DataMessage to_message() const;
+
+    bool isValid() const;
+
+    void printMessage(const std::string &tag) const;
+
+    size_t get_total_length() const; ///< Returns the total length of the serialized message.
+};
+
+/// @brief ///////////////////////////////////////////////////////////////////////////////////////////////////////
+// Reply data of MSG_IPC_CMD_CAR_GET_BATCH: one item per requested msg_id, in request order,
+// each (msg_id, length hi, length lo, data). An unavailable state has length 0.
+#define BATCH_ITEM_HEADER_LENGTH 3
+
+/**
+ * @brief Appends one item to the data of a batch reply.
+ * @return false if the item would not fit into a frame, nothing is appended then.
+ */
+bool batch_reply_add_item(std::vector<uint8_t> &reply_data, uint8_t msg_id, const void *data, uint16_t length);
+
+/**
+ * @brief Reads the item at offset of a batch reply and advances offset past it.
+ * @param item Receives the item data, points into reply_data.
+ * @return false at the end of the reply or if the item is truncated.
+ */
+bool batch_reply_next_item(const DataMessageSpan &reply_data, size_t &offset, uint8_t *msg_id, DataMessageSpan *item);
+
+/// @brief ///////////////////////////////////////////////////////////////////////////////////////////////////////
+// A GET_IF_MODIFIED request carries the known state version after the msg_id, a changed state comes
+// back with the current one after the struct. Both 64 bit BE.
+#define STATE_VERSION_LENGTH 8
+
+/**
+ * @brief Appends a state version to the data of a request or reply.
+ */
+void state_version_append(std::vector<uint8_t> &data, uint64_t version);
+
+/**
+ * @brief Reads the state version at the end of a MSG_IPC_CMD_CAR_GET_IF_MODIFIED request or reply.
+ * @return false if the data is too short to carry one.
+ */
+bool state_version_parse(const DataMessageSpan &data, uint64_t *version);
+
 #endif // OCTOPUS_IPC_PTL_HANDLER_HPP
@@ -0,0 +1,717 @@
+/**
+ * @file octopus_ipc_reactor.cpp
+ * @brief Implementation of the epoll based event loop used by the IPC server.
+ *
+ * @author ak47
+ * @date 2026-10-16
+ */
+#include "octopus_ipc_reactor.hpp"
+#include "octopus_ipc_uring.hpp"
+#include <iostream>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+
+#define REACTOR_MAX_EVENTS 64 // Maximum number of events handled per epoll_wait()
+
+#define REACTOR_URING_ENTRIES 256       // Submission queue size
+#define REACTOR_URING_BUFFER_GROUP 0    // Provided buffer group of the receives
+#define REACTOR_URING_BUFFER_COUNT 256  // Provided receive buffers, a power of two
+#define REACTOR_URING_BUFFER_SIZE 4096  // Size of one provided buffer (header, control data and payload)
+#define REACTOR_URING_MAX_PASSED_FDS 16 // Descriptors a receive accepts along the data
+
+// Operation of a completion, in the low byte of user_data above the registration id
+#define REACTOR_URING_OP_WAKEUP 1
+#define REACTOR_URING_OP_POLL 2
+#define REACTOR_URING_OP_RECEIVE 3
+#define REACTOR_URING_OP_ACCEPT 4
+#define REACTOR_URING_OP_SEND 5
+#define REACTOR_URING_OP_CANCEL 6 // Cancel and poll update results, ignored
+#define REACTOR_URING_USER_DATA(id, op) (((id) << 8) | (op))
+
+OctopusReactor::OctopusReactor()
+    : epoll_fd_(-1),
+      wakeup_fd_(-1),
+      is_running_(false),
+      backend_(ReactorBackend::Epoll),
+      uring_next_id_(1),
+      uring_wakeup_value_(0)
+{
+    memset(&uring_recv_msg_, 0, sizeof(uring_recv_msg_));
+}
+
+OctopusReactor::~OctopusReactor()
+{
+    stop();
+}
+
+bool OctopusReactor::start(const std::string &name, ReactorBackend backend)
+{
+    if (is_running_)
+        return true;
+
+    name_ = name;
+    backend_ = ReactorBackend::Epoll;
+    if (backend == ReactorBackend::IoUring)
+    {
+        if (start_uring())
+            return true;
+        std::cerr << "[" << name_ << "] io_uring unavailable, falling back to epoll." << std::endl;
+    }
+
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd_ == -1)
+    {
+        std::cerr << "[" << name_ << "] epoll_create1 failed: " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    wakeup_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wakeup_fd_ == -1)
+    {
+        std::cerr << "[" << name_ << "] eventfd failed: " << strerror(errno) << std::endl;
+        close(epoll_fd_);
+        epoll_fd_ = -1;
+        return false;
+    }
+
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.fd = wakeup_fd_;
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wakeup_fd_, &ev) == -1)
+    {
+        std::cerr << "[" << name_ << "] epoll_ctl ADD wakeup fd failed: " << strerror(errno) << std::endl;
+        close(wakeup_fd_);
+        close(epoll_fd_);
+        wakeup_fd_ = epoll_fd_ = -1;
+        return false;
+    }
+
+    is_running_ = true;
+    loop_thread_ = std::thread(&OctopusReactor::event_loop, this);
+    std::cout << "[" << name_ << "] Reactor started (epoll_fd = " << epoll_fd_ << ")" << std::endl;
+    return true;
+}
+
+bool OctopusReactor::start_uring()
+{
+    std::unique_ptr<OctopusUring> uring(new OctopusUring());
+    if (!uring->open(REACTOR_URING_ENTRIES) ||
+        !uring->register_buffers(REACTOR_URING_BUFFER_GROUP, REACTOR_URING_BUFFER_COUNT, REACTOR_URING_BUFFER_SIZE))
+        return false;
+
+    // Blocking: io_uring waits for a blocking eventfd, a non-blocking one completes with EAGAIN
+    wakeup_fd_ = eventfd(0, EFD_CLOEXEC);
+    if (wakeup_fd_ == -1)
+    {
+        std::cerr << "[" << name_ << "] eventfd failed: " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    // Multishot receives lay out [header][control][payload] in each buffer, no name
+    memset(&uring_recv_msg_, 0, sizeof(uring_recv_msg_));
+    uring_recv_msg_.msg_controllen = CMSG_SPACE(sizeof(int) * REACTOR_URING_MAX_PASSED_FDS);
+
+    uring_ = std::move(uring);
+    backend_ = ReactorBackend::IoUring;
+    is_running_ = true;
+    loop_thread_ = std::thread(&OctopusReactor::uring_event_loop, this);
+    std::cout << "[" << name_ << "] Reactor started (io_uring)" << std::endl;
+    return true;
+}
+
+void OctopusReactor::stop()
+{
+    if (!is_running_.exchange(false))
+        return;
+
+    // Interrupt epoll_wait() so the loop can observe is_running_
+    uint64_t one = 1;
+    if (write(wakeup_fd_, &one, sizeof(one)) < 0)
+    {
+        std::cerr << "[" << name_ << "] Failed to wake up reactor: " << strerror(errno) << std::endl;
+    }
+
+    bool joined = false;
+    if (loop_thread_.joinable() && !is_in_loop_thread())
+    {
+        loop_thread_.join();
+        joined = true;
+    }
+    else if (loop_thread_.joinable())
+        loop_thread_.detach();
+
+    {
+        std::lock_guard<std::mutex> lock(handlers_mutex_);
+        handlers_.clear();
+    }
+    if (uring_ && joined)
+    {
+        // Closing the ring cancels whatever is still in flight
+        uring_.reset();
+        uring_watches_.clear();
+        uring_watch_ids_.clear();
+        uring_closing_sends_.clear();
+    }
+
+    close(wakeup_fd_);
+    close(epoll_fd_);
+    wakeup_fd_ = epoll_fd_ = -1;
+    std::cout << "[" << name_ << "] Reactor stopped." << std::endl;
+}
+
+bool OctopusReactor::add_fd(int fd, uint32_t events, EventHandler handler)
+{
+    std::shared_ptr<EventHandler> shared_handler = std::make_shared<EventHandler>(std::move(handler));
+    {
+        std::lock_guard<std::mutex> lock(handlers_mutex_);
+        handlers_[fd] = shared_handler;
+    }
+
+    if (backend_ == ReactorBackend::IoUring)
+    {
+        UringWatch watch;
+        watch.events = events;
+        watch.handler = shared_handler;
+        run_in_loop([this, fd, watch]()
+                    { uring_add_watch(fd, watch); });
+        return true;
+    }
+
+    epoll_event ev{};
+    ev.events = events;
+    ev.data.fd = fd;
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev) == -1)
+    {
+        std::cerr << "[" << name_ << "] Failed to add fd " << fd << " to epoll: " << strerror(errno) << std::endl;
+        std::lock_guard<std::mutex> lock(handlers_mutex_);
+        handlers_.erase(fd);
+        return false;
+    }
+    return true;
+}
+
+bool OctopusReactor::modify_fd(int fd, uint32_t events)
+{
+    if (backend_ == ReactorBackend::IoUring)
+    {
+        run_in_loop([this, fd, events]()
+                    { uring_modify_watch(fd, events); });
+        return true;
+    }
+
+    epoll_event ev{};
+    ev.events = events;
+    ev.data.fd = fd;
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, fd, &ev) == -1)
+    {
+        std::cerr << "[" << name_ << "] Failed to modify fd " << fd << " in epoll: " << strerror(errno) << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void OctopusReactor::remove_fd(int fd)
+{
+    if (backend_ == ReactorBackend::IoUring)
+    {
+        {
+            std::lock_guard<std::mutex> lock(handlers_mutex_);
+            handlers_.erase(fd);
+        }
+        run_in_loop([this, fd]()
+                    { uring_remove_watch(fd); });
+        return;
+    }
+
+    epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+    std::lock_guard<std::mutex> lock(handlers_mutex_);
+    handlers_.erase(fd);
+}
+
+bool OctopusReactor::add_acceptor(int listen_fd, AcceptHandler handler)
+{
+    if (backend_ != ReactorBackend::IoUring)
+    {
+        // One accept per readiness report, epoll reports a backlog again
+        int flags = fcntl(listen_fd, F_GETFL, 0);
+        if (flags == -1 || fcntl(listen_fd, F_SETFL, flags | O_NONBLOCK) == -1)
+            return false;
+        auto accept_handler = [this, handler](int fd, uint32_t)
+        {
+            int client_fd = accept4(fd, nullptr, nullptr, SOCK_CLOEXEC);
+            if (client_fd >= 0)
+                handler(fd, client_fd);
+            else if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+                std::cerr << "[" << name_ << "] accept on fd " << fd << " failed: " << strerror(errno) << std::endl;
+        };
+        return add_fd(listen_fd, EPOLLIN, accept_handler);
+    }
+
+    UringWatch watch;
+    watch.handler = std::make_shared<EventHandler>([](int, uint32_t) {});
+    watch.accept = std::make_shared<AcceptHandler>(std::move(handler));
+    {
+        std::lock_guard<std::mutex> lock(handlers_mutex_);
+        handlers_[listen_fd] = watch.handler;
+    }
+    run_in_loop([this, listen_fd, watch]()
+                { uring_add_watch(listen_fd, watch); });
+    return true;
+}
+
+bool OctopusReactor::add_receiver(int fd, uint32_t events, EventHandler handler, ReceiveHandler receive)
+{
+    if (backend_ != ReactorBackend::IoUring)
+        return false;
+
+    UringWatch watch;
+    watch.events = events;
+    watch.handler = std::make_shared<EventHandler>(std::move(handler));
+    watch.receive = std::make_shared<ReceiveHandler>(std::move(receive));
+    {
+        std::lock_guard<std::mutex> lock(handlers_mutex_);
+        handlers_[fd] = watch.handler;
+    }
+    run_in_loop([this, fd, watch]()
+                { uring_add_watch(fd, watch); });
+    return true;
+}
+
+bool OctopusReactor::submit_sends(int fd, const iovec *iov, size_t count, SendHandler done)
+{
+    if (backend_ != ReactorBackend::IoUring || count == 0 || !is_in_loop_thread())
+        return false;
+
+    auto id = uring_watch_ids_.find(fd);
+    if (id == uring_watch_ids_.end())
+        return false;
+    UringSendChain &chain = uring_watches_[id->second].sends;
+    if (!chain.lengths.empty() || !uring_->reserve(static_cast<unsigned>(count)))
+        return false;
+
+    // Linked: a send only starts once the previous one wrote all of its bytes
+    for (size_t i = 0; i < count; ++i)
+    {
+        uring_->prep_send(fd, iov[i].iov_base, iov[i].iov_len, i + 1 < count,
+                          REACTOR_URING_USER_DATA(id->second, REACTOR_URING_OP_SEND));
+        chain.lengths.push_back(iov[i].iov_len);
+    }
+    chain.done = std::move(done);
+    return true;
+}
+
+size_t OctopusReactor::get_fd_count() const
+{
+    std::lock_guard<std::mutex> lock(handlers_mutex_);
+    return handlers_.size();
+}
+
+bool OctopusReactor::is_in_loop_thread() const
+{
+    return std::this_thread::get_id() == loop_thread_.get_id();
+}
+
+void OctopusReactor::event_loop()
+{
+    epoll_event events[REACTOR_MAX_EVENTS];
+
+    while (is_running_)
+    {
+        // Block until something happens, an idle reactor never wakes up
+        int n = epoll_wait(epoll_fd_, events, REACTOR_MAX_EVENTS, -1);
+        if (n == -1)
+        {
+            if (errno == EINTR)
+                continue;
+            std::cerr << "[" << name_ << "] epoll_wait failed: " << strerror(errno) << std::endl;
+            break;
+        }
+
+        for (int i = 0; i < n; ++i)
+        {
+            int fd = events[i].data.fd;
+            if (fd == wakeup_fd_)
+            {
+                uint64_t value;
+                while (read(wakeup_fd_, &value, sizeof(value)) > 0)
+                {
+                }
+                continue;
+            }
+
+            // Copy the handler out so it may remove itself while running
+            std::shared_ptr<EventHandler> handler;
+            {
+                std::lock_guard<std::mutex> lock(handlers_mutex_);
+                auto it = handlers_.find(fd);
+                if (it == handlers_.end())
+                    continue;
+                handler = it->second;
+            }
+
+            try
+            {
+                (*handler)(fd, events[i].events);
+            }
+            catch (const std::exception &e)
+            {
+                std::cerr << "[" << name_ << "] Handler for fd " << fd << " threw exception: " << e.what() << std::endl;
+            }
+        }
+    }
+}
+
+void OctopusReactor::run_in_loop(std::function<void()> command)
+{
+    if (is_in_loop_thread())
+    {
+        command();
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(commands_mutex_);
+        commands_.push_back(std::move(command));
+    }
+    uint64_t one = 1;
+    if (write(wakeup_fd_, &one, sizeof(one)) < 0)
+    {
+        std::cerr << "[" << name_ << "] Failed to wake up reactor: " << strerror(errno) << std::endl;
+    }
+}
+
+void OctopusReactor::uring_run_commands()
+{
+    std::vector<std::function<void()>> commands;
+    {
+        std::lock_guard<std::mutex> lock(commands_mutex_);
+        commands.swap(commands_);
+    }
+    for (auto &command : commands)
+        command();
+}
+
+uint32_t OctopusReactor::uring_poll_events(const UringWatch &watch) const
+{
+    // Data of receivers and connections of acceptors come with their own completions
+    if (watch.accept)
+        return 0;
+    uint32_t events = watch.events & ~(EPOLLET | EPOLLONESHOT | EPOLLEXCLUSIVE);
+    if (watch.receive)
+        events &= ~(EPOLLIN | EPOLLRDHUP);
+    return events;
+}
+
+void OctopusReactor::uring_add_watch(int fd, UringWatch watch)
+{
+    if (uring_watch_ids_.count(fd))
+        uring_remove_watch(fd);
+
+    uint64_t id = uring_next_id_++;
+    watch.fd = fd;
+    uring_watches_[id] = std::move(watch);
+    uring_watch_ids_[fd] = id;
+    uring_arm(id);
+}
+
+void OctopusReactor::uring_modify_watch(int fd, uint32_t events)
+{
+    auto id = uring_watch_ids_.find(fd);
+    if (id == uring_watch_ids_.end())
+        return;
+
+    UringWatch &watch = uring_watches_[id->second];
+    uint32_t armed_events = uring_poll_events(watch);
+    watch.events = events;
+    uint32_t poll_events = uring_poll_events(watch);
+    uint64_t poll_user_data = REACTOR_URING_USER_DATA(id->second, REACTOR_URING_OP_POLL);
+    if (!watch.poll_armed)
+        uring_arm(id->second);
+    else if (poll_events == 0)
+        uring_->prep_cancel(poll_user_data, REACTOR_URING_OP_CANCEL);
+    else if (poll_events != armed_events)
+        uring_->prep_poll_update(poll_user_data, poll_events, REACTOR_URING_OP_CANCEL); // A poll that fired meanwhile is re-armed with the new mask
+}
+
+void OctopusReactor::uring_remove_watch(int fd)
+{
+    auto id = uring_watch_ids_.find(fd);
+    if (id == uring_watch_ids_.end())
+        return;
+
+    // Cancelled by user_data, not by fd: the caller may close the fd and it may be reused at once
+    const UringWatch &watch = uring_watches_[id->second];
+    if (watch.poll_armed)
+        uring_->prep_cancel(REACTOR_URING_USER_DATA(id->second, REACTOR_URING_OP_POLL), REACTOR_URING_OP_CANCEL);
+    if (watch.receiving)
+        uring_->prep_cancel(REACTOR_URING_USER_DATA(id->second, watch.accept ? REACTOR_URING_OP_ACCEPT : REACTOR_URING_OP_RECEIVE), REACTOR_URING_OP_CANCEL);
+    if (!watch.sends.lengths.empty())
+        uring_->prep_cancel(REACTOR_URING_USER_DATA(id->second, REACTOR_URING_OP_SEND), REACTOR_URING_OP_CANCEL);
+    // Operations already prepared for the fd must reach the kernel while the fd is still ours
+    uring_->submit_and_wait(0);
+
+    // A send may be running (the cancel then fails with EALREADY) and reads the buffers done owns
+    // until it completes: the chain outlives the watch until every send completion is reaped
+    if (!watch.sends.lengths.empty())
+        uring_closing_sends_[id->second] = std::move(uring_watches_[id->second].sends);
+    uring_watches_.erase(id->second);
+    uring_watch_ids_.erase(id);
+}
+
+void OctopusReactor::uring_arm(uint64_t id)
+{
+    auto it = uring_watches_.find(id);
+    if (it == uring_watches_.end())
+        return;
+    UringWatch &watch = it->second;
+
+    uint32_t poll_events = uring_poll_events(watch);
+    if (!watch.poll_armed && poll_events != 0)
+        watch.poll_armed = uring_->prep_poll(watch.fd, poll_events, REACTOR_URING_USER_DATA(id, REACTOR_URING_OP_POLL));
+
+    if (!watch.receiving && watch.accept)
+        watch.receiving = uring_->prep_accept(watch.fd, REACTOR_URING_USER_DATA(id, REACTOR_URING_OP_ACCEPT));
+    else if (!watch.receiving && watch.receive && !watch.finished)
+        watch.receiving = uring_->prep_recvmsg(watch.fd, &uring_recv_msg_, REACTOR_URING_USER_DATA(id, REACTOR_URING_OP_RECEIVE));
+}
+
+bool OctopusReactor::uring_is_registered(const UringWatch &watch) const
+{
+    // remove_fd() from another thread takes effect here before its command reaches the loop
+    std::lock_guard<std::mutex> lock(handlers_mutex_);
+    auto it = handlers_.find(watch.fd);
+    return it != handlers_.end() && it->second == watch.handler;
+}
+
+void OctopusReactor::uring_handle_poll(uint64_t id, int32_t res)
+{
+    auto it = uring_watches_.find(id);
+    if (it == uring_watches_.end())
+        return;
+    UringWatch &watch = it->second;
+    watch.poll_armed = false;
+    if (!uring_is_registered(watch))
+        return;
+
+    if (res != -ECANCELED)
+    {
+        int fd = watch.fd;
+        std::shared_ptr<EventHandler> handler = watch.handler;
+        uint32_t events = (res < 0) ? EPOLLERR : static_cast<uint32_t>(res);
+        try
+        {
+            (*handler)(fd, events);
+        }
+        catch (const std::exception &e)
+        {
+            std::cerr << "[" << name_ << "] Handler for fd " << fd << " threw exception: " << e.what() << std::endl;
+        }
+    }
+
+    // Level-triggered like epoll: watch again unless the handler removed the fd
+    uring_arm(id);
+}
+
+void OctopusReactor::uring_handle_receive(uint64_t id, const OctopusUringCompletion &completion)
+{
+    int buffer_id = OctopusUring::get_buffer_id(completion.flags);
+    auto it = uring_watches_.find(id);
+    if (it == uring_watches_.end() || !uring_is_registered(it->second))
+    {
+        if (buffer_id >= 0)
+            uring_->recycle_buffer(static_cast<uint16_t>(buffer_id));
+        return;
+    }
+
+    UringWatch &watch = it->second;
+    bool more = OctopusUring::has_more(completion.flags);
+    if (!more)
+        watch.receiving = false;
+
+    int fd = watch.fd;
+    std::shared_ptr<ReceiveHandler> receive = watch.receive;
+    std::vector<int> fds;
+    try
+    {
+        bool end_of_stream = false;
+        if (completion.res > 0 && buffer_id >= 0)
+        {
+            const uint8_t *payload;
+            size_t payload_length;
+            uint8_t *buffer = uring_->get_buffer(static_cast<uint16_t>(buffer_id));
+            if (OctopusUring::parse_recvmsg(buffer, completion.res, uring_recv_msg_, &payload, &payload_length, fds))
+            {
+                if (payload_length > 0)
+                    (*receive)(fd, payload, static_cast<ssize_t>(payload_length), fds);
+                else
+                    end_of_stream = !more; // The peer closed: res only covers the recvmsg header, the receive ends
+            }
+            uring_->recycle_buffer(static_cast<uint16_t>(buffer_id));
+            if (end_of_stream)
+            {
+                watch.finished = true;
+                (*receive)(fd, nullptr, 0, fds);
+            }
+        }
+        else if (completion.res != -ENOBUFS && completion.res != -ECANCELED)
+        {
+            // 0: the peer closed, < 0: the receive failed. Either way no data follows.
+            watch.finished = true;
+            if (buffer_id >= 0)
+                uring_->recycle_buffer(static_cast<uint16_t>(buffer_id));
+            (*receive)(fd, nullptr, completion.res, fds);
+        }
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "[" << name_ << "] Receive handler for fd " << fd << " threw exception: " << e.what() << std::endl;
+    }
+    for (int passed_fd : fds)
+        close(passed_fd); // Left over by the handler
+
+    // ENOBUFS: every buffer was in use, they are all back by now
+    if (!more)
+        uring_arm(id);
+}
+
+void OctopusReactor::uring_handle_accept(uint64_t id, const OctopusUringCompletion &completion)
+{
+    auto it = uring_watches_.find(id);
+    if (it == uring_watches_.end() || !uring_is_registered(it->second))
+    {
+        if (completion.res >= 0)
+            close(completion.res);
+        return;
+    }
+
+    UringWatch &watch = it->second;
+    if (!OctopusUring::has_more(completion.flags))
+        watch.receiving = false;
+
+    int listen_fd = watch.fd;
+    std::shared_ptr<AcceptHandler> accept = watch.accept;
+    if (completion.res >= 0)
+    {
+        try
+        {
+            (*accept)(listen_fd, completion.res);
+        }
+        catch (const std::exception &e)
+        {
+            std::cerr << "[" << name_ << "] Accept handler for fd " << listen_fd << " threw exception: " << e.what() << std::endl;
+        }
+    }
+    else if (completion.res != -ECANCELED)
+    {
+        std::cerr << "[" << name_ << "] accept on fd " << listen_fd << " failed: " << strerror(-completion.res) << std::endl;
+    }
+    uring_arm(id);
+}
+
+void OctopusReactor::uring_handle_send(uint64_t id, int32_t res)
+{
+    auto it = uring_watches_.find(id);
+    if (it == uring_watches_.end())
+    {
+        // The fd was removed: release the chain, and the buffers it owns, with its last send
+        auto closing = uring_closing_sends_.find(id);
+        if (closing != uring_closing_sends_.end() && ++closing->second.completed >= closing->second.lengths.size())
+            uring_closing_sends_.erase(closing);
+        return;
+    }
+    UringSendChain &chain = it->second.sends;
+    if (chain.completed >= chain.lengths.size())
+        return;
+
+    // Completions of a chain arrive in order, the sends behind a failed one are cancelled
+    size_t index = chain.completed++;
+    if (!chain.broken)
+    {
+        if (res < 0)
+        {
+            chain.broken = true;
+            chain.error = -res;
+        }
+        else
+        {
+            chain.sent += static_cast<size_t>(res);
+            chain.broken = static_cast<size_t>(res) < chain.lengths[index];
+        }
+    }
+    if (chain.completed < chain.lengths.size())
+        return;
+
+    int fd = it->second.fd;
+    bool registered = uring_is_registered(it->second);
+    std::shared_ptr<EventHandler> handler = it->second.handler; // Keeps what it captured alive while done runs
+    SendHandler done = std::move(chain.done);
+    size_t sent = chain.sent;
+    int error = chain.error;
+    chain = UringSendChain();
+    if (!registered || !done)
+        return;
+
+    try
+    {
+        done(sent, error);
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "[" << name_ << "] Send handler for fd " << fd << " threw exception: " << e.what() << std::endl;
+    }
+}
+
+void OctopusReactor::uring_dispatch(const OctopusUringCompletion &completion)
+{
+    uint64_t id = completion.user_data >> 8;
+    switch (completion.user_data & 0xFF)
+    {
+    case REACTOR_URING_OP_WAKEUP:
+        uring_run_commands();
+        if (is_running_)
+            uring_->prep_read(wakeup_fd_, &uring_wakeup_value_, sizeof(uring_wakeup_value_), REACTOR_URING_OP_WAKEUP);
+        break;
+    case REACTOR_URING_OP_POLL:
+        uring_handle_poll(id, completion.res);
+        break;
+    case REACTOR_URING_OP_RECEIVE:
+        uring_handle_receive(id, completion);
+        break;
+    case REACTOR_URING_OP_ACCEPT:
+        uring_handle_accept(id, completion);
+        break;
+    case REACTOR_URING_OP_SEND:
+        uring_handle_send(id, completion.res);
+        break;
+    default:
+        break;
+    }
+}
+
+void OctopusReactor::uring_event_loop()
+{
+    OctopusUringCompletion completions[REACTOR_MAX_EVENTS];
+    uring_->prep_read(wakeup_fd_, &uring_wakeup_value_, sizeof(uring_wakeup_value_), REACTOR_URING_OP_WAKEUP);
+    uring_run_commands();
+
+    while (is_running_)
+    {
+        // Submit what the last round queued (re-armed polls, sends) and sleep until something
+        // completes: the only system call of a round
+        int result = uring_->submit_and_wait(1);
+        if (result < 0 && result != -EINTR && result != -EAGAIN && result != -EBUSY)
+        {
+            std::cerr << "[" << name_ << "] io_uring_enter failed: " << strerror(-result) << std::endl;
+            break;
+        }
+
+        size_t count;
+        while (is_running_ && (count = uring_->reap(completions, REACTOR_MAX_EVENTS)) > 0)
+        {
+            for (size_t i = 0; i < count && is_running_; ++i)
+                uring_dispatch(completions[i]);
+        }
+    }
+}
@@ -0,0 +1,239 @@
+/**
+ * @file octopus_ipc_reactor.hpp
+ * @brief Epoll based event loop (reactor) used by the IPC server to drive client sockets.
+ *
+ * A reactor owns one epoll instance and one thread. File descriptors are registered together
+ * with a handler which is invoked on the reactor thread whenever epoll reports an event for
+ * that descriptor. The loop blocks in epoll_wait() without a timeout, so an idle reactor does
+ * not wake up at all. An eventfd is used to interrupt the loop when the reactor is stopped.
+ *
+ * On kernels with io_uring the reactor can run on completions instead (ReactorBackend::IoUring):
+ * registered fds are watched with poll operations re-armed after each handler call, so handlers
+ * see the same level-triggered events as with epoll. On top of that, listening sockets get a
+ * multishot accept (add_acceptor()), stream sockets a multishot receive into kernel provided
+ * buffers (add_receiver()) and writes are queued as linked sends (submit_sends()). Everything a
+ * round of handlers queued is submitted with the wait for the next completions: one system call
+ * per loop round instead of one per read and write. If io_uring cannot be set up, the reactor
+ * runs on epoll and says so.
+ *
+ * With io_uring the ring is only touched by the reactor thread: registrations made from other
+ * threads are handed over to it through the eventfd.
+ *
+ * @author ak47
+ * @date 2026-10-16
+ */
+#ifndef OCTOPUS_IPC_REACTOR_HPP
+#define OCTOPUS_IPC_REACTOR_HPP
+
+#include <string>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+class OctopusUring;
+struct OctopusUringCompletion;
+
+// How a reactor learns about its file descriptors
+enum class ReactorBackend
+{
+    Epoll,  // epoll_wait() readiness, the handlers read and write themselves
+    IoUring // io_uring completions, falls back to Epoll where io_uring is unavailable
+};
+
+/**
+ * @class OctopusReactor
+ * @brief Single threaded epoll event loop dispatching fd events to registered handlers.
+ */
+class OctopusReactor
+{
+public:
+    /**
+     * @brief Handler invoked on the reactor thread.
+     * @param fd The file descriptor the event belongs to.
+     * @param events The epoll event mask (EPOLLIN, EPOLLOUT, EPOLLHUP ...).
+     */
+    using EventHandler = std::function<void(int fd, uint32_t events)>;
+
+    /**
+     * @brief Handler of a connection accepted by add_acceptor(), invoked on the reactor thread.
+     * @param listen_fd The listening socket.
+     * @param client_fd The accepted socket (blocking, close-on-exec), owned by the handler.
+     */
+    using AcceptHandler = std::function<void(int listen_fd, int client_fd)>;
+
+    /**
+     * @brief Handler of data received by add_receiver(), invoked on the reactor thread.
+     * @param fd The socket.
+     * @param data The received bytes, only valid during the call.
+     * @param length Number of bytes, 0 once the peer closed, -errno on failure.
+     * @param fds File descriptors passed along the bytes (SCM_RIGHTS), the handler takes them.
+     */
+    using ReceiveHandler = std::function<void(int fd, const uint8_t *data, ssize_t length, std::vector<int> &fds)>;
+
+    /**
+     * @brief Handler of a send chain submitted with submit_sends(), invoked on the reactor thread.
+     * @param sent Bytes written, in order from the first buffer.
+     * @param error 0 if every buffer was written, otherwise the errno of the failed send.
+     */
+    using SendHandler = std::function<void(size_t sent, int error)>;
+
+    OctopusReactor();
+
+    /**
+     * @brief Stops the event loop and releases the epoll instance.
+     */
+    ~OctopusReactor();
+
+    /**
+     * @brief Creates the epoll instance (or io_uring) and starts the reactor thread.
+     * @param name Name used in log messages.
+     * @param backend Requested backend, see get_backend() for the one actually used.
+     * @return true if the reactor is running.
+     */
+    bool start(const std::string &name, ReactorBackend backend = ReactorBackend::Epoll);
+
+    /**
+     * @brief Stops the reactor thread and waits for it to exit.
+     */
+    void stop();
+
+    /**
+     * @brief Registers a file descriptor with the reactor.
+     * @param fd File descriptor to watch (should be non-blocking).
+     * @param events Epoll event mask to watch for.
+     * @param handler Handler to invoke when an event is reported.
+     * @return true on success.
+     */
+    bool add_fd(int fd, uint32_t events, EventHandler handler);
+
+    /**
+     * @brief Changes the event mask of an already registered file descriptor.
+     */
+    bool modify_fd(int fd, uint32_t events);
+
+    /**
+     * @brief Unregisters a file descriptor. Does not close it.
+     */
+    void remove_fd(int fd);
+
+    /**
+     * @brief Accepts connections on a listening socket and hands them to handler.
+     *
+     * io_uring: one multishot accept, no readiness round trip. Epoll: accept4() once the socket
+     * is readable, the listening socket is switched to non-blocking.
+     */
+    bool add_acceptor(int listen_fd, AcceptHandler handler);
+
+    /**
+     * @brief Registers a stream socket whose data is received by the reactor (io_uring only).
+     *
+     * A multishot receive into provided buffers replaces EPOLLIN: data arrives through receive,
+     * the other events of events (EPOLLOUT) reach handler like with add_fd(). modify_fd() and
+     * remove_fd() apply as usual.
+     *
+     * @return false with the epoll backend, the caller then uses add_fd() and reads itself.
+     */
+    bool add_receiver(int fd, uint32_t events, EventHandler handler, ReceiveHandler receive);
+
+    /**
+     * @brief Writes buffers in order with linked sends, submitted with the next loop round.
+     *
+     * Reactor thread and io_uring backend only. One chain per fd at a time. The buffers must stay
+     * valid until the kernel completed every send of the chain, so done should own them: the reactor
+     * keeps done until then. If the fd is removed first, the sends are cancelled and done is destroyed
+     * without being invoked once their completions arrived.
+     *
+     * @return false if the chain could not be queued (nothing was sent).
+     */
+    bool submit_sends(int fd, const iovec *iov, size_t count, SendHandler done);
+
+    /**
+     * @brief The backend the reactor runs on.
+     */
+    ReactorBackend get_backend() const { return backend_; }
+
+    /**
+     * @brief Get the number of file descriptors currently registered.
+     */
+    size_t get_fd_count() const;
+
+    /**
+     * @brief Returns true when called from this reactor's own thread.
+     */
+    bool is_in_loop_thread() const;
+
+private:
+    /**
+     * @brief Main loop executed by the reactor thread.
+     */
+    void event_loop();
+
+    // io_uring backend, every uring_ member is only touched by the reactor thread
+    struct UringSendChain
+    {
+        std::vector<size_t> lengths; ///< Length of each linked send
+        size_t completed = 0;        ///< Sends completed (or cancelled) so far
+        size_t sent = 0;             ///< Bytes written by the completed sends
+        bool broken = false;         ///< A send fell short or failed, the rest is cancelled
+        int error = 0;               ///< errno of the failed send
+        SendHandler done;
+    };
+
+    struct UringWatch
+    {
+        int fd = -1;
+        uint32_t events = 0;          ///< Requested epoll event mask
+        bool poll_armed = false;      ///< A poll operation is in flight
+        bool receiving = false;       ///< A multishot receive (or accept) is in flight
+        bool finished = false;        ///< The peer closed or the receive failed, not re-armed
+        std::shared_ptr<EventHandler> handler;
+        std::shared_ptr<ReceiveHandler> receive; ///< Set for add_receiver()
+        std::shared_ptr<AcceptHandler> accept;   ///< Set for add_acceptor()
+        UringSendChain sends;                    ///< Chain in flight, if sends.lengths is not empty
+    };
+
+    bool start_uring();
+    void uring_event_loop();
+    void run_in_loop(std::function<void()> command);
+    void uring_run_commands();
+    void uring_add_watch(int fd, UringWatch watch);
+    void uring_modify_watch(int fd, uint32_t events);
+    void uring_remove_watch(int fd);
+    void uring_arm(uint64_t id);
+    bool uring_is_registered(const UringWatch &watch) const;
+    void uring_dispatch(const OctopusUringCompletion &completion);
+    void uring_handle_poll(uint64_t id, int32_t res);
+    void uring_handle_receive(uint64_t id, const OctopusUringCompletion &completion);
+    void uring_handle_accept(uint64_t id, const OctopusUringCompletion &completion);
+    void uring_handle_send(uint64_t id, int32_t res);
+    uint32_t uring_poll_events(const UringWatch &watch) const;
+
+    std::string name_;           ///< Name used in log messages
+    int epoll_fd_;               ///< Epoll instance owned by this reactor
+    int wakeup_fd_;              ///< Eventfd used to interrupt epoll_wait() on stop
+    std::thread loop_thread_;    ///< Reactor thread
+    std::atomic<bool> is_running_; ///< Loop running state
+
+    mutable std::mutex handlers_mutex_;                                   ///< Protects handlers_
+    std::unordered_map<int, std::shared_ptr<EventHandler>> handlers_; ///< Registered fd handlers
+
+    ReactorBackend backend_;                            ///< Backend in use
+    std::unique_ptr<OctopusUring> uring_;               ///< io_uring instance of the IoUring backend
+    std::mutex commands_mutex_;                         ///< Protects commands_
+    std::vector<std::function<void()>> commands_;       ///< Registrations waiting for the reactor thread
+    std::unordered_map<uint64_t, UringWatch> uring_watches_; ///< Watched fds keyed by registration id
+    std::unordered_map<int, uint64_t> uring_watch_ids_;  ///< Registration id of each watched fd
+    std::unordered_map<uint64_t, UringSendChain> uring_closing_sends_; ///< Chains of removed fds waiting for their completions
+    uint64_t uring_next_id_;                            ///< Next registration id
+    uint64_t uring_wakeup_value_;                       ///< Read target of the eventfd
+    msghdr uring_recv_msg_;                             ///< Template of the multishot receives
+};
+
+#endif // OCTOPUS_IPC_REACTOR_HPP
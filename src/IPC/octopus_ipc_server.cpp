@@ -1,22 +1,57 @@
 /*////////////////////////////////////////////////////////////////////////////////////////////////////
  * File: octopus_ipc_server.cpp
  * Description:
- *  This file implements a simple multi-threaded IPC server that listens for client connections
- *  over a Unix domain socket. It supports basic arithmetic operations such as addition, subtraction,
- *  multiplication, and division. Each client connection is handled in a separate thread to allow
- *  simultaneous connections. The server also ensures the socket directory exists and removes old
- *  socket files before starting up.
+ *  This file implements a simple IPC server that listens for client connections over a Unix domain
+ *  socket. It supports basic arithmetic operations such as addition, subtraction, multiplication,
+ *  and division. Accepted client connections are switched to non-blocking mode and driven by a set
+ *  of epoll reactor threads (one per core by default), so idle clients cost neither a thread nor
+ *  periodic wakeups. Each reactor owns a shard of the clients together with its own client table
+ *  and locks. The server also ensures the socket directory exists and removes old socket files
+ *  before starting up.
  *
  * Includes:
  *  - A socket server class that manages the opening, binding, listening, and communication with clients.
- *  - Mutexes to ensure thread safety when modifying shared resources like active client connections.
+ *  - An epoll reactor (OctopusReactor) that dispatches readable client sockets to the handlers.
+ *  - A bounded outbound queue per client, flushed on EPOLLOUT, so a slow client never blocks a sender.
+ *  - A topic index per shard, so a push only reaches the clients subscribed to its (group, msg).
+ *  - Per-client, per-topic push intervals: OTSM runs at the fastest requested rate, a timer wheel
+ *    decimates the state pushes of every slower client.
+ *  - Change detection: an unchanged carinfo snapshot is not fanned out again, except to clients
+ *    that never received it or asked for periodic keyframes.
+ *  - A read-only shared memory snapshot region (seqlock per slot): local clients may read the latest
+ *    carinfo / MCU state without a socket round trip.
+ *  - A shared memory broadcast ring: every push frame is written once, clients reading the ring
+ *    follow it with their own cursor and are left out of the socket fan-out.
+ *  - An optional shared memory transport per client (memfd SPSC rings, eventfd wakeups), negotiated
+ *    over the socket which then stays as the control channel.
+ *  - A SOCK_SEQPACKET endpoint next to the stream one: its clients get one whole frame per packet,
+ *    parsed in place without reassembly.
+ *  - An optional io_uring backend (--backend io_uring): multishot accepts, multishot receives into
+ *    kernel provided buffers and linked sends, one io_uring_enter() per reactor round. Falls back
+ *    to epoll where io_uring is unavailable.
+ *  - Request ids (extended frame header 0xA5A6): a request carrying one gets exactly one framed reply
+ *    echoing it, so a client may pipeline requests on one socket and tell replies from pushes.
+ *  - Batch GETs (MSG_IPC_CMD_CAR_GET_BATCH): several carinfo snapshots in one reply frame, read as
+ *    one consistent cut by checking the snapshot versions after the copies.
+ *  - Conditional GETs (MSG_IPC_CMD_CAR_GET_IF_MODIFIED): carinfo snapshot versions only advance on
+ *    a change, a client holding the current version gets a small NOT_MODIFIED frame.
+ *  - Container frames (header 0xA5A7) for clients opting in (MSG_IPC_CMD_CONFIG_CONTAINER): the frames
+ *    queued to such a client during a burst (one push drain, the replies to one read) are packed
+ *    into containers and written once. --container-window-us gathers the pushes of a whole OTSM tick.
+ *  - Large payloads received as sealed memfds (SCM_RIGHTS) next to a small descriptor frame, mapped
+ *    read-only instead of being streamed through the socket.
+ *  - A lock-free handoff of OTSM pushes: the OTSM callback only queues a record and signals an
+ *    eventfd, a push dispatcher thread does the serialization and the socket I/O.
+ *  - Tear-free OTSM state: the OTSM callback copies the pushed struct while OTSM is not modifying
+ *    it into a double-buffered snapshot exchange, every other thread reads consistent copies.
+ *  - Per-shard mutexes to ensure thread safety when modifying shared resources like active client connections.
  *  - Signal handling for graceful cleanup upon interrupt.
  *
  * Compilation:
  *  This file requires the following libraries:
  *   - <mutex>        : For thread synchronization using mutexes.
  *   - <atomic>       : For atomic operations (unused in this example, can be added later).
- *   - <unordered_set>: For storing active client connections in a set.
+ *   - <unordered_set>: For storing the topics a client subscribed to.
  *   - <sys/stat.h>   : For checking and creating directories.
  *   - <unistd.h>     : For removing old socket files.
  *   - <iostream>     : For logging messages to the console.
@@ -29,13 +64,29 @@
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 #include <mutex>
 #include <atomic>
+#include <unordered_map>
 #include <unordered_set>
+#include <deque>
 #include <algorithm>
+#include <chrono>
 #include <dlfcn.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <poll.h>
 
 #include "octopus_logger.hpp"
 #include "octopus_ipc_socket.hpp"
 #include "octopus_ipc_ptl.hpp"
+#include "octopus_ipc_reactor.hpp"
+#include "octopus_ipc_frame_decoder.hpp"
+#include "octopus_ipc_outbound_queue.hpp"
+#include "octopus_ipc_lockfree_queue.hpp"
+#include "octopus_ipc_timer_wheel.hpp"
+#include "octopus_ipc_shm_snapshot.hpp"
+#include "octopus_ipc_shm_ring.hpp"
+#include "octopus_ipc_shm_broadcast.hpp"
+#include "octopus_ipc_large_payload.hpp"
+#include "octopus_ipc_snapshot_exchange.hpp"
 
 #include "../OTSM/octopus_vehicle.h"
 #include "../OTSM/octopus_task_manager.h"
@@ -74,30 +125,225 @@ T_otsm_flash_get_meta_infor otsm_get_mcu_flash_meta_infor = NULL;
 T_otsm_get_mcu_upgrade_progress_info otsm_get_mcu_upgrade_progress_info = NULL;
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 // Function to handle client communication
+struct IpcConnection;
 template <typename T>
-void ipc_server_send_message_to_client(int client_fd, int msg_grp, int msg_id, T *t_info, size_t size, const std::string &info_type);
+bool ipc_server_send_message_to_client(int client_fd, int msg_grp, int msg_id, T *t_info, size_t size, const std::string &info_type, bool conflatable = true, uint32_t request_id = 0);
+bool ipc_server_send_to_client(int client_fd, const OutboundFrame &frame, int conflate_key);
+bool ipc_server_enqueue_frame(IpcConnection &connection, const OutboundFrame &frame, int conflate_key, bool latest_value = false);
+void ipc_server_broadcast_frame(int msg_grp, int msg_id, const OutboundFrame &frame, int conflate_key, bool changed = true);
+void ipc_server_send_response(int client_fd, const DataMessageView &query_msg, const std::vector<int> &resp_vector);
+void ipc_server_send_reply(int client_fd, const DataMessageView &query_msg, const uint8_t *data, size_t length);
 void ipc_server_message_data_callback(uint16_t msg_grp, uint16_t msg_id, const uint8_t *data, uint16_t length);
-void ipc_server_notify_car_infor_to_client(int client_fd, int msg_grp, int msg_id, const uint8_t *data, uint16_t length);
-void ipc_server_notify_mcu_infor_to_client(int client_fd, int msg_grp, int msg_id, const uint8_t *data, uint16_t length);
-void ipc_server_handle_client_event(int client_fd);
-
-int ipc_server_handle_calculation_event(int client_fd, const DataMessage &query_msg);
-int ipc_server_handle_help_event(int client_fd, const DataMessage &query_msg);
-int ipc_server_handle_config_event(int client_fd, const DataMessage &query_msg);
-int ipc_server_handle_car_event(int client_fd, const DataMessage &query_msg);
-int ipc_server_handle_mcu_event(int client_fd, const DataMessage &query_msg);
+void ipc_server_dispatch_push(uint16_t msg_grp, uint16_t msg_id, const uint8_t *data, uint16_t length);
+bool ipc_server_notify_car_infor_to_client(int client_fd, int msg_grp, int msg_id, const uint8_t *data, uint16_t length, uint32_t request_id = 0);
+bool ipc_server_notify_mcu_infor_to_client(int client_fd, int msg_grp, int msg_id, const uint8_t *data, uint16_t length, uint32_t request_id = 0);
+void ipc_server_handle_client_event(const std::shared_ptr<IpcConnection> &connection, uint32_t events);
+void ipc_server_claim_passed_fds(IpcConnection &connection, std::vector<int> &received_fds);
+void ipc_server_dispatch_message(int client_fd, const DataMessageView &data_message);
+void ipc_server_close_client(const std::shared_ptr<IpcConnection> &connection);
+void ipc_server_flush_client(IpcConnection &connection);
+void ipc_server_end_flush_burst();
+void ipc_server_flush_deferred_clients(std::vector<int> &fds, bool IpcConnection::*deferred);
+bool ipc_server_submit_sends(IpcConnection &connection);
+void ipc_server_complete_sends(IpcConnection &connection, const std::vector<OutboundFrame> &frames, size_t offset, size_t sent, int error);
+void ipc_server_handle_client_data(const std::shared_ptr<IpcConnection> &connection, const uint8_t *data, ssize_t length, std::vector<int> &received_fds);
+void ipc_server_handle_shm_event(const std::shared_ptr<IpcConnection> &connection);
+void ipc_server_update_otsm_push_interval();
+
+int ipc_server_handle_calculation_event(int client_fd, const DataMessageView &query_msg);
+int ipc_server_handle_help_event(int client_fd, const DataMessageView &query_msg);
+int ipc_server_handle_config_event(int client_fd, const DataMessageView &query_msg);
+int ipc_server_handle_car_event(int client_fd, const DataMessageView &query_msg);
+int ipc_server_handle_mcu_event(int client_fd, const DataMessageView &query_msg);
+int ipc_server_handle_large_payload_event(int client_fd, const DataMessageView &query_msg);
 
 // Path for the IPC socket file
-const char *socket_path = "/tmp/octopus/ipc_socket";
+const char *socket_path = IPC_SOCKET_STREAM_PATH;
+// Path of the message boundary preserving endpoint
+const char *seqpacket_socket_path = IPC_SOCKET_SEQPACKET_PATH;
+// Pseudo client fd for the notify functions: send to every client with push enabled
+#define IPC_SERVER_BROADCAST_FD (-1)
+
+// A topic is a (group, msg) pair packed into 16 bits, MSG_IPC_TOPIC_ANY acts as wildcard
+#define IPC_SERVER_TOPIC_KEY(grp, id) static_cast<uint16_t>(((grp) & 0xFF) << 8 | ((id) & 0xFF))
+// Topic of clients with the legacy push flag set: every group, every message
+#define IPC_SERVER_TOPIC_ALL IPC_SERVER_TOPIC_KEY(MSG_IPC_TOPIC_ANY, MSG_IPC_TOPIC_ANY)
 // Server object to handle socket operations
 Socket server;
-// Mutex for server operations to ensure thread-safety
-std::mutex server_mutex;
-// Mutex for client operations to ensure thread-safety
-std::mutex clients_mutex;
 int socket_fd_server = -1;
-// Thread-safe unordered set for active clients
-std::unordered_set<ClientInfo> active_clients;
+Socket server_seqpacket; // Listens on seqpacket_socket_path
+int socket_fd_server_seqpacket = -1;
+
+// Outbound queue configuration, see ipc_server_parse_arguments()
+size_t outbound_queue_max_bytes = 64 * 1024;
+SlowConsumerPolicy outbound_queue_policy = SlowConsumerPolicy::DropOldest;
+// Backend of the client reactors, see ipc_server_parse_arguments()
+ReactorBackend server_reactor_backend = ReactorBackend::Epoll;
+// Time the push dispatcher gathers pushes for container clients, see ipc_server_parse_arguments()
+uint32_t container_window_us = 0;
+std::atomic<int> container_clients{0}; // Connected clients unpacking container frames
+
+// Counters for every outbound queue outcome, summed over all clients
+struct IpcOutboundCounters
+{
+    std::atomic<uint64_t> frames_queued{0};         // Frames accepted without dropping anything
+    std::atomic<uint64_t> frames_dropped_oldest{0}; // Old frames dropped to make room (DropOldest)
+    std::atomic<uint64_t> frames_dropped_newest{0}; // New frames discarded because they did not fit
+    std::atomic<uint64_t> frames_conflated{0};      // Queued frames replaced by a newer value (mailbox or Conflate)
+    std::atomic<uint64_t> connections_dropped{0};   // Slow clients disconnected (DropConnection)
+};
+IpcOutboundCounters outbound_counters;
+
+// Push state of one state topic for one client, only touched by the push dispatcher thread
+struct IpcPushThrottle
+{
+    uint64_t next_due_ms = 0;       // Earliest time the next frame may be queued
+    uint32_t interval_ms = 0;       // Interval in effect for the topic
+    OutboundFrame pending;          // Latest frame held back until next_due_ms
+    bool timer_armed = false;       // A wheel timer delivers pending at next_due_ms
+    bool published = false;         // The client got (or is about to get) a snapshot of the topic
+    uint64_t last_published_ms = 0; // When the last snapshot of the topic was handed to the client
+};
+
+// State of one connected client
+struct IpcConnection
+{
+    IpcConnection(int fd, const std::string &ip, bool flag)
+        : info(fd, ip, flag), outbound(outbound_queue_max_bytes, outbound_queue_policy) {}
+
+    ClientInfo info;             // Client identity and push flag, guarded by the shard clients_mutex
+    std::unordered_set<uint16_t> topics; // Subscribed topic keys, guarded by the shard clients_mutex
+    bool implicit_all = false;           // Subscribed to everything by the initial push flag only, guarded by the shard clients_mutex
+    uint32_t push_interval_ms = 0;       // Default push interval (0: every update), guarded by the shard clients_mutex
+    uint32_t keyframe_interval_ms = 0;   // Resend unchanged snapshots this often (0: never), guarded by the shard clients_mutex
+    std::unordered_map<uint16_t, uint32_t> topic_intervals; // Push interval per topic key, guarded by the shard clients_mutex
+    std::unordered_map<int, IpcPushThrottle> throttles;     // Per topic rate limit state, push dispatcher thread only
+    FrameDecoder decoder;        // Receive stream decoder, only touched by the reactor thread
+    std::mutex send_mutex;       // Guards outbound, epollout_armed and closed
+    OutboundQueue outbound;      // Frames waiting for the socket to become writable
+    bool epollout_armed = false; // EPOLLOUT is part of the epoll interest set
+    bool closed = false;         // The fd is closed and must not be written any more
+    std::unique_ptr<OctopusShmChannel> shm_channel; // Shared memory transport once negotiated, set under send_mutex,
+                                                    // its rx side is only touched by the reactor thread
+    FrameDecoder shm_decoder;                       // Decoder of the shared memory rx ring, reactor thread only
+    bool broadcast_ring = false; // Reads pushes from the broadcast ring, not the socket, guarded by the shard clients_mutex
+    std::deque<int> passed_fds;  // Received file descriptors not claimed by a descriptor frame yet, reactor thread only
+    bool seqpacket = false;      // Accepted on the SOCK_SEQPACKET endpoint, set before the reactor watches the fd
+    bool uring_receiver = false; // Data arrives through io_uring receives, set before the reactor watches the fd
+    bool sends_in_flight = false; // Linked io_uring sends own the front frames, guarded by send_mutex
+    bool containers = false;      // The client unpacks container frames, guarded by send_mutex
+    bool flush_deferred = false;  // Frames queued during a flush burst wait for its end, guarded by send_mutex
+    bool window_deferred = false; // Pushes wait for the end of the container window, guarded by send_mutex
+};
+
+#define IPC_SERVER_MAX_PASSED_FDS 16 // Unclaimed file descriptors a client may leave with the server
+#define IPC_SERVER_READ_BUDGET (256 * 1024) // Bytes read from one client per wakeup, the rest waits for the next round
+#define IPC_SERVER_URING_MAX_SENDS 32        // Frames handed to one chain of linked io_uring sends
+#define IPC_SERVER_BATCH_MAX_ATTEMPTS 8      // Reads of a batch GET before a cut racing OTSM is replied anyway
+
+// Uncomment to run the push path inline on the OTSM thread again, to compare callback durations only:
+// push intervals are then applied off the push dispatcher thread
+// #define IPC_SERVER_PUSH_INLINE
+
+#define IPC_PUSH_QUEUE_CAPACITY 1024 // OTSM pushes buffered between the OTSM thread and the push dispatcher
+#define IPC_PUSH_RECORD_DATA_MAX 48  // Largest payload carried by a push record (key events)
+
+// One OTSM push handed over from the OTSM thread to the push dispatcher
+struct IpcPushRecord
+{
+    uint16_t msg_grp;
+    uint16_t msg_id;
+    uint16_t length;
+    uint8_t data[IPC_PUSH_RECORD_DATA_MAX];
+};
+
+OctopusLockFreeQueue<IpcPushRecord> push_queue(IPC_PUSH_QUEUE_CAPACITY);
+OctopusReactor push_reactor;                  // Push dispatcher thread, drains push_queue
+int push_event_fd = -1;                       // Signalled by the OTSM callback when records are queued
+std::atomic<bool> push_signal_pending{false}; // push_event_fd was signalled and not drained yet
+
+#define IPC_PUSH_WHEEL_TICK_MS 10   // Resolution of the push interval timers
+#define IPC_PUSH_WHEEL_SLOTS 512    // One wheel revolution covers 5.12 s
+#define IPC_OTSM_DEFAULT_PUSH_INTERVAL_MS 100 // OTSM's own push interval, restored once no client requests one
+
+int push_timer_fd = -1;             // Ticks the push timer wheel while timers are armed
+bool push_timer_ticking = false;    // push_timer_fd is armed, push dispatcher thread only
+std::unique_ptr<OctopusTimerWheel> push_timer_wheel; // Push interval timers, push dispatcher thread only
+int push_window_fd = -1;            // Ends the container window, the container clients held back are flushed then
+bool push_window_armed = false;     // push_window_fd is armed, push dispatcher thread only
+std::vector<int> push_window_fds;   // Container clients whose flush waits for the window, push dispatcher thread only
+std::mutex otsm_push_interval_mutex; // Serializes OTSM push interval updates
+uint32_t otsm_push_interval_ms = 0;  // Interval last requested from OTSM, 0 while OTSM runs at its own rate
+uint32_t otsm_default_push_interval_ms = IPC_OTSM_DEFAULT_PUSH_INTERVAL_MS; // See ipc_server_parse_arguments()
+
+// Depth of the flush bursts open on this thread, and the clients whose flush they hold back
+thread_local int flush_burst_depth = 0;
+thread_local std::vector<int> flush_burst_fds;
+// Set while the push dispatcher drains inside a container window: container clients wait for its end
+thread_local std::vector<int> *flush_window_fds = nullptr;
+
+/**
+ * @brief Scope in which queued frames are not written right away.
+ *
+ * Opened around a push drain or the dispatch of the frames of one read. Each client held back
+ * gets one write at the end: a gathered writev(), packed into containers if it supports them.
+ */
+struct IpcFlushBurst
+{
+    IpcFlushBurst() { flush_burst_depth++; }
+    ~IpcFlushBurst()
+    {
+        if (--flush_burst_depth == 0 && !flush_burst_fds.empty())
+            ipc_server_end_flush_burst();
+    }
+};
+
+// OTSM callback statistics, see ipc_server_print_push_counters()
+struct IpcPushCounters
+{
+    std::atomic<uint64_t> callbacks{0};         // OTSM callback invocations
+    std::atomic<uint64_t> callback_total_ns{0}; // Total time spent inside the callback
+    std::atomic<uint64_t> callback_max_ns{0};   // Longest single callback
+    std::atomic<uint64_t> records_dropped{0};   // Records lost because the queue was full or the payload too large
+    std::atomic<uint64_t> snapshots_changed{0};   // State snapshots that differed from the last published one
+    std::atomic<uint64_t> snapshots_unchanged{0}; // State snapshots identical to the last published one
+    std::atomic<uint64_t> fanout_frames{0};       // Push frames handed to clients
+    std::atomic<uint64_t> fanout_bytes{0};        // Push bytes handed to clients
+    std::atomic<uint64_t> fanout_suppressed{0};   // Push frames not sent to a client because nothing changed
+    std::atomic<uint64_t> ring_frames{0};         // Push frames written to the broadcast ring
+    std::atomic<uint64_t> ring_oversized{0};      // Push frames too large for a broadcast ring slot
+};
+IpcPushCounters push_counters;
+
+// Consistent copies of the live OTSM state structs, captured on the OTSM thread, read without locks
+OctopusSnapshotExchange<carinfo_meter_t> otsm_meter_exchange;
+OctopusSnapshotExchange<carinfo_indicator_t> otsm_indicator_exchange;
+OctopusSnapshotExchange<carinfo_battery_t> otsm_battery_exchange;
+OctopusSnapshotExchange<carinfo_error_t> otsm_error_exchange;
+OctopusSnapshotExchange<flash_meta_infor_t> otsm_flash_meta_exchange;
+OctopusSnapshotExchange<mcu_update_progress_t> otsm_upgrade_progress_exchange;
+std::mutex otsm_state_write_mutex; // Held while the server writes into a live OTSM struct (SET commands)
+
+// Change detection of state pushes, see ipc_server_parse_arguments()
+bool push_change_detection = true;
+// Last published frame per state topic (conflate key), push dispatcher thread only
+std::unordered_map<int, OutboundFrame> push_last_snapshots;
+// Shared memory copy of the published state, written by the push dispatcher thread only
+OctopusShmSnapshotWriter push_shm_snapshots;
+// Shared memory broadcast ring of push frames, written by the push dispatcher thread only
+OctopusShmBroadcastWriter push_broadcast_ring;
+
+// A shard is one reactor thread together with the clients it drives.
+// Clients are assigned to a shard at accept time (client_fd % shard count), so any thread
+// can find the owning shard of a fd without taking a global lock.
+struct IpcServerShard
+{
+    OctopusReactor reactor;                                          // Reactor driving the client sockets of this shard
+    std::mutex clients_mutex;                                        // Mutex for client operations to ensure thread-safety
+    std::unordered_map<int, std::shared_ptr<IpcConnection>> clients; // Active clients of this shard keyed by fd
+    std::unordered_map<uint16_t, std::vector<std::shared_ptr<IpcConnection>>> topic_subscribers; // Topic key -> subscribed clients
+};
+std::vector<std::unique_ptr<IpcServerShard>> server_shards;
 
 bool ipc_server_socket_debug_print_data = false;
 // Initialize the global thread pool object
@@ -106,89 +352,275 @@ bool ipc_server_socket_debug_print_data = false;
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 // **Thread-Safe Functions**
-void ipc_server_add_client(int fd, const std::string &ip, bool flag)
+IpcServerShard &ipc_server_get_shard(int fd)
+{
+    return *server_shards[static_cast<size_t>(fd) % server_shards.size()];
+}
+
+void ipc_server_create_shards(size_t shard_count)
+{
+    server_shards.clear();
+    for (size_t i = 0; i < std::max<size_t>(shard_count, 1); ++i)
+    {
+        server_shards.emplace_back(new IpcServerShard());
+    }
+}
+
+void ipc_server_add_client(const std::shared_ptr<IpcConnection> &connection)
+{
+    IpcServerShard &shard = ipc_server_get_shard(connection->info.fd);
+    std::lock_guard<std::mutex> lock(shard.clients_mutex);
+    shard.clients[connection->info.fd] = connection;
+
+    // A client with the push flag set starts subscribed to everything, until it subscribes something explicitly
+    if (connection->info.flag && connection->topics.insert(IPC_SERVER_TOPIC_ALL).second)
+    {
+        shard.topic_subscribers[IPC_SERVER_TOPIC_ALL].push_back(connection);
+        connection->implicit_all = true;
+    }
+}
+
+std::shared_ptr<IpcConnection> ipc_server_find_client(int fd)
+{
+    IpcServerShard &shard = ipc_server_get_shard(fd);
+    std::lock_guard<std::mutex> lock(shard.clients_mutex);
+    auto it = shard.clients.find(fd);
+    return (it != shard.clients.end()) ? it->second : nullptr;
+}
+
+// Must be called with shard.clients_mutex held
+void ipc_server_unindex_topic(IpcServerShard &shard, const std::shared_ptr<IpcConnection> &connection, uint16_t topic)
 {
-    std::lock_guard<std::mutex> lock(clients_mutex);
-    active_clients.insert(ClientInfo(fd, ip, flag));
+    auto it = shard.topic_subscribers.find(topic);
+    if (it == shard.topic_subscribers.end())
+        return;
+
+    std::vector<std::shared_ptr<IpcConnection>> &subscribers = it->second;
+    subscribers.erase(std::remove(subscribers.begin(), subscribers.end(), connection), subscribers.end());
+    if (subscribers.empty())
+        shard.topic_subscribers.erase(it);
 }
 
 void ipc_server_remove_client(int fd)
 {
-    std::lock_guard<std::mutex> lock(clients_mutex);
-    for (auto it = active_clients.begin(); it != active_clients.end(); ++it)
+    IpcServerShard &shard = ipc_server_get_shard(fd);
+    std::lock_guard<std::mutex> lock(shard.clients_mutex);
+
+    auto it = shard.clients.find(fd);
+    if (it == shard.clients.end())
+        return;
+
+    for (uint16_t topic : it->second->topics)
+        ipc_server_unindex_topic(shard, it->second, topic);
+    shard.clients.erase(it);
+}
+
+/**
+ * @brief Adds or removes one topic subscription of a client.
+ *
+ * @param fd The client file descriptor.
+ * @param msg_grp Group of the topic, MSG_IPC_TOPIC_ANY for every group.
+ * @param msg_id Message of the topic, MSG_IPC_TOPIC_ANY for every message of the group.
+ * @param subscribe true to subscribe, false to unsubscribe.
+ * @return false if the client is unknown.
+ */
+bool ipc_server_subscribe_client(int fd, uint8_t msg_grp, uint8_t msg_id, bool subscribe)
+{
+    IpcServerShard &shard = ipc_server_get_shard(fd);
+    std::lock_guard<std::mutex> lock(shard.clients_mutex); // 线程安全
+
+    auto it = shard.clients.find(fd);
+    if (it == shard.clients.end())
     {
-        if (it->fd == fd)
-        {
-            active_clients.erase(it);
-            break;
-        }
+        std::cerr << "Client FD not found: " << fd << std::endl;
+        return false;
+    }
+
+    const std::shared_ptr<IpcConnection> &connection = it->second;
+    uint16_t topic = IPC_SERVER_TOPIC_KEY(msg_grp, msg_id);
+
+    // The first explicit subscription replaces the everything subscription the connection started with,
+    // otherwise it would still receive every push
+    if (subscribe && topic != IPC_SERVER_TOPIC_ALL && connection->implicit_all)
+    {
+        if (connection->topics.erase(IPC_SERVER_TOPIC_ALL) > 0)
+            ipc_server_unindex_topic(shard, connection, IPC_SERVER_TOPIC_ALL);
+        connection->info.flag = false;
+    }
+    if (topic == IPC_SERVER_TOPIC_ALL || subscribe)
+        connection->implicit_all = false;
+
+    if (subscribe)
+    {
+        if (connection->topics.insert(topic).second)
+            shard.topic_subscribers[topic].push_back(connection);
     }
+    else if (connection->topics.erase(topic) > 0)
+    {
+        ipc_server_unindex_topic(shard, connection, topic);
+    }
+
+    if (topic == IPC_SERVER_TOPIC_ALL)
+        connection->info.flag = subscribe;
+    return true;
 }
 
-void ipc_server_print_active_clients()
+void ipc_server_print_outbound_counters()
+{
+    std::cout << "Server outbound queues: limit " << outbound_queue_max_bytes << " bytes"
+              << " | queued " << outbound_counters.frames_queued
+              << " | dropped oldest " << outbound_counters.frames_dropped_oldest
+              << " | dropped newest " << outbound_counters.frames_dropped_newest
+              << " | conflated " << outbound_counters.frames_conflated
+              << " | connections dropped " << outbound_counters.connections_dropped << std::endl;
+}
+
+void ipc_server_print_push_counters()
 {
-    std::lock_guard<std::mutex> lock(clients_mutex);
+    uint64_t callbacks = push_counters.callbacks;
+    uint64_t average_ns = callbacks ? push_counters.callback_total_ns / callbacks : 0;
+    std::cout << "Server OTSM callbacks: " << callbacks
+#ifdef IPC_SERVER_PUSH_INLINE
+              << " (inline)"
+#endif
+              << " | avg " << average_ns / 1000.0 << " us"
+              << " | max " << push_counters.callback_max_ns / 1000.0 << " us"
+              << " | records dropped " << push_counters.records_dropped << std::endl;
+    std::cout << "Server push snapshots: changed " << push_counters.snapshots_changed
+              << " | unchanged " << push_counters.snapshots_unchanged
+              << " | fan-out " << push_counters.fanout_frames << " frames " << push_counters.fanout_bytes << " bytes"
+              << " | suppressed " << push_counters.fanout_suppressed << std::endl;
+    std::cout << "Server push broadcast ring: " << push_counters.ring_frames << " frames"
+              << " | oversized " << push_counters.ring_oversized << std::endl;
+}
 
+void ipc_server_print_active_clients()
+{
     const int fd_width = 8;
     const int ip_width = 16;
     const int flag_width = 10;
 
-    std::cout << "--------------------------------------------------" << std::endl;
+    std::cout << "--------------------------------------------------------------" << std::endl;
     std::cout << "| " << std::left << std::setw(fd_width) << "fd"
               << "| " << std::setw(ip_width) << "ip"
-              << "| " << std::setw(flag_width) << "flag" << "|" << std::endl;
-    std::cout << "--------------------------------------------------" << std::endl;
+              << "| " << std::setw(flag_width) << "flag"
+              << "| " << std::setw(flag_width) << "topics" << "|" << std::endl;
+    std::cout << "--------------------------------------------------------------" << std::endl;
 
-    for (const auto &client : active_clients)
+    for (const auto &shard : server_shards)
     {
-        std::cout << "| " << std::left << std::setw(fd_width) << client.fd
-                  << "| " << std::setw(ip_width) << client.ip
-                  << "| " << std::setw(flag_width) << client.flag << "|" << std::endl;
+        std::lock_guard<std::mutex> lock(shard->clients_mutex);
+        for (const auto &entry : shard->clients)
+        {
+            const ClientInfo &client = entry.second->info;
+            std::cout << "| " << std::left << std::setw(fd_width) << client.fd
+                      << "| " << std::setw(ip_width) << client.ip
+                      << "| " << std::setw(flag_width) << client.flag
+                      << "| " << std::setw(flag_width) << entry.second->topics.size() << "|" << std::endl;
+        }
     }
 
-    std::cout << "--------------------------------------------------" << std::endl;
+    std::cout << "--------------------------------------------------------------" << std::endl;
+    std::cout << std::right;
 }
 
-void ipc_server_update_client(int fd, bool new_flag)
+/**
+ * @brief Sets how often a client receives the state pushes of a topic.
+ *
+ * @param fd The client file descriptor.
+ * @param topic Topic key, -1 for the default interval of the client.
+ * @param interval_ms Minimum time between two pushes, 0 for every update (a topic then falls
+ *                    back to the default interval of the client).
+ * @return false if the client is unknown.
+ */
+bool ipc_server_set_push_interval(int fd, int topic, uint32_t interval_ms)
 {
-    std::lock_guard<std::mutex> lock(clients_mutex); // 线程安全
+    IpcServerShard &shard = ipc_server_get_shard(fd);
+    std::lock_guard<std::mutex> lock(shard.clients_mutex); // 线程安全
 
-    // 在集合中查找匹配的 `fd`
-    auto it = std::find_if(active_clients.begin(), active_clients.end(),
-                           [fd](const ClientInfo &client)
-                           { return client.fd == fd; });
-
-    if (it != active_clients.end())
+    auto it = shard.clients.find(fd);
+    if (it == shard.clients.end())
     {
-        // 先取出原始值，修改后重新插入
-        ClientInfo updated_client = *it;
-        updated_client.flag = new_flag;
-
-        active_clients.erase(it);                         // 删除旧的
-        active_clients.insert(std::move(updated_client)); // 插入更新后的
+        std::cerr << "Client FD not found: " << fd << std::endl;
+        return false;
     }
+
+    IpcConnection &connection = *it->second;
+    if (topic < 0)
+        connection.push_interval_ms = interval_ms;
+    else if (interval_ms > 0)
+        connection.topic_intervals[static_cast<uint16_t>(topic)] = interval_ms;
     else
+        connection.topic_intervals.erase(static_cast<uint16_t>(topic));
+    return true;
+}
+
+// Unchanged state snapshots are resent to the client at least this often, 0 never
+bool ipc_server_set_keyframe_interval(int fd, uint32_t interval_ms)
+{
+    IpcServerShard &shard = ipc_server_get_shard(fd);
+    std::lock_guard<std::mutex> lock(shard.clients_mutex); // 线程安全
+
+    auto it = shard.clients.find(fd);
+    if (it == shard.clients.end())
     {
         std::cerr << "Client FD not found: " << fd << std::endl;
+        return false;
     }
+    it->second->keyframe_interval_ms = interval_ms;
+    return true;
 }
-void ipc_server_update_client(int fd, const std::string &ip)
+
+// A client reading the broadcast ring gets no pushes through the socket any more
+bool ipc_server_set_broadcast_reader(int fd, bool enabled)
 {
-    std::lock_guard<std::mutex> lock(clients_mutex); // 线程安全
+    IpcServerShard &shard = ipc_server_get_shard(fd);
+    std::lock_guard<std::mutex> lock(shard.clients_mutex); // 线程安全
 
-    // 在集合中查找匹配的 `fd`
-    auto it = std::find_if(active_clients.begin(), active_clients.end(),
-                           [fd](const ClientInfo &client)
-                           { return client.fd == fd; });
+    auto it = shard.clients.find(fd);
+    if (it == shard.clients.end())
+    {
+        std::cerr << "Client FD not found: " << fd << std::endl;
+        return false;
+    }
+    it->second->broadcast_ring = enabled;
+    return true;
+}
+
+// A container client gets the frames of a burst packed into container frames
+bool ipc_server_set_container_client(int fd, bool enabled)
+{
+    std::shared_ptr<IpcConnection> connection = ipc_server_find_client(fd);
+    if (!connection)
+    {
+        std::cerr << "Client FD not found: " << fd << std::endl;
+        return false;
+    }
 
-    if (it != active_clients.end())
+    std::lock_guard<std::mutex> lock(connection->send_mutex);
+    if (!connection->closed && connection->containers != enabled)
     {
-        // 先取出原始值，修改后重新插入
-        ClientInfo updated_client = *it;
-        updated_client.ip = ip;
+        connection->containers = enabled;
+        connection->outbound.set_containers(enabled);
+        container_clients += enabled ? 1 : -1;
+    }
+    return true;
+}
+
+// The push flag is kept as a subscription to every topic
+void ipc_server_update_client(int fd, bool new_flag)
+{
+    ipc_server_subscribe_client(fd, MSG_IPC_TOPIC_ANY, MSG_IPC_TOPIC_ANY, new_flag);
+}
+void ipc_server_update_client(int fd, const std::string &ip)
+{
+    IpcServerShard &shard = ipc_server_get_shard(fd);
+    std::lock_guard<std::mutex> lock(shard.clients_mutex); // 线程安全
 
-        active_clients.erase(it);                         // 删除旧的
-        active_clients.insert(std::move(updated_client)); // 插入更新后的
+    auto it = shard.clients.find(fd);
+    if (it != shard.clients.end())
+    {
+        it->second->info.ip = ip;
     }
     else
     {
@@ -232,178 +664,1321 @@ bool ipc_server_ensure_directory_exists(const char *path)
     // Try to create the directory (non-recursive)
     if (mkdir(parent_dir.c_str(), 0777) == -1)
     {
-        std::cerr << "[EnsureDir] Failed to create directory '" << parent_dir
-                  << "': " << strerror(errno) << std::endl;
-        return false;
+        std::cerr << "[EnsureDir] Failed to create directory '" << parent_dir
+                  << "': " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+// Function to remove the old socket file if it exists
+void ipc_server_remove_old_socket_bind_file()
+{
+    unlink(socket_path);
+    unlink(seqpacket_socket_path);
+}
+
+// Publishes a snapshot unless it equals the latest one, so a version only advances on a change
+template <typename T>
+void ipc_server_publish_otsm_state(OctopusSnapshotExchange<T> &exchange, const T &value)
+{
+    T latest;
+    if (exchange.read(latest) && memcmp(&latest, &value, sizeof(T)) == 0)
+        return;
+    exchange.publish(value);
+}
+
+// Publishes a copy of a live OTSM struct, if OTSM provides it
+template <typename T>
+void ipc_server_capture_otsm_struct(OctopusSnapshotExchange<T> &exchange, T *(*getter)())
+{
+    const T *live = getter ? getter() : nullptr;
+    if (live)
+        ipc_server_publish_otsm_state(exchange, *live);
+}
+
+/**
+ * @brief Copies the live OTSM struct a push refers to into its snapshot exchange.
+ *
+ * Runs on the OTSM thread from within its push callback, while OTSM is not modifying the struct.
+ * Never blocks: if a SET command is writing into the live struct right now, the capture is
+ * skipped and the next push of the topic catches up.
+ */
+void ipc_server_capture_otsm_state(uint16_t msg_grp, uint16_t msg_id)
+{
+    std::unique_lock<std::mutex> lock(otsm_state_write_mutex, std::try_to_lock);
+    if (!lock.owns_lock())
+        return;
+
+    if (msg_grp == MSG_GROUP_CAR)
+    {
+        switch (msg_id)
+        {
+        case MSG_IPC_CMD_CAR_GET_METER_INFO:
+            ipc_server_capture_otsm_struct(otsm_meter_exchange, otsm_get_meter_info);
+            break;
+        case MSG_IPC_CMD_CAR_GET_INDICATOR_INFO:
+            ipc_server_capture_otsm_struct(otsm_indicator_exchange, otsm_get_indicator_info);
+            break;
+        case MSG_IPC_CMD_CAR_GET_BATTERY_INFO:
+            ipc_server_capture_otsm_struct(otsm_battery_exchange, otsm_get_battery_info);
+            break;
+        case MSG_IPC_CMD_CAR_GET_ERROR_INFO:
+            ipc_server_capture_otsm_struct(otsm_error_exchange, otsm_get_error_info);
+            break;
+        default:
+            break;
+        }
+    }
+    else if (msg_grp == MSG_GROUP_MCU)
+    {
+        switch (msg_id)
+        {
+        case MSG_IPC_CMD_MCU_VERSION:
+            ipc_server_capture_otsm_struct(otsm_flash_meta_exchange, otsm_get_mcu_flash_meta_infor);
+            break;
+        case MSG_IPC_CMD_MCU_UPDATING:
+            if (otsm_get_mcu_upgrade_progress_info)
+                otsm_upgrade_progress_exchange.publish(otsm_get_mcu_upgrade_progress_info());
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+/**
+ * @brief Latest consistent copy of an OTSM state struct.
+ *
+ * Until OTSM pushed the topic once there is no snapshot yet, the live struct is copied then.
+ *
+ * @param version Optional, receives the snapshot version (0 for the live struct).
+ * @return false if there is neither a snapshot nor an OTSM getter.
+ */
+template <typename T>
+bool ipc_server_read_otsm_state(const OctopusSnapshotExchange<T> &exchange, T *(*getter)(), T &value, uint64_t *version = nullptr)
+{
+    if (exchange.read(value, version))
+        return true;
+    if (version)
+        *version = 0;
+    const T *live = getter ? getter() : nullptr;
+    if (!live)
+        return false;
+    memcpy(&value, live, sizeof(T));
+    return true;
+}
+
+/**
+ * @brief Appends the latest copy of an OTSM state struct to out, see ipc_server_read_otsm_state().
+ */
+template <typename T>
+bool ipc_server_append_otsm_state(const OctopusSnapshotExchange<T> &exchange, T *(*getter)(), std::vector<uint8_t> &out, uint64_t &version)
+{
+    T value;
+    if (!ipc_server_read_otsm_state(exchange, getter, value, &version))
+        return false;
+    const uint8_t *bytes = reinterpret_cast<const uint8_t *>(&value);
+    out.insert(out.end(), bytes, bytes + sizeof(T));
+    return true;
+}
+
+/**
+ * @brief Appends the carinfo snapshot a GET msg_id returns to out.
+ * @param version Receives the snapshot version, 0 for none.
+ * @return false if the msg_id has no snapshot or the state is unavailable.
+ */
+bool ipc_server_read_car_state(uint8_t msg_id, std::vector<uint8_t> &out, uint64_t &version)
+{
+    version = 0;
+    switch (msg_id)
+    {
+    case MSG_IPC_CMD_CAR_GET_INDICATOR_INFO:
+        return ipc_server_append_otsm_state(otsm_indicator_exchange, otsm_get_indicator_info, out, version);
+    case MSG_IPC_CMD_CAR_GET_METER_INFO:
+        return ipc_server_append_otsm_state(otsm_meter_exchange, otsm_get_meter_info, out, version);
+    case MSG_IPC_CMD_CAR_GET_BATTERY_INFO:
+        return ipc_server_append_otsm_state(otsm_battery_exchange, otsm_get_battery_info, out, version);
+    case MSG_IPC_CMD_CAR_GET_ERROR_INFO:
+        return ipc_server_append_otsm_state(otsm_error_exchange, otsm_get_error_info, out, version);
+    default:
+        return false;
+    }
+}
+
+/**
+ * @brief Current version of the carinfo snapshot a GET msg_id returns, 0 for none.
+ */
+uint64_t ipc_server_get_car_state_version(uint8_t msg_id)
+{
+    switch (msg_id)
+    {
+    case MSG_IPC_CMD_CAR_GET_INDICATOR_INFO:
+        return otsm_indicator_exchange.get_version();
+    case MSG_IPC_CMD_CAR_GET_METER_INFO:
+        return otsm_meter_exchange.get_version();
+    case MSG_IPC_CMD_CAR_GET_BATTERY_INFO:
+        return otsm_battery_exchange.get_version();
+    case MSG_IPC_CMD_CAR_GET_ERROR_INFO:
+        return otsm_error_exchange.get_version();
+    default:
+        return 0;
+    }
+}
+
+/**
+ * @brief Answers MSG_IPC_CMD_CAR_GET_BATCH: every requested carinfo snapshot in one reply frame.
+ *
+ * The snapshots are one consistent cut of the OTSM state. Each is read with its version, then all
+ * versions are checked again: if none moved, every copy was the latest one at that instant,
+ * otherwise the batch is read again. Neither OTSM nor SET commands are ever blocked by a batch.
+ * Unknown msg_ids get an empty item.
+ */
+void ipc_server_send_car_batch(int client_fd, const DataMessageView &query_msg)
+{
+    std::vector<uint8_t> reply_data;
+    std::vector<uint8_t> state;
+    std::vector<uint64_t> versions(query_msg.data.size());
+
+    for (int attempt = 0;; ++attempt)
+    {
+        reply_data.clear();
+        size_t count = 0;
+        for (; count < query_msg.data.size(); ++count)
+        {
+            uint8_t msg_id = query_msg.data[count];
+            state.clear();
+            ipc_server_read_car_state(msg_id, state, versions[count]);
+            if (!batch_reply_add_item(reply_data, msg_id, state.data(), static_cast<uint16_t>(state.size())))
+                break; // Frame full, the remaining items are left out
+        }
+
+        bool consistent = true;
+        for (size_t i = 0; i < count && consistent; ++i)
+            consistent = ipc_server_get_car_state_version(query_msg.data[i]) == versions[i];
+        if (consistent)
+            break;
+        if (attempt + 1 >= IPC_SERVER_BATCH_MAX_ATTEMPTS)
+        {
+            std::cerr << "Server: Car batch read raced OTSM " << IPC_SERVER_BATCH_MAX_ATTEMPTS << " times, replying the last read" << std::endl;
+            break;
+        }
+    }
+
+    ipc_server_send_reply(client_fd, query_msg, reply_data.data(), reply_data.size());
+}
+
+/**
+ * @brief Answers MSG_IPC_CMD_CAR_GET_IF_MODIFIED.
+ *
+ * The version of a carinfo snapshot only advances when its bytes change. A client already holding
+ * the current version gets a NOT_MODIFIED frame with just the msg_id instead of the struct, found
+ * by comparing the version alone. Otherwise it gets the GET frame of the msg_id with the version appended. Version
+ * 0 (nothing published yet) is never current.
+ *
+ * @return false if the request is malformed or the state is unavailable.
+ */
+bool ipc_server_send_car_state_if_modified(int client_fd, const DataMessageView &query_msg)
+{
+    if (query_msg.data.size() < 1 + STATE_VERSION_LENGTH)
+        return false;
+
+    uint8_t msg_id = query_msg.data[0];
+    uint64_t known_version = 0;
+    state_version_parse(DataMessageSpan(query_msg.data.data(), 1 + STATE_VERSION_LENGTH), &known_version);
+
+    std::vector<uint8_t> reply_data;
+    uint8_t reply_id = msg_id;
+    uint64_t version = ipc_server_get_car_state_version(msg_id);
+    if (version != 0 && version == known_version)
+    {
+        reply_id = MSG_IPC_CMD_CAR_NOT_MODIFIED;
+        reply_data.push_back(msg_id);
+    }
+    else
+    {
+        if (!ipc_server_read_car_state(msg_id, reply_data, version))
+            return false;
+        state_version_append(reply_data, version);
+    }
+
+    DataMessage reply(MSG_GROUP_CAR, reply_id, reply_data);
+    reply.request_id = query_msg.request_id;
+    return ipc_server_send_to_client(client_fd, make_outbound_frame(reply.serializeMessage()), -1);
+}
+
+/**
+ * @brief Writes a client provided struct into the live OTSM state (SET commands).
+ *
+ * The write is never observed half done by a capture, and the snapshot exchange is updated at once
+ * so a following GET returns the new value.
+ */
+template <typename T>
+void ipc_server_write_otsm_state(OctopusSnapshotExchange<T> &exchange, T *live, const uint8_t *data)
+{
+    T value;
+    memcpy(&value, data, sizeof(T));
+
+    std::lock_guard<std::mutex> lock(otsm_state_write_mutex);
+    memcpy(live, &value, sizeof(T));
+    ipc_server_publish_otsm_state(exchange, value);
+}
+
+/**
+ * @brief Serializes an OTSM push and queues it to the subscribed clients.
+ *
+ * Runs on the push dispatcher thread (or on the OTSM thread with IPC_SERVER_PUSH_INLINE).
+ */
+void ipc_server_dispatch_push(uint16_t msg_grp, uint16_t msg_id, const uint8_t *data, uint16_t length)
+{
+    // The payload is fetched and serialized once, then the same frame is queued to every subscriber
+    try
+    {
+        switch (msg_grp)
+        {
+        case MSG_GROUP_CAR:
+            ipc_server_notify_car_infor_to_client(IPC_SERVER_BROADCAST_FD, msg_grp, msg_id, data, length);
+            break;
+        case MSG_GROUP_MCU:
+            ipc_server_notify_mcu_infor_to_client(IPC_SERVER_BROADCAST_FD, msg_grp, msg_id, data, length);
+            break;
+        default:
+            break;
+        }
+    }
+    catch (const std::exception &ex)
+    {
+        std::cerr << "[ERROR] Notify failed for group " << msg_grp << " msg " << msg_id
+                  << ": " << ex.what() << std::endl;
+    }
+}
+
+// Key events are forwarded as pushed, every other push is re-read from the captured OTSM state
+bool ipc_server_push_uses_payload(uint16_t msg_grp, uint16_t msg_id)
+{
+    return msg_grp == MSG_GROUP_MCU &&
+           (msg_id == MSG_IPC_CMD_KEY_EVENT || msg_id == MSG_IPC_CMD_KEY_DOWN_EVENT || msg_id == MSG_IPC_CMD_KEY_UP_EVENT);
+}
+
+/**
+ * @brief Queues an OTSM push record for the push dispatcher. Never blocks.
+ *
+ * Only the first record after a drain signals the eventfd, a burst of pushes costs a single write().
+ * The payload is copied only for the pushes forwarding it, a state push carries (group, id) alone.
+ */
+void ipc_server_post_push(uint16_t msg_grp, uint16_t msg_id, const uint8_t *data, uint16_t length)
+{
+    IpcPushRecord record;
+    if (!ipc_server_push_uses_payload(msg_grp, msg_id))
+        length = 0;
+    if (length > IPC_PUSH_RECORD_DATA_MAX || (length > 0 && data == nullptr))
+    {
+        push_counters.records_dropped++;
+        return;
+    }
+
+    record.msg_grp = msg_grp;
+    record.msg_id = msg_id;
+    record.length = length;
+    if (length > 0)
+        memcpy(record.data, data, length);
+
+    if (!push_queue.try_push(record))
+    {
+        push_counters.records_dropped++;
+        return;
+    }
+
+    if (!push_signal_pending.exchange(true))
+    {
+        uint64_t one = 1;
+        if (write(push_event_fd, &one, sizeof(one)) < 0)
+            push_signal_pending = false;
+    }
+}
+
+// Drains every queued record, the frames of one drain form a flush burst
+void ipc_server_drain_push_queue()
+{
+    // Clear before draining: a record queued from now on signals the eventfd again
+    push_signal_pending = false;
+
+    IpcFlushBurst burst;
+    IpcPushRecord record;
+    while (push_queue.try_pop(record))
+    {
+        ipc_server_dispatch_push(record.msg_grp, record.msg_id, record.data, record.length);
+    }
+}
+
+// Push dispatcher handler of push_event_fd
+void ipc_server_handle_push_event(int fd, uint32_t /*events*/)
+{
+    uint64_t value;
+    while (read(fd, &value, sizeof(value)) > 0)
+    {
+    }
+
+    // Container clients: the pushes of the next window_us go out in one write. The records are
+    // dispatched right away, other clients are flushed with the drain as usual.
+    if (container_window_us > 0 && container_clients > 0 && push_window_fd >= 0 && !push_window_armed)
+    {
+        itimerspec spec{};
+        spec.it_value.tv_sec = container_window_us / 1000000;
+        spec.it_value.tv_nsec = (container_window_us % 1000000) * 1000L;
+        push_window_armed = (timerfd_settime(push_window_fd, 0, &spec, nullptr) == 0);
+    }
+
+    flush_window_fds = push_window_armed ? &push_window_fds : nullptr;
+    ipc_server_drain_push_queue();
+    flush_window_fds = nullptr;
+}
+
+// Push dispatcher handler of push_window_fd, the container window is over
+void ipc_server_handle_push_window(int fd, uint32_t /*events*/)
+{
+    uint64_t expirations;
+    while (read(fd, &expirations, sizeof(expirations)) > 0)
+    {
+    }
+
+    push_window_armed = false;
+    ipc_server_flush_deferred_clients(push_window_fds, &IpcConnection::window_deferred);
+}
+
+// OTSM push callback, runs on the OTSM thread and must return quickly
+void ipc_server_message_data_callback(uint16_t msg_grp, uint16_t msg_id, const uint8_t *data, uint16_t length)
+{
+    // std::cout << "Server handling otsm message cmd_parameter=" << cmd_parameter << std::endl;
+    auto start = std::chrono::steady_clock::now();
+
+    // Snapshot the state on this thread, every other thread reads the copy
+    ipc_server_capture_otsm_state(msg_grp, msg_id);
+
+#ifdef IPC_SERVER_PUSH_INLINE
+    ipc_server_dispatch_push(msg_grp, msg_id, data, length);
+#else
+    ipc_server_post_push(msg_grp, msg_id, data, length);
+#endif
+
+    uint64_t elapsed_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    push_counters.callbacks++;
+    push_counters.callback_total_ns += elapsed_ns;
+    uint64_t max_ns = push_counters.callback_max_ns;
+    while (elapsed_ns > max_ns && !push_counters.callback_max_ns.compare_exchange_weak(max_ns, elapsed_ns))
+    {
+    }
+}
+
+// Signal handler for clean-up on interrupt (e.g., Ctrl+C)
+void ipc_server_signal_handler(int signum)
+{
+    std::cout << "Server Interrupt signal received. Cleaning up...\n";
+    server.close_socket(socket_fd_server);
+    if (socket_fd_server_seqpacket >= 0)
+        server_seqpacket.close_socket(socket_fd_server_seqpacket);
+    if (otsm_StopRunning)
+        otsm_StopRunning();
+    exit(signum);
+}
+
+/**
+ * @brief Handles an epoll event reported for a connected client socket.
+ *
+ * Runs on the reactor thread. Reads the data currently available on the non-blocking
+ * socket, parses it according to the protocol and dispatches the message to the
+ * appropriate handler. The connection is closed on hang-up, disconnection or error.
+ *
+ * @param client_fd The file descriptor of the connected client socket.
+ * @param events The epoll event mask reported for the socket.
+ */
+void ipc_server_handle_client_event(const std::shared_ptr<IpcConnection> &connection, uint32_t events)
+{
+    int client_fd = connection->info.fd;
+    IpcFlushBurst burst; // The replies to one read are written together
+
+    // The socket drained enough to take more of the queued frames
+    if (events & EPOLLOUT)
+    {
+        std::lock_guard<std::mutex> lock(connection->send_mutex);
+        ipc_server_flush_client(*connection);
+    }
+
+    if (!(events & EPOLLIN))
+    {
+        if (events & (EPOLLHUP | EPOLLERR))
+        {
+            std::cout << "Server client [" << client_fd << "] hung up." << std::endl;
+            ipc_server_close_client(connection);
+        }
+        return;
+    }
+
+    // Read everything the client queued since the last wakeup (up to the read budget, epoll is
+    // level-triggered and reports the rest again), then dispatch every complete frame before
+    // going back to the poller.
+    size_t received = 0;
+    std::vector<int> received_fds;
+    QueryStatus query_status;
+    if (connection->seqpacket)
+    {
+        // A packet must be read whole, it gets a buffer fitting the largest frame. Frames are parsed in place.
+        static thread_local uint8_t packet_buffer[IPC_SOCKET_PACKET_BUFFER_SIZE];
+        size_t budget = IPC_SERVER_READ_BUDGET;
+        while ((query_status = server.get_query_nonblocking(client_fd, packet_buffer, sizeof(packet_buffer), received, received_fds)) == QueryStatus::Success)
+        {
+            // A packet holds whole frames, nothing is carried over to the next read
+            ipc_server_claim_passed_fds(*connection, received_fds);
+            size_t invalid_bytes = frame_packet_for_each(packet_buffer, received, [client_fd](const DataMessageView &data_message)
+                                                         { ipc_server_dispatch_message(client_fd, data_message); });
+            if (invalid_bytes > 0)
+            {
+                std::cerr << "Server Invalid bytes skipped from client [" << client_fd << "]: " << invalid_bytes << std::endl;
+            }
+            if (received >= budget)
+                return;
+            budget -= received;
+        }
+    }
+    else
+    {
+        // The bytes go straight into the client's stream decoder. They may carry several pipelined
+        // frames or only part of one.
+        FrameDecoder &decoder = connection->decoder;
+        size_t dropped_bytes = decoder.get_dropped_bytes();
+        query_status = server.get_query_nonblocking(client_fd, decoder, received, received_fds, IPC_SERVER_READ_BUDGET);
+        ipc_server_claim_passed_fds(*connection, received_fds);
+
+        // Also the frames read right before a hang-up
+        DataMessageView data_message; // Points into the decoder, valid until its next call
+        while (decoder.next(data_message))
+        {
+            ipc_server_dispatch_message(client_fd, data_message);
+        }
+
+        if (decoder.get_dropped_bytes() != dropped_bytes)
+        {
+            std::cerr << "Server Invalid bytes skipped from client [" << client_fd << "]: "
+                      << (decoder.get_dropped_bytes() - dropped_bytes) << std::endl;
+        }
+    }
+
+    // Check the status of the last read
+    switch (query_status)
+    {
+    case QueryStatus::Timeout:
+    case QueryStatus::Success:
+        // Drained, or the budget is used up
+        return;
+
+    case QueryStatus::Disconnected:
+        // Client disconnected, clean up
+        std::cout << "Server client [" << client_fd << "] disconnected." << std::endl;
+        [[fallthrough]];
+
+    case QueryStatus::Error:
+    default:
+        // Any other error or invalid socket state, terminate connection
+        std::cerr << "Server connection for client [" << client_fd << "] closing." << std::endl;
+        ipc_server_close_client(connection);
+        return;
+    }
+}
+
+/**
+ * @brief Keeps file descriptors a client passed along with its data.
+ *
+ * They are claimed in order by the large payload descriptor frames, a client passing more than
+ * IPC_SERVER_MAX_PASSED_FDS unclaimed ones is misbehaving.
+ *
+ * @param connection The client connection.
+ * @param received_fds Descriptors just received, moved out.
+ */
+void ipc_server_claim_passed_fds(IpcConnection &connection, std::vector<int> &received_fds)
+{
+    for (int fd : received_fds)
+    {
+        if (connection.passed_fds.size() < IPC_SERVER_MAX_PASSED_FDS)
+        {
+            connection.passed_fds.push_back(fd);
+            continue;
+        }
+        std::cerr << "Server client [" << connection.info.fd << "] passed too many file descriptors, closing one." << std::endl;
+        close(fd);
+    }
+    received_fds.clear();
+}
+
+/**
+ * @brief Handles bytes an io_uring receive delivered for a stream client.
+ *
+ * Runs on the reactor thread. The bytes sit in a kernel provided buffer which is recycled after
+ * the call: while nothing is buffered, whole frames are dispatched straight from it and only a
+ * trailing partial frame is copied into the client's decoder.
+ *
+ * @param connection The client connection.
+ * @param data The received bytes.
+ * @param length Number of bytes, 0 if the client closed, -errno if the receive failed.
+ * @param received_fds Descriptors passed along the bytes.
+ */
+void ipc_server_handle_client_data(const std::shared_ptr<IpcConnection> &connection, const uint8_t *data, ssize_t length, std::vector<int> &received_fds)
+{
+    int client_fd = connection->info.fd;
+    if (length <= 0)
+    {
+        if (length == 0)
+            std::cout << "Server client [" << client_fd << "] disconnected." << std::endl;
+        std::cerr << "Server connection for client [" << client_fd << "] closing." << std::endl;
+        ipc_server_close_client(connection);
+        return;
+    }
+
+    ipc_server_claim_passed_fds(*connection, received_fds);
+    IpcFlushBurst burst; // The replies to one receive are written together
+    FrameDecoder &decoder = connection->decoder;
+    size_t dropped_bytes = decoder.get_dropped_bytes();
+    size_t remaining = static_cast<size_t>(length);
+    if (decoder.size() == 0)
+    {
+        // Garbage stops the in place parsing, the decoder resynchronizes on the rest
+        size_t rest = frame_packet_for_each(data, remaining, [client_fd](const DataMessageView &data_message)
+                                            { ipc_server_dispatch_message(client_fd, data_message); });
+        data += remaining - rest;
+        remaining = rest;
+    }
+
+    decoder.feed(data, remaining);
+    DataMessageView data_message; // Points into the decoder, valid until its next call
+    while (decoder.next(data_message))
+    {
+        ipc_server_dispatch_message(client_fd, data_message);
+    }
+
+    if (decoder.get_dropped_bytes() != dropped_bytes)
+    {
+        std::cerr << "Server Invalid bytes skipped from client [" << client_fd << "]: "
+                  << (decoder.get_dropped_bytes() - dropped_bytes) << std::endl;
+    }
+}
+
+/**
+ * @brief Handles a wakeup of a client's shared memory channel.
+ *
+ * Runs on the reactor thread. The client either wrote frames into its tx ring or made room in
+ * ours: the frames are decoded like socket data, then the outbound queue is flushed again.
+ *
+ * @param connection The client connection, its shm_channel is open.
+ */
+void ipc_server_handle_shm_event(const std::shared_ptr<IpcConnection> &connection)
+{
+    // The channel is opened and closed on this thread, a stale wakeup finds it gone
+    if (!connection->shm_channel)
+        return;
+
+    int client_fd = connection->info.fd;
+    OctopusShmChannel &channel = *connection->shm_channel;
+    FrameDecoder &decoder = connection->shm_decoder; // The socket stays usable, it keeps its own decoder
+    uint8_t buffer[4096];
+
+    IpcFlushBurst burst;
+    channel.clear_wake();
+    do
+    {
+        ssize_t received;
+        while ((received = channel.receive(buffer, sizeof(buffer))) > 0)
+        {
+            decoder.feed(buffer, static_cast<size_t>(received));
+            DataMessageView data_message;
+            while (decoder.next(data_message))
+                ipc_server_dispatch_message(client_fd, data_message);
+        }
+        if (received < 0)
+        {
+            std::cerr << "Server shared memory ring of client [" << client_fd << "] corrupted, closing." << std::endl;
+            ipc_server_close_client(connection);
+            return;
+        }
+    } while (!channel.park()); // Frames written while we drained are picked up without a wakeup
+
+    std::lock_guard<std::mutex> lock(connection->send_mutex);
+    ipc_server_flush_client(*connection);
+}
+
+/**
+ * @brief Switches a client to the shared memory transport.
+ *
+ * Runs on the reactor thread. The reply carrying the channel file descriptors is the last frame
+ * sent on the socket, every later frame goes through the tx ring. The switch is refused while
+ * socket frames are still queued, the client then simply stays on the socket.
+ *
+ * @param client_fd The client file descriptor.
+ * @param capacity Requested ring size in bytes, 0 for the default.
+ * @param request_id Request id echoed by the reply, 0 for none.
+ */
+void ipc_server_open_shm_channel(int client_fd, size_t capacity, uint32_t request_id)
+{
+    std::shared_ptr<IpcConnection> connection = ipc_server_find_client(client_fd);
+    if (!connection)
+        return;
+
+    DataMessage reply;
+    reply.msg_group = MSG_GROUP_IPC_CONFIG;
+    reply.msg_id = MSG_IPC_CMD_CONFIG_SHM_RING;
+    reply.request_id = request_id;
+    reply.data = {0};
+    {
+        std::lock_guard<std::mutex> lock(connection->send_mutex);
+        std::unique_ptr<OctopusShmChannel> channel(new OctopusShmChannel());
+        int peer_fds[SHM_CHANNEL_FD_COUNT];
+        if (!connection->closed && !connection->shm_channel && connection->outbound.empty() &&
+            channel->create(capacity ? capacity : SHM_RING_DEFAULT_CAPACITY, peer_fds))
+        {
+            uint32_t ring_bytes = static_cast<uint32_t>(channel->get_capacity());
+            reply.data = {1, static_cast<uint8_t>(ring_bytes >> 24), static_cast<uint8_t>(ring_bytes >> 16),
+                          static_cast<uint8_t>(ring_bytes >> 8), static_cast<uint8_t>(ring_bytes)};
+            reply.msg_length = reply.data.size();
+            std::vector<uint8_t> serialized_data = reply.serializeMessage();
+
+            int wake_fd = channel->get_wake_fd();
+            connection->shm_channel = std::move(channel);
+            auto handler = [connection](int, uint32_t)
+            { ipc_server_handle_shm_event(connection); };
+            bool registered = ipc_server_get_shard(client_fd).reactor.add_fd(wake_fd, EPOLLIN, handler);
+            int sent = registered ? server.send_buff_with_fds(client_fd, serialized_data.data(), serialized_data.size(),
+                                                              peer_fds, SHM_CHANNEL_FD_COUNT)
+                                  : -1;
+            for (int fd : peer_fds)
+                close(fd);
+
+            if (sent == static_cast<int>(serialized_data.size()))
+            {
+                std::cout << "Server client [" << client_fd << "] switched to shared memory rings of "
+                          << ring_bytes << " bytes." << std::endl;
+                return;
+            }
+
+            if (registered)
+                ipc_server_get_shard(client_fd).reactor.remove_fd(wake_fd);
+            connection->shm_channel.reset();
+            if (sent > 0)
+            {
+                // Part of the reply is on the wire, the stream cannot be recovered
+                std::cerr << "Server client [" << client_fd << "] shared memory reply truncated, dropping connection." << std::endl;
+                shutdown(client_fd, SHUT_RDWR);
+                return;
+            }
+            reply.data = {0};
+        }
+    }
+
+    // Refused: the client stays on the socket
+    reply.msg_length = reply.data.size();
+    ipc_server_send_to_client(client_fd, make_outbound_frame(reply.serializeMessage()), -1);
+}
+
+/**
+ * @brief Dispatches a validated message to the handler of its group.
+ *
+ * @param client_fd The file descriptor of the client the message came from.
+ * @param data_message The message to dispatch.
+ */
+void ipc_server_dispatch_message(int client_fd, const DataMessageView &data_message)
+{
+    // Dispatch to the appropriate handler based on group ID
+    switch (data_message.msg_group)
+    {
+    case MSG_GROUP_HELP:
+        ipc_server_handle_help_event(client_fd, data_message); // Help/info request
+        break;
+
+    // case MSG_GROUP_SET:
+    case MSG_GROUP_IPC_CONFIG:
+        if (data_message.msg_id == MSG_IPC_CMD_CONFIG_LARGE_PAYLOAD)
+            ipc_server_handle_large_payload_event(client_fd, data_message); // Sealed memfd payload
+        else
+            ipc_server_handle_config_event(client_fd, data_message); // Configuration command
+        break;
+
+    case MSG_GROUP_MCU:
+        ipc_server_handle_mcu_event(client_fd, data_message);
+        break;
+    case 3:
+    case 4:
+        ipc_server_handle_calculation_event(client_fd, data_message); // Placeholder groups
+        break;
+
+    case MSG_GROUP_CAR:
+        ipc_server_handle_car_event(client_fd, data_message); // Vehicle info commands
+        break;
+
+    default:
+        // Unknown group, fallback to help
+        ipc_server_handle_help_event(client_fd, data_message);
+        break;
+    }
+
+    // Log success after handling the message
+    std::cout << "Server handling [Client: " << std::setw(2) << std::setfill('0') << client_fd << "] "
+              << "[Group: " << std::setw(2) << std::setfill('0') << static_cast<int>(data_message.msg_group) << "] "
+              << "[Msg: " << std::setw(2) << std::setfill('0') << static_cast<int>(data_message.msg_id) << "] done." << std::endl;
+}
+
+/**
+ * @brief Unregisters a client from the reactor, closes its socket and removes it from the active list.
+ *
+ * Runs on the reactor thread owning the client.
+ *
+ * @param connection The client connection.
+ */
+void ipc_server_close_client(const std::shared_ptr<IpcConnection> &connection)
+{
+    int client_fd = connection->info.fd;
+
+    // Remove from the active list first so pushes stop targeting the fd before it can be reused
+    IpcServerShard &shard = ipc_server_get_shard(client_fd);
+    ipc_server_remove_client(client_fd);
+    shard.reactor.remove_fd(client_fd);
+    {
+        // Senders still holding the connection see closed and never write to a reused fd
+        std::lock_guard<std::mutex> lock(connection->send_mutex);
+        connection->closed = true;
+        connection->outbound.clear();
+        if (connection->containers)
+            container_clients--;
+        if (connection->shm_channel)
+        {
+            shard.reactor.remove_fd(connection->shm_channel->get_wake_fd());
+            connection->shm_channel.reset();
+        }
+        close(client_fd);
+    }
+    for (int fd : connection->passed_fds)
+        close(fd);
+    connection->passed_fds.clear();
+    std::cout << "Server connection for client [" << client_fd << "] closed." << std::endl;
+
+    // The fastest push interval may have left with the client
+    ipc_server_update_otsm_push_interval();
+}
+
+/**
+ * @brief Writes queued frames without blocking and keeps EPOLLOUT armed while data is pending.
+ *
+ * Must be called with connection.send_mutex held.
+ *
+ * @param connection The client connection.
+ */
+void ipc_server_flush_client(IpcConnection &connection)
+{
+    // Linked sends in flight own the front of the queue, their completion flushes again
+    if (connection.closed || connection.sends_in_flight)
+        return;
+
+    int client_fd = connection.info.fd;
+    OutboundFlushResult result;
+    if (connection.shm_channel)
+    {
+        // A full ring wakes the reactor through the channel eventfd once the client made room
+        result = connection.outbound.flush(*connection.shm_channel);
+        if (result != OutboundFlushResult::Error)
+            return;
+    }
+    else if (connection.seqpacket)
+    {
+        result = connection.outbound.flush_packets(client_fd);
+    }
+    else if (connection.uring_receiver && ipc_server_submit_sends(connection))
+    {
+        return;
+    }
+    else
+    {
+        result = connection.outbound.flush(client_fd);
+    }
+    if (result == OutboundFlushResult::Error)
+    {
+        // Let the reactor observe the hang-up and close the connection on its own thread
+        std::cerr << "Server write to client [" << client_fd << "] failed: " << strerror(errno) << std::endl;
+        connection.outbound.clear();
+        shutdown(client_fd, SHUT_RDWR);
+        return;
+    }
+
+    bool want_epollout = (result == OutboundFlushResult::Pending);
+    if (want_epollout != connection.epollout_armed)
+    {
+        uint32_t events = EPOLLIN | EPOLLRDHUP | (want_epollout ? static_cast<uint32_t>(EPOLLOUT) : 0u);
+        if (ipc_server_get_shard(client_fd).reactor.modify_fd(client_fd, events))
+            connection.epollout_armed = want_epollout;
+    }
+}
+
+/**
+ * @brief Hands the front of the outbound queue to the reactor as linked io_uring sends.
+ *
+ * Must be called with connection.send_mutex held. Only done on the reactor thread of the
+ * connection: the sends go out with its next io_uring_enter(), without a write system call of
+ * their own. The kernel waits for the socket to drain, so EPOLLOUT is not needed meanwhile.
+ *
+ * @param connection The client connection, its data arrives through io_uring receives.
+ * @return false if nothing was submitted, the caller writes the queue itself.
+ */
+bool ipc_server_submit_sends(IpcConnection &connection)
+{
+    int client_fd = connection.info.fd;
+    OctopusReactor &reactor = ipc_server_get_shard(client_fd).reactor;
+    if (connection.outbound.empty() || !reactor.is_in_loop_thread())
+        return false;
+
+    std::vector<OutboundFrame> frames;
+    size_t offset;
+    connection.outbound.take(frames, IPC_SERVER_URING_MAX_SENDS, offset);
+    iovec iov[IPC_SERVER_URING_MAX_SENDS];
+    for (size_t i = 0; i < frames.size(); ++i)
+    {
+        size_t skip = (i == 0) ? offset : 0;
+        iov[i].iov_base = const_cast<uint8_t *>(frames[i]->data()) + skip;
+        iov[i].iov_len = frames[i]->size() - skip;
+    }
+
+    // done owns the frames the kernel reads. It is not invoked once the fd is removed, so the connection outlives every call
+    IpcConnection *sender = &connection;
+    auto done = [sender, frames, offset](size_t sent, int error)
+    { ipc_server_complete_sends(*sender, frames, offset, sent, error); };
+    if (!reactor.submit_sends(client_fd, iov, frames.size(), done))
+    {
+        connection.outbound.restore(frames, offset, 0);
+        return false;
+    }
+
+    connection.sends_in_flight = true;
+    if (connection.epollout_armed && reactor.modify_fd(client_fd, EPOLLIN | EPOLLRDHUP))
+        connection.epollout_armed = false;
+    return true;
+}
+
+/**
+ * @brief Completion of the linked sends submitted by ipc_server_submit_sends().
+ *
+ * Runs on the reactor thread. Whatever the chain did not write goes back in front of the queue,
+ * then the queue is flushed again.
+ */
+void ipc_server_complete_sends(IpcConnection &connection, const std::vector<OutboundFrame> &frames, size_t offset, size_t sent, int error)
+{
+    std::lock_guard<std::mutex> lock(connection.send_mutex);
+    connection.sends_in_flight = false;
+    if (connection.closed)
+        return;
+
+    int client_fd = connection.info.fd;
+    if (error != 0)
+    {
+        // Let the reactor observe the hang-up and close the connection on its own thread
+        std::cerr << "Server write to client [" << client_fd << "] failed: " << strerror(error) << std::endl;
+        connection.outbound.clear();
+        shutdown(client_fd, SHUT_RDWR);
+        return;
+    }
+
+    connection.outbound.restore(frames, offset, sent);
+    ipc_server_flush_client(connection);
+}
+
+/**
+ * @brief Ends a flush burst: the held back clients get their queue written once, packed into
+ *        container frames by the write.
+ */
+void ipc_server_end_flush_burst()
+{
+    ipc_server_flush_deferred_clients(flush_burst_fds, &IpcConnection::flush_deferred);
+}
+
+// Writes the queues of the clients in deferred_fds, which is emptied. deferred marks a client held back.
+void ipc_server_flush_deferred_clients(std::vector<int> &deferred_fds, bool IpcConnection::*deferred)
+{
+    std::vector<int> fds;
+    fds.swap(deferred_fds);
+    for (int fd : fds)
+    {
+        std::shared_ptr<IpcConnection> connection = ipc_server_find_client(fd);
+        if (!connection)
+            continue;
+
+        std::lock_guard<std::mutex> lock(connection->send_mutex);
+        if (!((*connection).*deferred))
+            continue; // The fd was reused meanwhile
+        (*connection).*deferred = false;
+
+        ipc_server_flush_client(*connection);
+    }
+}
+
+/**
+ * @brief Queues a frame on one connection and writes as much as possible without blocking.
+ *
+ * The slow consumer policy applies when the client's queue is full. Inside a flush burst the
+ * write waits for the end of the burst, unless the queue is already half full. A container
+ * client waits for the end of the container window if the push dispatcher opened one.
+ *
+ * @param connection The client connection.
+ * @param frame The serialized frame, possibly shared with other connections.
+ * @param conflate_key Key of frames which may replace each other, -1 if the frame must not be conflated.
+ * @param latest_value Deliver only the newest unsent frame of conflate_key (latest-value mailbox).
+ * @return false if the client is gone or the frame was not queued.
+ */
+bool ipc_server_enqueue_frame(IpcConnection &connection, const OutboundFrame &frame, int conflate_key, bool latest_value)
+{
+    std::lock_guard<std::mutex> lock(connection.send_mutex);
+    if (connection.closed)
+        return false;
+
+    int client_fd = connection.info.fd;
+    size_t dropped_frames = 0;
+    OutboundPushResult result = (latest_value && conflate_key >= 0)
+                                    ? connection.outbound.push_latest(frame, conflate_key, &dropped_frames)
+                                    : connection.outbound.push(frame, conflate_key, &dropped_frames);
+    switch (result)
+    {
+    case OutboundPushResult::Queued:
+        outbound_counters.frames_queued++;
+        break;
+    case OutboundPushResult::DroppedOldest:
+        outbound_counters.frames_dropped_oldest += dropped_frames;
+        break;
+    case OutboundPushResult::Conflated:
+        outbound_counters.frames_conflated++;
+        break;
+    case OutboundPushResult::DroppedNewest:
+        outbound_counters.frames_dropped_newest++;
+        return false;
+    case OutboundPushResult::Overflow:
+        // Slow consumer, disconnect it. The reactor closes the fd when it sees the hang-up.
+        outbound_counters.connections_dropped++;
+        std::cerr << "Server client [" << client_fd << "] too slow, dropping connection." << std::endl;
+        connection.outbound.clear();
+        shutdown(client_fd, SHUT_RDWR);
+        return false;
+    }
+
+    // Written with the rest of the burst, a long burst must not trip the slow consumer policy
+    if (flush_burst_depth > 0 && connection.outbound.get_queued_bytes() <= outbound_queue_max_bytes / 2)
+    {
+        bool windowed = connection.containers && flush_window_fds;
+        bool &deferred = windowed ? connection.window_deferred : connection.flush_deferred;
+        if (!deferred)
+        {
+            deferred = true;
+            (windowed ? *flush_window_fds : flush_burst_fds).push_back(client_fd);
+        }
+        return true;
+    }
+
+    ipc_server_flush_client(connection);
+    return true;
+}
+
+/**
+ * @brief Queues a serialized frame for a client. Safe to call from any thread.
+ *
+ * @param client_fd The file descriptor of the client socket.
+ * @param frame The serialized frame.
+ * @param conflate_key Key of frames which may replace each other, -1 if the frame must not be conflated.
+ * @return false if the client is gone or the frame was not queued.
+ */
+bool ipc_server_send_to_client(int client_fd, const OutboundFrame &frame, int conflate_key)
+{
+    std::shared_ptr<IpcConnection> connection = ipc_server_find_client(client_fd);
+    if (!connection)
+        return false;
+
+    return ipc_server_enqueue_frame(*connection, frame, conflate_key);
+}
+
+uint64_t ipc_server_now_ms()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Starts ticking the push timer wheel, push dispatcher thread only
+void ipc_server_arm_push_timer()
+{
+    if (push_timer_ticking)
+        return;
+
+    itimerspec spec{};
+    spec.it_interval.tv_nsec = IPC_PUSH_WHEEL_TICK_MS * 1000000L;
+    spec.it_value.tv_nsec = IPC_PUSH_WHEEL_TICK_MS * 1000000L;
+    if (timerfd_settime(push_timer_fd, 0, &spec, nullptr) == 0)
+        push_timer_ticking = true;
+    else
+        std::cerr << "Server Failed to arm push timer: " << strerror(errno) << std::endl;
+}
+
+// Push dispatcher handler of push_timer_fd, fires the expired push interval timers
+void ipc_server_handle_push_timer(int fd, uint32_t /*events*/)
+{
+    uint64_t expirations;
+    while (read(fd, &expirations, sizeof(expirations)) > 0)
+    {
+    }
+
+    {
+        IpcFlushBurst burst;
+        push_timer_wheel->advance(ipc_server_now_ms());
+    }
+
+    // Nothing armed any more, an idle server does not tick
+    if (push_timer_wheel->empty())
+    {
+        itimerspec spec{};
+        timerfd_settime(push_timer_fd, 0, &spec, nullptr);
+        push_timer_ticking = false;
+    }
+}
+
+// Timer callback: queues the frame held back by a throttle once its interval elapsed
+void ipc_server_release_throttled_push(const std::weak_ptr<IpcConnection> &weak_connection, int conflate_key)
+{
+    std::shared_ptr<IpcConnection> connection = weak_connection.lock();
+    if (!connection)
+        return;
+
+    IpcPushThrottle &throttle = connection->throttles[conflate_key];
+    throttle.timer_armed = false;
+    if (throttle.pending)
+    {
+        ipc_server_enqueue_frame(*connection, throttle.pending, conflate_key, true);
+        throttle.pending.reset();
+        throttle.next_due_ms = ipc_server_now_ms() + throttle.interval_ms;
     }
-
-    return true;
 }
 
-// Function to remove the old socket file if it exists
-void ipc_server_remove_old_socket_bind_file()
+/**
+ * @brief Queues a state push to a client no more often than its interval for the topic.
+ *
+ * A frame arriving before the interval elapsed is held back, newer frames replace it, and a
+ * wheel timer queues the latest one when the interval is over. Push dispatcher thread only.
+ */
+void ipc_server_push_throttled(const std::shared_ptr<IpcConnection> &connection, const OutboundFrame &frame, int conflate_key, uint32_t interval_ms)
 {
-    unlink(socket_path);
+    IpcPushThrottle &throttle = connection->throttles[conflate_key];
+    throttle.interval_ms = interval_ms;
+
+    uint64_t now_ms = ipc_server_now_ms();
+    if (!throttle.timer_armed && now_ms >= throttle.next_due_ms)
+    {
+        ipc_server_enqueue_frame(*connection, frame, conflate_key, true);
+        throttle.next_due_ms = now_ms + interval_ms;
+        return;
+    }
+
+    throttle.pending = frame;
+    if (!throttle.timer_armed)
+    {
+        throttle.timer_armed = true;
+        std::weak_ptr<IpcConnection> weak_connection = connection;
+        push_timer_wheel->schedule(throttle.next_due_ms, [weak_connection, conflate_key]()
+                                   { ipc_server_release_throttled_push(weak_connection, conflate_key); });
+        ipc_server_arm_push_timer();
+    }
 }
 
-void ipc_server_message_data_callback(uint16_t msg_grp, uint16_t msg_id, const uint8_t *data, uint16_t length)
+// Push interval of a client for a topic, the most specific setting wins.
+// Must be called with the shard clients_mutex held.
+uint32_t ipc_server_get_push_interval(const IpcConnection &connection, uint16_t topic, uint16_t group_topic)
 {
-    // std::cout << "Server handling otsm message cmd_parameter=" << cmd_parameter << std::endl;
-    if (active_clients.empty())
+    if (!connection.topic_intervals.empty())
     {
-        // std::cout << "[INFO] No clients to notify for cmd_parameter = " << msg_id << std::endl;
-        return;
+        auto it = connection.topic_intervals.find(topic);
+        if (it == connection.topic_intervals.end())
+            it = connection.topic_intervals.find(group_topic);
+        if (it != connection.topic_intervals.end())
+            return it->second;
     }
+    return connection.push_interval_ms;
+}
 
-    for (const auto &client : active_clients)
+/**
+ * @brief Asks OTSM to push at the fastest interval any client requested.
+ *
+ * Slower clients get a decimated stream, see ipc_server_push_throttled(). Once no client
+ * requests an interval any more, OTSM goes back to its own rate.
+ */
+void ipc_server_update_otsm_push_interval()
+{
+    uint32_t fastest_ms = 0;
+    for (const auto &shard : server_shards)
     {
-        /// std::thread notify_thread(notify_carInfor_to_client, client_id, cmd_parameter);
-        /// threads.push_back(std::move(notify_thread));
-        if (client.flag) // need push callback
+        std::lock_guard<std::mutex> lock(shard->clients_mutex);
+        for (const auto &entry : shard->clients)
         {
-            try
-            {
-                switch (msg_grp)
-                {
-                case MSG_GROUP_CAR:
-                    ipc_server_notify_car_infor_to_client(client.fd, msg_grp, msg_id, data, length);
-                    break;
-                case MSG_GROUP_MCU:
-                    ipc_server_notify_mcu_infor_to_client(client.fd, msg_grp, msg_id, data, length);
-                    break;
-                default:
-                    break;
-                }
-            }
-            catch (const std::exception &ex)
+            const IpcConnection &connection = *entry.second;
+            if (connection.push_interval_ms > 0 && (fastest_ms == 0 || connection.push_interval_ms < fastest_ms))
+                fastest_ms = connection.push_interval_ms;
+            for (const auto &interval : connection.topic_intervals)
             {
-                std::cerr << "[ERROR] Notify failed for client.fd=" << client.fd
-                          << ": " << ex.what() << std::endl;
+                if (interval.second > 0 && (fastest_ms == 0 || interval.second < fastest_ms))
+                    fastest_ms = interval.second;
             }
         }
     }
-}
 
-// Signal handler for clean-up on interrupt (e.g., Ctrl+C)
-void ipc_server_signal_handler(int signum)
-{
-    std::cout << "Server Interrupt signal received. Cleaning up...\n";
-    server.close_socket(socket_fd_server);
-    if (otsm_StopRunning)
-        otsm_StopRunning();
-    exit(signum);
+    std::lock_guard<std::mutex> lock(otsm_push_interval_mutex);
+    if (fastest_ms == otsm_push_interval_ms || !otsm_update_push_interval_ms)
+        return;
+
+    otsm_push_interval_ms = fastest_ms;
+    uint32_t interval_ms = (fastest_ms > 0) ? fastest_ms : otsm_default_push_interval_ms;
+    otsm_update_push_interval_ms(static_cast<uint16_t>(std::min<uint32_t>(interval_ms, 0xFFFF)));
+    std::cout << "Server set otsm push interval: " << interval_ms << " ms" << std::endl;
 }
 
-// Function to handle communication with a specific client
 /**
- * @brief Handles communication with a connected client socket.
+ * @brief Queues one frame to every client subscribed to its topic.
  *
- * This function enters an infinite loop to continuously read and process queries
- * from the connected client via the server's query interface. It parses the incoming
- * messages according to the protocol, dispatches them to the appropriate handler functions,
- * and gracefully shuts down the connection upon disconnection or error.
+ * Conflatable (state) frames are delivered through the latest-value mailbox of each client, so
+ * a client falling behind receives the newest snapshot instead of a backlog of stale ones, and
+ * no more often than the push interval the client asked for.
+ * Runs on the push dispatcher thread (or the OTSM thread with IPC_SERVER_PUSH_INLINE).
+ * A changed frame is written once to the shared memory broadcast ring, clients following the
+ * ring are skipped here.
+ * A client matches the exact (group, msg) topic, the group wildcard or the catch-all topic of
+ * the legacy push flag, and receives the frame once even if it subscribed several of them.
+ * The subscribers of a shard are snapshotted from its topic index under clients_mutex. The
+ * snapshot holds the connections themselves, not their fds, so a client closing meanwhile is
+ * seen as closed instead of its fd being reused by a new client. No lock is held while frames
+ * are queued.
  *
- * @param client_fd The file descriptor of the connected client socket.
+ * @param msg_grp Group of the frame.
+ * @param msg_id Message of the frame.
+ * @param frame The serialized frame, shared by all subscribers.
+ * @param conflate_key Key of frames which may replace each other, -1 if the frame must not be conflated.
+ * @param changed false if the state frame equals the last published one of its topic.
  */
-void ipc_server_handle_client_event(int client_fd)
+void ipc_server_broadcast_frame(int msg_grp, int msg_id, const OutboundFrame &frame, int conflate_key, bool changed)
 {
-    std::cout << "Server handling client connection [" << client_fd << "]..." << std::endl;
-    int handle_result = 0;
-    QueryResult query_result;
-    DataMessage data_message;
+    // Most specific topic first
+    const uint16_t topics[] = {IPC_SERVER_TOPIC_KEY(msg_grp, msg_id),
+                               IPC_SERVER_TOPIC_KEY(msg_grp, MSG_IPC_TOPIC_ANY),
+                               IPC_SERVER_TOPIC_ALL};
+    const size_t topic_count = sizeof(topics) / sizeof(topics[0]);
+    struct Subscriber
+    {
+        std::shared_ptr<IpcConnection> connection;
+        uint32_t interval_ms;
+        uint32_t keyframe_interval_ms;
+    };
+    std::vector<Subscriber> subscribers;
+    uint64_t now_ms = ipc_server_now_ms();
+
+    // One copy for every ring reader, however many there are
+    if (changed && push_broadcast_ring.is_open())
+    {
+        if (push_broadcast_ring.publish(frame->data(), frame->size()))
+            push_counters.ring_frames++;
+        else
+            push_counters.ring_oversized++;
+    }
 
-    // Main processing loop: handle client queries continuously
-    while (true)
+    for (const auto &shard : server_shards)
     {
-        // Try to fetch a query from the client using a thread-safe interface
-        // query_result = server.get_query_with_epoll(client_fd, 1000);
-        query_result = server.get_query(client_fd);
-        // Check the status of the query attempt
-        switch (query_result.status)
+        subscribers.clear();
         {
-        case QueryStatus::Timeout:
-            // No data received within timeout, continue waiting
-            // std::cout << "Server No data from client yet, waiting again..." << std::endl;
-            continue;
-
-        case QueryStatus::Success:
-            // Data received, proceed to process it
-            break;
-
-        case QueryStatus::Disconnected:
-            // Client disconnected, exit loop and clean up
-            std::cout << "Server client [" << client_fd << "] disconnected." << std::endl;
-            [[fallthrough]];
-
-        case QueryStatus::Error:
-        default:
-            // Any other error or invalid socket state, terminate connection
-            std::cerr << "Server connection for client [" << client_fd << "] closing." << std::endl;
-            goto cleanup;
-        }
-        ////////////////////////////////////////////////////////////////////////////////////////////
-        ////////////////////////////////////////////////////////////////////////////////////////////
-        // Call the static function deserializeMessage of the DataMessage class, passing query_result.data byte data for deserialization,
-        // and assign the returned DataMessage object to the data_message variable.
-        data_message = DataMessage::deserializeMessage(query_result.data);
+            std::lock_guard<std::mutex> lock(shard->clients_mutex);
+            for (size_t i = 0; i < topic_count; ++i)
+            {
+                auto it = shard->topic_subscribers.find(topics[i]);
+                if (it == shard->topic_subscribers.end())
+                    continue;
 
-        // Validate the packet before processing
-        if (!data_message.isValid())
-        {
-            std::cerr << "Server Invalid packet received from client [" << client_fd << "]." << std::endl;
-            data_message.printMessage("Server");
-            continue;
+                for (const auto &connection : it->second)
+                {
+                    if (connection->broadcast_ring)
+                        continue;
+
+                    // Skip clients already collected through a more specific topic
+                    bool collected = false;
+                    for (size_t j = 0; j < i && !collected; ++j)
+                        collected = connection->topics.count(topics[j]) > 0;
+                    if (!collected)
+                    {
+                        // Key events are never rate limited
+                        uint32_t interval_ms = (conflate_key >= 0) ? ipc_server_get_push_interval(*connection, topics[0], topics[1]) : 0;
+                        subscribers.push_back({connection, interval_ms, connection->keyframe_interval_ms});
+                    }
+                }
+            }
         }
 
-        // Dispatch to the appropriate handler based on group ID
-        switch (data_message.msg_group)
+        for (const auto &subscriber : subscribers)
         {
-        case MSG_GROUP_HELP:
-            handle_result = ipc_server_handle_help_event(client_fd, data_message); // Help/info request
-            break;
-
-        // case MSG_GROUP_SET:
-        case MSG_GROUP_IPC_CONFIG:
-            handle_result = ipc_server_handle_config_event(client_fd, data_message); // Configuration command
-            break;
-
-        case MSG_GROUP_MCU:
-            handle_result = ipc_server_handle_mcu_event(client_fd, data_message);
-            break;
-        case 3:
-        case 4:
-            handle_result = ipc_server_handle_calculation_event(client_fd, data_message); // Placeholder groups
-            break;
-
-        case MSG_GROUP_CAR:
-            handle_result = ipc_server_handle_car_event(client_fd, data_message); // Vehicle info commands
-            break;
+            if (conflate_key >= 0)
+            {
+                // An unchanged snapshot only goes to clients without it or with a keyframe due
+                IpcPushThrottle &state = subscriber.connection->throttles[conflate_key];
+                if (!changed && state.published &&
+                    (subscriber.keyframe_interval_ms == 0 || now_ms - state.last_published_ms < subscriber.keyframe_interval_ms))
+                {
+                    push_counters.fanout_suppressed++;
+                    continue;
+                }
+                state.published = true;
+                state.last_published_ms = now_ms;
+            }
 
-        default:
-            // Unknown group, fallback to help
-            handle_result = ipc_server_handle_help_event(client_fd, data_message);
-            break;
+            // State pushes go through the latest-value mailbox, only key events queue up
+            if (subscriber.interval_ms > 0)
+                ipc_server_push_throttled(subscriber.connection, frame, conflate_key, subscriber.interval_ms);
+            else
+                ipc_server_enqueue_frame(*subscriber.connection, frame, conflate_key, true);
+            push_counters.fanout_frames++;
+            push_counters.fanout_bytes += frame->size();
         }
-
-        // Log success after handling the message
-        std::cout << "Server handling [Client: " << std::setw(2) << std::setfill('0') << client_fd << "] "
-                  << "[Group: " << std::setw(2) << std::setfill('0') << static_cast<int>(data_message.msg_group) << "] "
-                  << "[Msg: " << std::setw(2) << std::setfill('0') << static_cast<int>(data_message.msg_id) << "] done." << std::endl;
     }
+}
 
-cleanup:
+/**
+ * @brief Queues a short command response (one byte per element) for a client.
+ *
+ * A request carrying a request id gets a framed reply echoing it (see ipc_server_send_reply()),
+ * other requests keep the legacy bare bytes.
+ *
+ * @param client_fd The file descriptor of the client socket.
+ * @param query_msg The request being answered.
+ * @param resp_vector The response values.
+ */
+void ipc_server_send_response(int client_fd, const DataMessageView &query_msg, const std::vector<int> &resp_vector)
+{
+    std::vector<uint8_t> resp_buffer(resp_vector.begin(), resp_vector.end());
+    if (query_msg.request_id != 0)
+        ipc_server_send_reply(client_fd, query_msg, resp_buffer.data(), resp_buffer.size());
+    else
+        ipc_server_send_to_client(client_fd, make_outbound_frame(std::move(resp_buffer)), -1);
+}
 
-    // Gracefully close the client socket and remove from active list
-    close(client_fd);
-    ipc_server_remove_client(client_fd);
-    // server.cleanup_on_disconnect(client_fd);not good
-    std::cout << "Server connection for client [" << client_fd << "] closed." << std::endl;
+/**
+ * @brief Queues the reply to a request: same group and msg, the request id echoed.
+ *
+ * Every request with a request id gets exactly one reply, so a client may pipeline requests and
+ * match the replies as they arrive. Handlers without a result reply with no data.
+ *
+ * @param client_fd The file descriptor of the client socket.
+ * @param query_msg The request being answered.
+ * @param data Reply data, may be nullptr if length is 0.
+ * @param length Number of data bytes.
+ */
+void ipc_server_send_reply(int client_fd, const DataMessageView &query_msg, const uint8_t *data, size_t length)
+{
+    DataMessage reply(query_msg.msg_group, query_msg.msg_id, data, length);
+    reply.request_id = query_msg.request_id;
+    ipc_server_send_to_client(client_fd, make_outbound_frame(reply.serializeMessage()), -1);
 }
 /// @brief /////////////////////////////////////////////////////////////////////////////////////////////////////
 /// @param client_fd
 /// @param query_msg
 /// @return
-int ipc_server_handle_help_event(int client_fd, const DataMessage &query_msg)
+int ipc_server_handle_help_event(int client_fd, const DataMessageView &query_msg)
 {
     // Print the parsed DataMessage for debugging purposes
     query_msg.printMessage("Server help"); // Print the incoming query message for visibility
@@ -420,18 +1995,16 @@ int ipc_server_handle_help_event(int client_fd, const DataMessage &query_msg)
     // Set the response message based on the protocol
     resp_vector[0] = MSG_GROUP_HELP; // Respond with predefined help information message
 
-    // Lock the server mutex to safely send the response to the client
-    {
-        // Ensure thread safety while sending the response back to the client
-        std::lock_guard<std::mutex> lock(server_mutex);
-        server.send_response(client_fd, resp_vector); // Send the help info response to client
-    }
+    // Queue the help info response for the client
+    ipc_server_print_outbound_counters();
+    ipc_server_print_push_counters();
+    ipc_server_send_response(client_fd, query_msg, resp_vector);
 
     // Return success
     return 0;
 }
 
-int ipc_server_handle_config_event(int client_fd, const DataMessage &query_msg)
+int ipc_server_handle_config_event(int client_fd, const DataMessageView &query_msg)
 {
     // Extract the file descriptor from the query data or use the provided one
     int cfd = (query_msg.data.empty() || query_msg.data[0] <= 0) ? client_fd : query_msg.data[0];
@@ -444,15 +2017,73 @@ int ipc_server_handle_config_event(int client_fd, const DataMessage &query_msg)
         ipc_server_update_client(cfd, is_active); // Update the client state (active/inactive)
         std::cout << "Server set client [" << cfd << "] request push:" << is_active << std::endl;
         if ((query_msg.data.size() >= 3))
-            otsm_update_push_interval_ms(query_msg.data[2] * 10);
+        {
+            // The interval applies to this client only, OTSM runs at the fastest one requested
+            ipc_server_set_push_interval(cfd, -1, query_msg.data[2] * 10);
+            ipc_server_update_otsm_push_interval();
+        }
     }
     else if (query_msg.msg_id == MSG_IPC_CMD_CONFIG_PUSH_DELAY)
     {
-        if (otsm_update_push_interval_ms)
+        if (query_msg.data.size() >= 2)
         {
             int time_interval = query_msg.data[1] * 10; // MERGE_BYTES(query_msg.data[1], query_msg.data[2]);
             std::cout << "Server set client [" << cfd << "] time interval:" << time_interval << std::endl;
-            otsm_update_push_interval_ms(time_interval);
+            ipc_server_set_push_interval(cfd, -1, time_interval);
+            ipc_server_update_otsm_push_interval();
+        }
+    }
+    else if (query_msg.msg_id == MSG_IPC_CMD_CONFIG_BROADCAST_RING)
+    {
+        // Data is 1 once the client follows the broadcast ring, 0 to get pushes on the socket again
+        bool enabled = !query_msg.data.empty() && query_msg.data[0] > 0;
+        ipc_server_set_broadcast_reader(client_fd, enabled);
+        std::cout << "Server set client [" << client_fd << "] broadcast ring reader:" << enabled << std::endl;
+    }
+    else if (query_msg.msg_id == MSG_IPC_CMD_CONFIG_CONTAINER)
+    {
+        // Data is 1 once the client unpacks container frames, 0 for one frame per write again
+        bool enabled = !query_msg.data.empty() && query_msg.data[0] > 0;
+        ipc_server_set_container_client(client_fd, enabled);
+        std::cout << "Server set client [" << client_fd << "] container frames:" << enabled << std::endl;
+    }
+    else if (query_msg.msg_id == MSG_IPC_CMD_CONFIG_SHM_RING)
+    {
+        // Data is the requested ring size in KiB (high byte, low byte), 0 for the default
+        size_t capacity = (query_msg.data.size() >= 2) ? MERGE_BYTES(query_msg.data[0], query_msg.data[1]) * 1024 : 0;
+        ipc_server_open_shm_channel(client_fd, capacity, query_msg.request_id);
+        if (query_msg.request_id != 0)
+            return 0; // The channel reply is the reply to the request
+    }
+    else if (query_msg.msg_id == MSG_IPC_CMD_CONFIG_KEYFRAME)
+    {
+        // Data is the keyframe interval in ms (high byte, low byte), 0 disables keyframes
+        uint32_t interval_ms = (query_msg.data.size() >= 2) ? MERGE_BYTES(query_msg.data[0], query_msg.data[1]) : 0;
+        ipc_server_set_keyframe_interval(client_fd, interval_ms);
+        std::cout << "Server set client [" << client_fd << "] keyframe interval:" << interval_ms << std::endl;
+    }
+    else if (query_msg.msg_id == MSG_IPC_CMD_CONFIG_TOPIC_INTERVAL)
+    {
+        // Data is a list of (group, msg_id, interval_ms high byte, interval_ms low byte)
+        for (size_t i = 0; i + 3 < query_msg.data.size(); i += 4)
+        {
+            uint32_t interval_ms = MERGE_BYTES(query_msg.data[i + 2], query_msg.data[i + 3]);
+            ipc_server_set_push_interval(client_fd, IPC_SERVER_TOPIC_KEY(query_msg.data[i], query_msg.data[i + 1]), interval_ms);
+            std::cout << "Server set client [" << client_fd << "] group " << static_cast<int>(query_msg.data[i])
+                      << " msg " << static_cast<int>(query_msg.data[i + 1]) << " time interval:" << interval_ms << std::endl;
+        }
+        ipc_server_update_otsm_push_interval();
+    }
+    else if (query_msg.msg_id == MSG_IPC_CMD_CONFIG_SUBSCRIBE || query_msg.msg_id == MSG_IPC_CMD_CONFIG_UNSUBSCRIBE)
+    {
+        // Data is a list of (group, msg_id) pairs, MSG_IPC_TOPIC_ANY subscribes a whole group
+        bool subscribe = (query_msg.msg_id == MSG_IPC_CMD_CONFIG_SUBSCRIBE);
+        for (size_t i = 0; i + 1 < query_msg.data.size(); i += 2)
+        {
+            ipc_server_subscribe_client(client_fd, query_msg.data[i], query_msg.data[i + 1], subscribe);
+            std::cout << "Server set client [" << client_fd << "] " << (subscribe ? "subscribe" : "unsubscribe")
+                      << " group " << static_cast<int>(query_msg.data[i])
+                      << " msg " << static_cast<int>(query_msg.data[i + 1]) << std::endl;
         }
     }
     else if (query_msg.msg_id == MSG_IPC_CMD_CONFIG_IP)
@@ -469,18 +2100,16 @@ int ipc_server_handle_config_event(int client_fd, const DataMessage &query_msg)
     // Prepare response vector with the set message group
     std::vector<int> resp_vector(1, MSG_GROUP_SET); // Set response to MSG_GROUP_SET
 
-    // Lock the server mutex to safely send the response to the client
-    {
-        std::lock_guard<std::mutex> lock(server_mutex);
-        server.send_response(client_fd, resp_vector); // Send the response to the client
-    }
+    // Queue the response for the client
+    ipc_server_send_response(client_fd, query_msg, resp_vector);
 
     // Return success
     return 0;
 }
 
-int ipc_server_handle_mcu_event(int client_fd, const DataMessage &query_msg)
+int ipc_server_handle_mcu_event(int client_fd, const DataMessageView &query_msg)
 {
+    bool replied = false;
     if (query_msg.msg_id == MSG_IPC_CMD_MCU_REQUEST_UPGRADING) // This task needs to be handled by OTSM
     {
         if (otsm_SendMessage)
@@ -490,13 +2119,63 @@ int ipc_server_handle_mcu_event(int client_fd, const DataMessage &query_msg)
     }
     else if (query_msg.msg_id == MSG_IPC_CMD_MCU_VERSION)
     {
-        ipc_server_notify_mcu_infor_to_client(client_fd, query_msg.msg_group, query_msg.msg_id, NULL, 0);
+        replied = ipc_server_notify_mcu_infor_to_client(client_fd, query_msg.msg_group, query_msg.msg_id, NULL, 0, query_msg.request_id);
     }
+
+    // Commands and unavailable state: an empty reply completes the request
+    if (query_msg.request_id != 0 && !replied)
+        ipc_server_send_reply(client_fd, query_msg, nullptr, 0);
     return 0;
 }
 
+/**
+ * @brief Maps a large payload announced by a MSG_IPC_CMD_CONFIG_LARGE_PAYLOAD descriptor.
+ *
+ * Runs on the reactor thread. The memfd is the next file descriptor the client passed, it arrived
+ * with the first bytes of the descriptor. The reply tells the client whether the payload was
+ * accepted: (group, msg_id, 1) or (group, msg_id, 0).
+ *
+ * @param client_fd The client file descriptor.
+ * @param query_msg The descriptor frame.
+ */
+int ipc_server_handle_large_payload_event(int client_fd, const DataMessageView &query_msg)
+{
+    std::shared_ptr<IpcConnection> connection = ipc_server_find_client(client_fd);
+    uint8_t msg_grp = 0;
+    uint8_t msg_id = 0;
+    size_t size = 0;
+    OctopusLargePayload payload;
+    bool mapped = false;
+    if (connection && large_payload_parse_descriptor(query_msg, &msg_grp, &msg_id, &size) &&
+        !connection->passed_fds.empty())
+    {
+        int memfd = connection->passed_fds.front();
+        connection->passed_fds.pop_front();
+        mapped = payload.map(memfd, size);
+    }
+
+    if (mapped)
+    {
+        std::cout << "Server client [" << client_fd << "] large payload group " << static_cast<int>(msg_grp)
+                  << " msg " << static_cast<int>(msg_id) << ": " << payload.size() << " bytes mapped." << std::endl;
+    }
+    else
+    {
+        std::cerr << "Server client [" << client_fd << "] large payload rejected (missing, unsealed or wrong size)." << std::endl;
+    }
+
+    DataMessage reply;
+    reply.msg_group = MSG_GROUP_IPC_CONFIG;
+    reply.msg_id = MSG_IPC_CMD_CONFIG_LARGE_PAYLOAD;
+    reply.data = {msg_grp, msg_id, static_cast<uint8_t>(mapped ? 1 : 0)};
+    reply.msg_length = reply.data.size();
+    reply.request_id = query_msg.request_id;
+    ipc_server_send_to_client(client_fd, make_outbound_frame(reply.serializeMessage()), -1);
+    return mapped ? 0 : -1;
+}
+
 // Function to handle calculation logic
-int ipc_server_handle_calculation_event(int client_fd, const DataMessage &query_msg)
+int ipc_server_handle_calculation_event(int client_fd, const DataMessageView &query_msg)
 {
     int calc_result = 0;
     std::vector<int> resp_vector(1); // Initialize response vector with one element
@@ -542,17 +2221,15 @@ int ipc_server_handle_calculation_event(int client_fd, const DataMessage &query_
         resp_vector[0] = calc_result;
     }
 
-    // Lock the server mutex to safely send the response to the client
-    {
-        std::lock_guard<std::mutex> lock(server_mutex);
-        server.send_response(client_fd, resp_vector);
-    }
+    // Queue the response for the client
+    ipc_server_send_response(client_fd, query_msg, resp_vector);
 
     return calc_result;
 }
 
-int ipc_server_handle_car_event(int client_fd, const DataMessage &data_message)
+int ipc_server_handle_car_event(int client_fd, const DataMessageView &data_message)
 {
+    bool replied = false;
     switch (data_message.msg_id)
     {
     case MSG_IPC_CMD_CAR_SETTING_SAVE:
@@ -598,54 +2275,62 @@ int ipc_server_handle_car_event(int client_fd, const DataMessage &data_message)
         break;
 
     case MSG_IPC_CMD_CAR_SET_INDICATOR:
-        if (data_message.data.size() >= sizeof(carinfo_indicator_t))
+        if (data_message.data.size() >= sizeof(carinfo_indicator_t) && otsm_get_indicator_info)
         {
-            carinfo_indicator_t *carinfo_indicator = otsm_get_indicator_info();
-            std::memcpy(carinfo_indicator, data_message.data.data(), sizeof(carinfo_indicator_t));
+            ipc_server_write_otsm_state(otsm_indicator_exchange, otsm_get_indicator_info(), data_message.data.data());
             // otsm_SendMessage(TASK_MODULE_IPC, MSG_OTSM_DEVICE_CAR_EVENT, data_message.msg_id, 0);
             otsm_SendMessage(TASK_MODULE_PTL_1, SOC_TO_MCU_MOD_IPC, FRAME_CMD_CAR_SET_INDICATOR, 0);
         }
         break;
 
     case MSG_IPC_CMD_CAR_SET_METER:
-        if (data_message.data.size() >= sizeof(carinfo_meter_t))
+        if (data_message.data.size() >= sizeof(carinfo_meter_t) && otsm_get_meter_info)
         {
-            carinfo_meter_t *carinfo_meter = otsm_get_meter_info();
-            // memcpy(carinfo_meter, &data_message.data, sizeof(carinfo_meter_t));
-            std::memcpy(carinfo_meter, data_message.data.data(), sizeof(carinfo_meter_t));
+            ipc_server_write_otsm_state(otsm_meter_exchange, otsm_get_meter_info(), data_message.data.data());
             otsm_SendMessage(TASK_MODULE_PTL_1, SOC_TO_MCU_MOD_IPC, FRAME_CMD_CAR_SET_METER, 0);
         }
         break;
 
     case MSG_IPC_CMD_CAR_SET_BATTERY:
-        if (data_message.data.size() >= sizeof(carinfo_battery_t))
+        if (data_message.data.size() >= sizeof(carinfo_battery_t) && otsm_get_battery_info)
         {
-            carinfo_battery_t *carinfo_battery = otsm_get_battery_info();
-            // memcpy(carinfo_battery, &data_message.data, sizeof(carinfo_battery_t));
-            std::memcpy(carinfo_battery, data_message.data.data(), sizeof(carinfo_battery_t));
+            ipc_server_write_otsm_state(otsm_battery_exchange, otsm_get_battery_info(), data_message.data.data());
             //  otsm_SendMessage(TASK_MODULE_IPC, MSG_OTSM_DEVICE_CAR_EVENT, data_message.msg_id, 0);
             otsm_SendMessage(TASK_MODULE_PTL_1, SOC_TO_MCU_MOD_IPC, FRAME_CMD_CAR_SET_BATTERY, 0);
         }
         break;
 
+    case MSG_IPC_CMD_CAR_GET_BATCH:
+        ipc_server_send_car_batch(client_fd, data_message);
+        replied = true;
+        break;
+
+    case MSG_IPC_CMD_CAR_GET_IF_MODIFIED:
+        replied = ipc_server_send_car_state_if_modified(client_fd, data_message);
+        break;
+
     default:
-        ipc_server_notify_car_infor_to_client(client_fd, MSG_GROUP_CAR, data_message.msg_id, NULL, 0);
+        replied = ipc_server_notify_car_infor_to_client(client_fd, MSG_GROUP_CAR, data_message.msg_id, NULL, 0, data_message.request_id);
     }
 
+    // SET commands and unavailable state: an empty reply completes the request
+    if (data_message.request_id != 0 && !replied)
+        ipc_server_send_reply(client_fd, data_message, nullptr, 0);
     return 0;
 }
 
 // Main function to notify car info to the client
-void ipc_server_notify_car_infor_to_client(int client_fd, int msg_grp, int msg_id, const uint8_t *data, uint16_t length)
+bool ipc_server_notify_car_infor_to_client(int client_fd, int msg_grp, int msg_id, const uint8_t *data, uint16_t length, uint32_t request_id)
 {
+    bool sent = false;
     switch (msg_id)
     {
     case MSG_IPC_CMD_CAR_GET_INDICATOR_INFO:
     {
-        if (otsm_get_indicator_info)
+        carinfo_indicator_t carinfo_indicator;
+        if (ipc_server_read_otsm_state(otsm_indicator_exchange, otsm_get_indicator_info, carinfo_indicator))
         {
-            carinfo_indicator_t *carinfo_indicator = otsm_get_indicator_info();
-            ipc_server_send_message_to_client(client_fd, msg_grp, msg_id, carinfo_indicator, sizeof(carinfo_indicator_t), "handle_car_infor (Indicator)");
+            sent = ipc_server_send_message_to_client(client_fd, msg_grp, msg_id, &carinfo_indicator, sizeof(carinfo_indicator_t), "handle_car_infor (Indicator)", true, request_id);
         }
         else
         {
@@ -655,10 +2340,10 @@ void ipc_server_notify_car_infor_to_client(int client_fd, int msg_grp, int msg_i
     }
     case MSG_IPC_CMD_CAR_GET_METER_INFO:
     {
-        if (otsm_get_meter_info)
+        carinfo_meter_t carinfo_meter;
+        if (ipc_server_read_otsm_state(otsm_meter_exchange, otsm_get_meter_info, carinfo_meter))
         {
-            carinfo_meter_t *carinfo_meter = otsm_get_meter_info();
-            ipc_server_send_message_to_client(client_fd, msg_grp, msg_id, carinfo_meter, sizeof(carinfo_meter_t), "handle_car_infor (Meter)");
+            sent = ipc_server_send_message_to_client(client_fd, msg_grp, msg_id, &carinfo_meter, sizeof(carinfo_meter_t), "handle_car_infor (Meter)", true, request_id);
         }
         else
         {
@@ -668,10 +2353,10 @@ void ipc_server_notify_car_infor_to_client(int client_fd, int msg_grp, int msg_i
     }
     case MSG_IPC_CMD_CAR_GET_BATTERY_INFO:
     {
-        if (otsm_get_battery_info)
+        carinfo_battery_t carinfo_battery;
+        if (ipc_server_read_otsm_state(otsm_battery_exchange, otsm_get_battery_info, carinfo_battery))
         {
-            carinfo_battery_t *carinfo_battery = otsm_get_battery_info();
-            ipc_server_send_message_to_client(client_fd, msg_grp, msg_id, carinfo_battery, sizeof(carinfo_battery_t), "handle_car_infor (battery)");
+            sent = ipc_server_send_message_to_client(client_fd, msg_grp, msg_id, &carinfo_battery, sizeof(carinfo_battery_t), "handle_car_infor (battery)", true, request_id);
         }
         else
         {
@@ -681,10 +2366,10 @@ void ipc_server_notify_car_infor_to_client(int client_fd, int msg_grp, int msg_i
     }
     case MSG_IPC_CMD_CAR_GET_ERROR_INFO:
     {
-        if (otsm_get_error_info)
+        carinfo_error_t carinfo_error;
+        if (ipc_server_read_otsm_state(otsm_error_exchange, otsm_get_error_info, carinfo_error))
         {
-            carinfo_error_t *carinfo_error = otsm_get_error_info();
-            ipc_server_send_message_to_client(client_fd, msg_grp, msg_id, carinfo_error, sizeof(carinfo_error_t), "handle_car_infor (error)");
+            sent = ipc_server_send_message_to_client(client_fd, msg_grp, msg_id, &carinfo_error, sizeof(carinfo_error_t), "handle_car_infor (error)", true, request_id);
         }
         else
         {
@@ -718,17 +2403,21 @@ void ipc_server_notify_car_infor_to_client(int client_fd, int msg_grp, int msg_i
         // handle_help(client_fd, {0});
         break;
     }
+    return sent;
 }
 
-void ipc_server_notify_mcu_infor_to_client(int client_fd, int msg_grp, int msg_id, const uint8_t *data, uint16_t length)
+bool ipc_server_notify_mcu_infor_to_client(int client_fd, int msg_grp, int msg_id, const uint8_t *data, uint16_t length, uint32_t request_id)
 {
+    bool sent = false;
     switch (msg_id)
     {
     case MSG_IPC_CMD_MCU_UPDATING:
         if (otsm_get_mcu_upgrade_progress_info)
         {
-            mcu_update_progress_t mcu_update_progress = otsm_get_mcu_upgrade_progress_info();
-            ipc_server_send_message_to_client(client_fd, msg_grp, msg_id, &mcu_update_progress, sizeof(mcu_update_progress_t), "handle_mcu_infor (Updating)");
+            mcu_update_progress_t mcu_update_progress;
+            if (!otsm_upgrade_progress_exchange.read(mcu_update_progress))
+                mcu_update_progress = otsm_get_mcu_upgrade_progress_info();
+            sent = ipc_server_send_message_to_client(client_fd, msg_grp, msg_id, &mcu_update_progress, sizeof(mcu_update_progress_t), "handle_mcu_infor (Updating)", true, request_id);
         }
         else
         {
@@ -737,45 +2426,100 @@ void ipc_server_notify_mcu_infor_to_client(int client_fd, int msg_grp, int msg_i
         break;
 
     case MSG_IPC_CMD_MCU_VERSION:
-        if (otsm_get_mcu_flash_meta_infor)
+        flash_meta_infor_t flash_meta_infor;
+        if (ipc_server_read_otsm_state(otsm_flash_meta_exchange, otsm_get_mcu_flash_meta_infor, flash_meta_infor))
         {
-            flash_meta_infor_t *flash_meta_infor = otsm_get_mcu_flash_meta_infor();
-            ipc_server_send_message_to_client(client_fd, msg_grp, msg_id, flash_meta_infor, sizeof(flash_meta_infor_t), "handle_mcu_flash_mata_infor (Meta)");
+            sent = ipc_server_send_message_to_client(client_fd, msg_grp, msg_id, &flash_meta_infor, sizeof(flash_meta_infor_t), "handle_mcu_flash_mata_infor (Meta)", true, request_id);
         }
 
         break;
     case MSG_IPC_CMD_KEY_EVENT:
     case MSG_IPC_CMD_KEY_DOWN_EVENT:
     case MSG_IPC_CMD_KEY_UP_EVENT:
-        ipc_server_send_message_to_client(client_fd, msg_grp, msg_id, data, length, "handle_mcu_key_infor (Key)");
+        // Key events must never be conflated
+        sent = ipc_server_send_message_to_client(client_fd, msg_grp, msg_id, data, length, "handle_mcu_key_infor (Key)", false, request_id);
         break;
 
     default:
         break;
     }
+    return sent;
+}
+
+// Shared memory slot mirroring a pushed (group, msg), -1 if the message is not mirrored
+int ipc_server_get_snapshot_slot(int msg_grp, int msg_id)
+{
+    if (msg_grp == MSG_GROUP_CAR)
+    {
+        switch (msg_id)
+        {
+        case MSG_IPC_CMD_CAR_GET_METER_INFO:
+            return SHM_SNAPSHOT_METER;
+        case MSG_IPC_CMD_CAR_GET_INDICATOR_INFO:
+            return SHM_SNAPSHOT_INDICATOR;
+        case MSG_IPC_CMD_CAR_GET_BATTERY_INFO:
+            return SHM_SNAPSHOT_BATTERY;
+        case MSG_IPC_CMD_CAR_GET_ERROR_INFO:
+            return SHM_SNAPSHOT_ERROR;
+        default:
+            return -1;
+        }
+    }
+    if (msg_grp == MSG_GROUP_MCU)
+    {
+        switch (msg_id)
+        {
+        case MSG_IPC_CMD_MCU_VERSION:
+            return SHM_SNAPSHOT_MCU_FLASH_META;
+        case MSG_IPC_CMD_MCU_UPDATING:
+            return SHM_SNAPSHOT_MCU_UPGRADE_PROGRESS;
+        default:
+            return -1;
+        }
+    }
+    return -1;
 }
 
-// Helper function to handle the car info response logic
+// Helper function to handle the car info response logic.
+// client_fd may be IPC_SERVER_BROADCAST_FD, the frame is then serialized once for all push clients.
+// A reply to a request carrying request_id echoes it and is never conflated with other frames.
 template <typename T>
-void ipc_server_send_message_to_client(int client_fd, int msg_grp, int msg_id, T *t_info, size_t size, const std::string &info_type)
+bool ipc_server_send_message_to_client(int client_fd, int msg_grp, int msg_id, T *t_info, size_t size, const std::string &info_type, bool conflatable, uint32_t request_id)
 {
     if (t_info == nullptr)
     {
         std::cout << "Server Error: " << info_type << " returned nullptr!" << std::endl;
-        return;
+        return false;
+    }
+
+    // State pushes: a snapshot equal to the last published one is neither serialized nor fanned out again
+    int conflate_key = (conflatable && request_id == 0) ? ((msg_grp << 8) | msg_id) : -1;
+    bool is_state_push = (client_fd == IPC_SERVER_BROADCAST_FD && conflatable);
+    if (is_state_push && push_change_detection)
+    {
+        const OutboundFrame &last = push_last_snapshots[conflate_key];
+        if (last && last->size() == FrameDecoder::FRAME_BASE_LENGTH + size &&
+            memcmp(last->data() + FrameDecoder::FRAME_BASE_LENGTH, t_info, size) == 0)
+        {
+            push_counters.snapshots_unchanged++;
+            ipc_server_broadcast_frame(msg_grp, msg_id, last, conflate_key, false);
+            return true;
+        }
     }
 
-    // Create a DataMessage to follow the protocol format
-    DataMessage data_msg;
-    data_msg.msg_group = msg_grp; // Set appropriate group based on the info type
-    data_msg.msg_id = msg_id;     // Set message ID based on info type
+    // Mirror the published state into shared memory before the socket fan-out
+    if (client_fd == IPC_SERVER_BROADCAST_FD)
+    {
+        int slot = ipc_server_get_snapshot_slot(msg_grp, msg_id);
+        if (slot >= 0)
+            push_shm_snapshots.publish(slot, t_info, size);
+    }
 
-    // Directly copy the car info data into the msg.data vector
-    data_msg.data.clear(); // Clear any existing data
-    data_msg.data.insert(data_msg.data.end(), reinterpret_cast<const uint8_t *>(t_info), reinterpret_cast<const uint8_t *>(t_info) + size);
-    data_msg.msg_length = data_msg.data.size();
+    // Create a DataMessage to follow the protocol format, the car info is small enough to stay inline
+    DataMessage data_msg(msg_grp, msg_id, reinterpret_cast<const uint8_t *>(t_info), size);
+    data_msg.request_id = request_id;
 
-    // Serialize the DataMessage into the protocol format
+    // Serialize the DataMessage into the protocol format, one exact allocation shared by all receivers
     std::vector<uint8_t> serialized_data = data_msg.serializeMessage();
     size_t data_size = serialized_data.size();
     uint8_t *buffer = reinterpret_cast<uint8_t *>(serialized_data.data());
@@ -786,11 +2530,20 @@ void ipc_server_send_message_to_client(int client_fd, int msg_grp, int msg_id, T
         std::cout << "Server handling client [" << client_fd << "] " << info_type << " " << data_size << " bytes: ";
         server.printf_buffer_bytes(buffer, data_size);
     }
-    // Lock the server mutex to safely send the response to the client
+    // Queue the frame, state snapshots of the same (group, msg) may replace each other
+    OutboundFrame frame = make_outbound_frame(std::move(serialized_data));
+    if (is_state_push)
+    {
+        push_counters.snapshots_changed++;
+        push_last_snapshots[conflate_key] = frame;
+    }
+
+    if (client_fd == IPC_SERVER_BROADCAST_FD)
     {
-        std::lock_guard<std::mutex> lock(server_mutex);
-        server.send_buff(client_fd, buffer, data_size);
+        ipc_server_broadcast_frame(msg_grp, msg_id, frame, conflate_key);
+        return true;
     }
+    return ipc_server_send_to_client(client_fd, frame, conflate_key);
 }
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -903,6 +2656,53 @@ void ipc_server_initialize_otsm()
     /// initialize_func();
 }
 
+// Creates the push eventfd and the shared memory snapshots, must run before OTSM may call back
+bool ipc_server_initialize_push()
+{
+    push_event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (push_event_fd == -1)
+    {
+        std::cerr << "Server Failed to create push eventfd: " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    // Not fatal: clients fall back to requesting the state over the socket
+    if (!push_shm_snapshots.open())
+        std::cerr << "Server Failed to open shared memory snapshots " << SHM_SNAPSHOT_NAME << std::endl;
+    if (!push_broadcast_ring.open())
+        std::cerr << "Server Failed to open shared memory broadcast ring " << SHM_BROADCAST_NAME << std::endl;
+    return true;
+}
+
+// Starts the push dispatcher, pushes queued since OTSM started are delivered now
+bool ipc_server_start_push_dispatcher()
+{
+    push_timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (push_timer_fd == -1)
+    {
+        std::cerr << "Server Failed to create push timerfd: " << strerror(errno) << std::endl;
+        return false;
+    }
+    push_window_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (push_window_fd == -1)
+    {
+        std::cerr << "Server Failed to create push window timerfd: " << strerror(errno) << std::endl;
+        return false;
+    }
+    push_timer_wheel.reset(new OctopusTimerWheel(IPC_PUSH_WHEEL_TICK_MS, IPC_PUSH_WHEEL_SLOTS, ipc_server_now_ms()));
+
+    if (!push_reactor.start("Server Push"))
+        return false;
+    if (!push_reactor.add_fd(push_event_fd, EPOLLIN, ipc_server_handle_push_event) ||
+        !push_reactor.add_fd(push_timer_fd, EPOLLIN, ipc_server_handle_push_timer) ||
+        !push_reactor.add_fd(push_window_fd, EPOLLIN, ipc_server_handle_push_window))
+        return false;
+
+    // Drain whatever OTSM queued before the dispatcher was listening
+    ipc_server_handle_push_event(push_event_fd, EPOLLIN);
+    return true;
+}
+
 void ipc_server_initialize_server()
 {
     std::cout << "[Server] Initialization started." << std::endl;
@@ -945,6 +2745,17 @@ void ipc_server_initialize_server()
         return;
     }
 
+    // The seqpacket endpoint is optional, stream clients are served without it
+    server_seqpacket.set_socket_type(SOCK_SEQPACKET);
+    server_seqpacket.set_socket_path(seqpacket_socket_path);
+    socket_fd_server_seqpacket = server_seqpacket.open_socket();
+    if (socket_fd_server_seqpacket < 0 || !server_seqpacket.bind_server_to_socket(socket_fd_server_seqpacket) ||
+        !server_seqpacket.start_listening(socket_fd_server_seqpacket))
+    {
+        std::cerr << "[Server] Seqpacket endpoint unavailable, serving the stream endpoint only." << std::endl;
+        socket_fd_server_seqpacket = -1;
+    }
+
     // Optional: set buffer sizes
     // server.query_buffer_size = 20;
     // server.respo_buffer_size = 20;
@@ -952,43 +2763,201 @@ void ipc_server_initialize_server()
     std::cout << "Server Waiting for client connections..." << std::endl;
 }
 
-int main()
+/**
+ * @brief Registers an accepted client and hands it over to the reactor of its shard.
+ * @param client_fd The accepted client socket.
+ * @param seqpacket The client connected to the SOCK_SEQPACKET endpoint.
+ */
+void ipc_server_accept_client(int client_fd, bool seqpacket)
+{
+    // The reactor must never block on a single client
+    if (!server.set_non_blocking(client_fd))
+    {
+        close(client_fd);
+        return;
+    }
+
+    // Lock the clients mutex to safely modify the active clients set
+    auto connection = std::make_shared<IpcConnection>(client_fd, "", true);
+    connection->seqpacket = seqpacket;
+    ipc_server_add_client(connection);
+
+    // Let the reactor of the owning shard drive the client communication
+    {
+        std::lock_guard<std::mutex> lock(connection->send_mutex);
+        auto handler = [connection](int, uint32_t events)
+        { ipc_server_handle_client_event(connection, events); };
+        auto receive = [connection](int, const uint8_t *data, ssize_t length, std::vector<int> &received_fds)
+        { ipc_server_handle_client_data(connection, data, length, received_fds); };
+
+        // io_uring receives stream data into provided buffers, seqpacket clients read whole packets themselves
+        OctopusReactor &reactor = ipc_server_get_shard(client_fd).reactor;
+        connection->uring_receiver = !seqpacket && reactor.get_backend() == ReactorBackend::IoUring;
+        bool registered = connection->uring_receiver ? reactor.add_receiver(client_fd, EPOLLIN | EPOLLRDHUP, handler, receive)
+                                                     : reactor.add_fd(client_fd, EPOLLIN | EPOLLRDHUP, handler);
+        if (!registered)
+        {
+            ipc_server_remove_client(client_fd);
+            connection->closed = true;
+            close(client_fd);
+            return;
+        }
+        // Frames queued before the reactor watched the socket could not arm EPOLLOUT
+        ipc_server_flush_client(*connection);
+    }
+    std::cout << "Server handling " << (seqpacket ? "seqpacket" : "stream") << " client connection [" << client_fd << "]..." << std::endl;
+}
+
+/**
+ * @brief Accepts the clients of both endpoints with multishot accepts on the first reactor.
+ * @return false if the reactors do not run on io_uring, the main thread then accepts.
+ */
+bool ipc_server_start_acceptors()
+{
+    OctopusReactor &reactor = server_shards[0]->reactor;
+    if (reactor.get_backend() != ReactorBackend::IoUring)
+        return false;
+
+    auto handler = [](int listen_fd, int client_fd)
+    {
+        std::cout << "Server Accepted client connection [" << client_fd << "]" << std::endl;
+        ipc_server_accept_client(client_fd, listen_fd == socket_fd_server_seqpacket);
+    };
+    if (!reactor.add_acceptor(socket_fd_server, handler))
+        return false;
+    if (socket_fd_server_seqpacket >= 0 && !reactor.add_acceptor(socket_fd_server_seqpacket, handler))
+        std::cerr << "Server Failed to accept on the seqpacket endpoint" << std::endl;
+    return true;
+}
+
+/**
+ * @brief Parses the server command line options.
+ *
+ *   --reactors, -r N       Number of reactor shards (default: one per core)
+ *   --queue-bytes N        Outbound queue limit per client in bytes
+ *   --slow-consumer P      drop-oldest | drop-connection | conflate
+ *   --change-detection P   on | off
+ *   --backend B            epoll | io_uring (falls back to epoll if unavailable)
+ *   --container-window-us N  Time pushes to container clients are gathered (default 0: per drain)
+ *   --otsm-push-interval-ms N  OTSM's own push interval, restored when no client requests one
+ *
+ * @return The number of reactor shards to start.
+ */
+size_t ipc_server_parse_arguments(int argc, char *argv[])
+{
+    size_t reactor_count = 0;
+    for (int i = 1; i + 1 < argc; ++i)
+    {
+        if (strcmp(argv[i], "--reactors") == 0 || strcmp(argv[i], "-r") == 0)
+        {
+            reactor_count = static_cast<size_t>(std::max(0, atoi(argv[i + 1])));
+        }
+        else if (strcmp(argv[i], "--queue-bytes") == 0)
+        {
+            outbound_queue_max_bytes = static_cast<size_t>(std::max(1024, atoi(argv[i + 1])));
+        }
+        else if (strcmp(argv[i], "--slow-consumer") == 0)
+        {
+            if (strcmp(argv[i + 1], "drop-connection") == 0)
+                outbound_queue_policy = SlowConsumerPolicy::DropConnection;
+            else if (strcmp(argv[i + 1], "conflate") == 0)
+                outbound_queue_policy = SlowConsumerPolicy::Conflate;
+            else
+                outbound_queue_policy = SlowConsumerPolicy::DropOldest;
+        }
+        else if (strcmp(argv[i], "--change-detection") == 0)
+        {
+            push_change_detection = (strcmp(argv[i + 1], "off") != 0);
+        }
+        else if (strcmp(argv[i], "--backend") == 0)
+        {
+            server_reactor_backend = (strcmp(argv[i + 1], "io_uring") == 0) ? ReactorBackend::IoUring : ReactorBackend::Epoll;
+        }
+        else if (strcmp(argv[i], "--container-window-us") == 0)
+        {
+            container_window_us = static_cast<uint32_t>(std::max(0, atoi(argv[i + 1])));
+        }
+        else if (strcmp(argv[i], "--otsm-push-interval-ms") == 0)
+        {
+            otsm_default_push_interval_ms = static_cast<uint32_t>(std::max(1, atoi(argv[i + 1])));
+        }
+    }
+
+    if (reactor_count == 0)
+    {
+        reactor_count = std::max(1u, std::thread::hardware_concurrency());
+    }
+    return reactor_count;
+}
+
+int main(int argc, char *argv[])
 {
     LOG_CC("\r\n#######################################################################################\r\n");
     LOG_CC("Octopus IPC Socket Server Started Successfully.");
     ////////////////////////////////////////////////////////////////////////////////////////////////////
+    if (!ipc_server_initialize_push())
+        return 1;
     ipc_server_initialize_otsm();
     /// std::this_thread::sleep_for(std::chrono::seconds(1)); // Wait before reconnecting
     ipc_server_initialize_server();
     ////////////////////////////////////////////////////////////////////////////////////////////////////
-    // Main loop to accept and handle client connections
+    ipc_server_create_shards(ipc_server_parse_arguments(argc, argv));
+    for (size_t i = 0; i < server_shards.size(); ++i)
+    {
+        if (!server_shards[i]->reactor.start("Server Reactor " + std::to_string(i), server_reactor_backend))
+        {
+            std::cerr << "Server Failed to start reactor " << i << std::endl;
+            return 1;
+        }
+    }
+    // Pushes are dispatched only once the shards they are delivered to exist
+    if (!ipc_server_start_push_dispatcher())
+    {
+        std::cerr << "Server Failed to start push dispatcher" << std::endl;
+        return 1;
+    }
+    std::cout << "Server running " << server_shards.size() << " reactor(s)." << std::endl;
+    // io_uring: the first reactor accepts, the main thread has nothing left to do
+    if (ipc_server_start_acceptors())
+    {
+        while (true)
+            pause();
+    }
+    // Main loop to accept client connections on both endpoints and hand them over to the reactor
+    pollfd listeners[2] = {{socket_fd_server, POLLIN, 0}, {socket_fd_server_seqpacket, POLLIN, 0}}; // -1 is skipped
     while (true)
     {
-        int client_fd = server.wait_and_accept(socket_fd_server);
-
-        // If accepting a client fails, continue to the next iteration
-        if (client_fd < 0)
+        if (poll(listeners, 2, -1) < 0)
         {
-            std::cerr << "Server Failed to accept client connection" << std::endl;
+            if (errno != EINTR)
+                std::cerr << "Server poll on the listening sockets failed: " << strerror(errno) << std::endl;
             continue;
-            // break; for test
         }
 
-        // Lock the clients mutex to safely modify the active clients set
+        for (int i = 0; i < 2; ++i)
         {
-            /// std::lock_guard<std::mutex> lock(clients_mutex);
-            /// active_clients.insert(client_fd);
-            ipc_server_add_client(client_fd, "", true);
-        }
+            if (!(listeners[i].revents & POLLIN))
+                continue;
 
-        // Create a thread to handle the client communication
-        std::thread client_thread(ipc_server_handle_client_event, client_fd);
+            int client_fd = server.wait_and_accept(listeners[i].fd);
 
-        // Detach the thread so it runs independently
-        client_thread.detach();
+            // If accepting a client fails, continue to the next iteration
+            if (client_fd < 0)
+            {
+                std::cerr << "Server Failed to accept client connection" << std::endl;
+                continue;
+                // break; for test
+            }
+            ipc_server_accept_client(client_fd, listeners[i].fd == socket_fd_server_seqpacket);
+        }
     }
 
     // Close the server socket before exiting
+    push_reactor.stop();
+    for (auto &shard : server_shards)
+    {
+        shard->reactor.stop();
+    }
     server.close_socket(socket_fd_server);
     if (otsm_StopRunning)
         otsm_StopRunning();
@@ -0,0 +1,269 @@
+/**
+ * @file octopus_ipc_shm_broadcast.cpp
+ * @brief Implementation of the shared memory broadcast ring.
+ *
+ * @author ak47
+ * @date 2026-10-16
+ */
+#include "octopus_ipc_shm_broadcast.hpp"
+#include <iostream>
+#include <cstring>
+#include <cerrno>
+#include <ctime>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+// Shared (not FUTEX_PRIVATE) futex calls: writer and readers live in different processes
+static long shm_broadcast_futex(const std::atomic<uint32_t> *word, int op, uint32_t value, const timespec *timeout)
+{
+    return syscall(SYS_futex, reinterpret_cast<const uint32_t *>(word), op, value, timeout, nullptr, 0);
+}
+
+OctopusShmBroadcastWriter::OctopusShmBroadcastWriter()
+    : region_(nullptr)
+{
+}
+
+OctopusShmBroadcastWriter::~OctopusShmBroadcastWriter()
+{
+    close();
+}
+
+bool OctopusShmBroadcastWriter::open(const std::string &name)
+{
+    if (region_)
+        return true;
+
+    int fd = shm_open(name.c_str(), O_CREAT | O_RDWR | O_CLOEXEC, 0644);
+    if (fd == -1)
+    {
+        std::cerr << "[ShmBroadcast] shm_open " << name << " failed: " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    if (ftruncate(fd, sizeof(ShmBroadcastRegion)) == -1)
+    {
+        std::cerr << "[ShmBroadcast] ftruncate failed: " << strerror(errno) << std::endl;
+        ::close(fd);
+        return false;
+    }
+
+    void *address = mmap(nullptr, sizeof(ShmBroadcastRegion), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (address == MAP_FAILED)
+    {
+        std::cerr << "[ShmBroadcast] mmap failed: " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    region_ = static_cast<ShmBroadcastRegion *>(address);
+    ShmBroadcastHeader &header = region_->header;
+    if (header.magic != SHM_BROADCAST_MAGIC || header.layout_version != SHM_BROADCAST_LAYOUT_VERSION ||
+        header.slot_count != SHM_BROADCAST_SLOT_COUNT || header.slot_size != SHM_BROADCAST_SLOT_SIZE)
+    {
+        // New or foreign layout, start from scratch. A frame interrupted by a crash needs no
+        // repair otherwise: it was never counted in head and is simply written again.
+        header.magic = 0;
+        std::atomic_thread_fence(std::memory_order_release);
+        for (ShmBroadcastSlot &slot : region_->slots)
+        {
+            slot.sequence.store(0, std::memory_order_relaxed);
+            slot.length = 0;
+        }
+        header.head.store(0, std::memory_order_relaxed);
+        header.wake_seq.store(0, std::memory_order_relaxed);
+        header.waiters.store(0, std::memory_order_relaxed);
+        header.layout_version = SHM_BROADCAST_LAYOUT_VERSION;
+        header.slot_count = SHM_BROADCAST_SLOT_COUNT;
+        header.slot_size = SHM_BROADCAST_SLOT_SIZE;
+        std::atomic_thread_fence(std::memory_order_release);
+        header.magic = SHM_BROADCAST_MAGIC;
+    }
+    return true;
+}
+
+void OctopusShmBroadcastWriter::close()
+{
+    if (!region_)
+        return;
+    munmap(region_, sizeof(ShmBroadcastRegion));
+    region_ = nullptr;
+}
+
+bool OctopusShmBroadcastWriter::publish(const void *frame, size_t length)
+{
+    if (!region_ || length > SHM_BROADCAST_SLOT_DATA)
+        return false;
+
+    ShmBroadcastHeader &header = region_->header;
+    uint64_t sequence = header.head.load(std::memory_order_relaxed);
+    ShmBroadcastSlot &slot = region_->slots[sequence & (SHM_BROADCAST_SLOT_COUNT - 1)];
+
+    // Odd: a reader still copying the previous lap of this slot notices the overwrite
+    slot.sequence.store(2 * sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    memcpy(slot.data, frame, length);
+    slot.length = static_cast<uint32_t>(length);
+    slot.sequence.store(2 * sequence + 2, std::memory_order_release);
+
+    header.head.store(sequence + 1, std::memory_order_release);
+    // Sequentially consistent with the waiters count: a reader registering now sees the new value
+    header.wake_seq.store(static_cast<uint32_t>(sequence + 1), std::memory_order_seq_cst);
+    if (header.waiters.load(std::memory_order_seq_cst) > 0)
+        shm_broadcast_futex(&header.wake_seq, FUTEX_WAKE, 1, nullptr); // The readers chain the rest
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+OctopusShmBroadcastReader::OctopusShmBroadcastReader()
+    : region_(nullptr), header_(nullptr), cursor_(0), lost_frames_(0)
+{
+}
+
+OctopusShmBroadcastReader::~OctopusShmBroadcastReader()
+{
+    close();
+}
+
+bool OctopusShmBroadcastReader::open(const std::string &name)
+{
+    if (region_)
+        return true;
+
+    int fd = shm_open(name.c_str(), O_RDWR | O_CLOEXEC, 0);
+    if (fd == -1)
+        return false; // Server not started yet
+
+    struct stat st;
+    if (fstat(fd, &st) == -1 || static_cast<size_t>(st.st_size) < sizeof(ShmBroadcastRegion))
+    {
+        ::close(fd);
+        return false;
+    }
+
+    void *address = mmap(nullptr, sizeof(ShmBroadcastRegion), PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (address == MAP_FAILED)
+        return false;
+
+    const ShmBroadcastRegion *region = static_cast<const ShmBroadcastRegion *>(address);
+    const ShmBroadcastHeader &header = region->header;
+    if (header.magic != SHM_BROADCAST_MAGIC || header.layout_version != SHM_BROADCAST_LAYOUT_VERSION ||
+        header.slot_count != SHM_BROADCAST_SLOT_COUNT || header.slot_size != SHM_BROADCAST_SLOT_SIZE)
+    {
+        munmap(address, sizeof(ShmBroadcastRegion));
+        return false;
+    }
+
+    // Readers only write the futex word and the waiters count, the frames stay read-only
+    if (mprotect(address, SHM_BROADCAST_HEADER_SIZE, PROT_READ | PROT_WRITE) == -1)
+    {
+        munmap(address, sizeof(ShmBroadcastRegion));
+        return false;
+    }
+
+    region_ = region;
+    header_ = static_cast<ShmBroadcastHeader *>(address);
+    cursor_ = header.head.load(std::memory_order_acquire);
+    lost_frames_ = 0;
+    return true;
+}
+
+void OctopusShmBroadcastReader::close()
+{
+    if (!region_)
+        return;
+    munmap(const_cast<ShmBroadcastRegion *>(region_), sizeof(ShmBroadcastRegion));
+    region_ = nullptr;
+    header_ = nullptr;
+}
+
+void OctopusShmBroadcastReader::skip_to_oldest(uint64_t head)
+{
+    // Half a ring of headroom, so a slow reader is not lapped again right away
+    uint64_t resume = (head > SHM_BROADCAST_SLOT_COUNT / 2) ? head - SHM_BROADCAST_SLOT_COUNT / 2 : 0;
+    if (resume > cursor_)
+    {
+        lost_frames_ += resume - cursor_;
+        cursor_ = resume;
+    }
+    else
+    {
+        lost_frames_++;
+        cursor_++;
+    }
+}
+
+ShmBroadcastResult OctopusShmBroadcastReader::read(uint8_t *buffer, size_t *length)
+{
+    if (!region_)
+        return ShmBroadcastResult::Empty;
+
+    const ShmBroadcastHeader &header = region_->header;
+    uint64_t head = header.head.load(std::memory_order_acquire);
+    if (cursor_ > head)
+        cursor_ = head; // The ring was recreated, follow the new sequence
+    if (cursor_ == head)
+        return ShmBroadcastResult::Empty;
+    if (head - cursor_ >= SHM_BROADCAST_SLOT_COUNT)
+    {
+        skip_to_oldest(head);
+        return ShmBroadcastResult::Overrun;
+    }
+
+    const ShmBroadcastSlot &slot = region_->slots[cursor_ & (SHM_BROADCAST_SLOT_COUNT - 1)];
+    uint64_t expected = 2 * cursor_ + 2;
+    if (slot.sequence.load(std::memory_order_acquire) != expected)
+    {
+        skip_to_oldest(header.head.load(std::memory_order_acquire));
+        return ShmBroadcastResult::Overrun;
+    }
+
+    size_t frame_length = slot.length;
+    if (frame_length > SHM_BROADCAST_SLOT_DATA)
+        frame_length = SHM_BROADCAST_SLOT_DATA; // Torn, rejected below
+    memcpy(buffer, slot.data, frame_length);
+
+    // The writer started a new lap on this slot while we copied
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.sequence.load(std::memory_order_relaxed) != expected)
+    {
+        skip_to_oldest(header.head.load(std::memory_order_acquire));
+        return ShmBroadcastResult::Overrun;
+    }
+
+    *length = frame_length;
+    cursor_++;
+    return ShmBroadcastResult::Frame;
+}
+
+bool OctopusShmBroadcastReader::wait(int timeout_ms)
+{
+    if (!region_)
+        return false;
+
+    std::atomic<uint32_t> &wake_seq = header_->wake_seq;
+    uint32_t seen = wake_seq.load(std::memory_order_acquire);
+    if (seen != static_cast<uint32_t>(cursor_))
+        return true;
+
+    // Registered before the value is checked again, so the writer either sees the count or the
+    // futex call sees the new value
+    header_->waiters.fetch_add(1, std::memory_order_seq_cst);
+    if (wake_seq.load(std::memory_order_seq_cst) == seen)
+    {
+        timespec timeout{timeout_ms / 1000, (timeout_ms % 1000) * 1000000L};
+        shm_broadcast_futex(&wake_seq, FUTEX_WAIT, seen, timeout_ms >= 0 ? &timeout : nullptr);
+    }
+    header_->waiters.fetch_sub(1, std::memory_order_seq_cst);
+
+    // Woken by a new frame: wake the next sleeper. A timeout or a spurious wake-up passes nothing on.
+    bool published = wake_seq.load(std::memory_order_acquire) != seen;
+    if (published && header_->waiters.load(std::memory_order_seq_cst) > 0)
+        shm_broadcast_futex(&wake_seq, FUTEX_WAKE, 1, nullptr);
+    return wake_seq.load(std::memory_order_acquire) != static_cast<uint32_t>(cursor_);
+}
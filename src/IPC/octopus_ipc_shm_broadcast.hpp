@@ -0,0 +1,146 @@
+/**
+ * @file octopus_ipc_shm_broadcast.hpp
+ * @brief Single writer, multi reader broadcast ring of push frames in shared memory.
+ *
+ * The IPC server writes every pushed frame exactly once into a ring of fixed size slots in a
+ * POSIX shared memory object. Readers map it read-only and follow the writer with a private
+ * cursor, so the cost of a push does not depend on how many readers there are, and a reader
+ * never slows the writer down: the writer does not know its readers at all.
+ *
+ * Frame n lives in slot n % slot count. Each slot carries the sequence of the frame it holds
+ * (seqlock style: odd while it is being written), which lets a reader detect that the writer
+ * lapped it (overrun) instead of returning a newer frame in place of the one it expected. A
+ * reader that was overrun skips ahead and learns how many frames it lost.
+ *
+ * Waiting readers sleep on a futex in the header and count themselves in it, so the writer skips
+ * the wake-up system call while nobody sleeps. Otherwise it wakes one reader, and every reader
+ * woken by a new frame wakes the next one: the writer's cost stays the same however many readers
+ * are parked. The header page is the only part a reader maps writable.
+ *
+ * @author ak47
+ * @date 2026-10-16
+ */
+#ifndef OCTOPUS_IPC_SHM_BROADCAST_HPP
+#define OCTOPUS_IPC_SHM_BROADCAST_HPP
+
+#include <atomic>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+#define SHM_BROADCAST_NAME "/octopus_ipc_broadcast" // i.e. /dev/shm/octopus_ipc_broadcast
+#define SHM_BROADCAST_MAGIC 0x4F434252u            // "OCBR"
+#define SHM_BROADCAST_LAYOUT_VERSION 2
+#define SHM_BROADCAST_HEADER_SIZE 4096             // The header has a page of its own, writable by readers
+#define SHM_BROADCAST_SLOT_COUNT 1024              // Power of two
+#define SHM_BROADCAST_SLOT_SIZE 512                // Slot including its 16 byte header
+#define SHM_BROADCAST_SLOT_DATA (SHM_BROADCAST_SLOT_SIZE - 16) // Largest frame carried by the ring
+
+struct ShmBroadcastHeader
+{
+    uint32_t magic;          ///< SHM_BROADCAST_MAGIC once initialized
+    uint32_t layout_version; ///< SHM_BROADCAST_LAYOUT_VERSION
+    uint32_t slot_count;     ///< SHM_BROADCAST_SLOT_COUNT
+    uint32_t slot_size;      ///< SHM_BROADCAST_SLOT_SIZE
+    alignas(64) std::atomic<uint64_t> head;    ///< Number of frames ever published
+    alignas(64) std::atomic<uint32_t> wake_seq; ///< Low 32 bits of head, futex word of waiting readers
+    alignas(64) std::atomic<uint32_t> waiters;  ///< Readers sleeping on wake_seq, or about to
+};
+
+struct alignas(64) ShmBroadcastSlot
+{
+    std::atomic<uint64_t> sequence; ///< 2n + 2 once frame n is complete, 2n + 1 while it is written
+    uint32_t length;                ///< Frame length
+    uint32_t reserved;
+    uint8_t data[SHM_BROADCAST_SLOT_DATA];
+};
+
+struct ShmBroadcastRegion
+{
+    alignas(64) ShmBroadcastHeader header;
+    alignas(SHM_BROADCAST_HEADER_SIZE) ShmBroadcastSlot slots[SHM_BROADCAST_SLOT_COUNT];
+};
+
+// Outcome of OctopusShmBroadcastReader::read()
+enum class ShmBroadcastResult
+{
+    Frame,   // A frame was copied
+    Empty,   // The reader is level with the writer
+    Overrun, // The writer lapped the reader, frames were lost (see get_lost_frames())
+};
+
+/**
+ * @class OctopusShmBroadcastWriter
+ * @brief Creates the ring and publishes frames into it. There must be a single writer.
+ */
+class OctopusShmBroadcastWriter
+{
+public:
+    OctopusShmBroadcastWriter();
+    ~OctopusShmBroadcastWriter();
+
+    /**
+     * @brief Creates (or reuses) and maps the ring. A reused ring continues its sequence, so
+     *        readers that survived a server restart simply keep following it.
+     */
+    bool open(const std::string &name = SHM_BROADCAST_NAME);
+    void close();
+    bool is_open() const { return region_ != nullptr; }
+
+    /**
+     * @brief Publishes one frame and wakes the first waiting reader, if any.
+     * @return false if the ring is not open or the frame is larger than SHM_BROADCAST_SLOT_DATA.
+     */
+    bool publish(const void *frame, size_t length);
+
+private:
+    ShmBroadcastRegion *region_;
+};
+
+/**
+ * @class OctopusShmBroadcastReader
+ * @brief Follows the ring with a private cursor. Not thread safe, one reader per thread.
+ */
+class OctopusShmBroadcastReader
+{
+public:
+    OctopusShmBroadcastReader();
+    ~OctopusShmBroadcastReader();
+
+    /**
+     * @brief Maps the ring read-only, except for the header page. Reading starts with the next
+     *        frame published.
+     */
+    bool open(const std::string &name = SHM_BROADCAST_NAME);
+    void close();
+    bool is_open() const { return region_ != nullptr; }
+
+    /**
+     * @brief Copies the next frame.
+     * @param buffer Receives the frame, at least SHM_BROADCAST_SLOT_DATA bytes.
+     * @param length Receives the frame length.
+     */
+    ShmBroadcastResult read(uint8_t *buffer, size_t *length);
+
+    /**
+     * @brief Sleeps until the writer published a frame the reader did not read yet.
+     *
+     * A reader woken by a new frame passes the wake-up on to the next sleeping reader.
+     * @param timeout_ms Longest wait, -1 for no limit.
+     * @return true if a frame may be available.
+     */
+    bool wait(int timeout_ms);
+
+    /// Frames skipped because the writer lapped this reader.
+    uint64_t get_lost_frames() const { return lost_frames_; }
+
+private:
+    void skip_to_oldest(uint64_t head);
+
+    const ShmBroadcastRegion *region_;
+    ShmBroadcastHeader *header_; ///< Writable view of region_->header, for the futex and waiters
+    uint64_t cursor_;      ///< Sequence of the next frame to read
+    uint64_t lost_frames_; ///< Frames lost to overruns
+};
+
+#endif // OCTOPUS_IPC_SHM_BROADCAST_HPP
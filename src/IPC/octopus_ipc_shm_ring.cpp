@@ -0,0 +1,307 @@
+/**
+ * @file octopus_ipc_shm_ring.cpp
+ * @brief Implementation of the memfd backed SPSC rings and the shared memory channel.
+ *
+ * @author ak47
+ * @date 2026-10-16
+ */
+#include "octopus_ipc_shm_ring.hpp"
+#include <iostream>
+#include <algorithm>
+#include <new>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/eventfd.h>
+
+OctopusShmRing::OctopusShmRing()
+    : header_(nullptr), data_(nullptr), capacity_(0), mapping_size_(0)
+{
+}
+
+OctopusShmRing::~OctopusShmRing()
+{
+    detach();
+}
+
+int OctopusShmRing::create(size_t capacity)
+{
+    size_t rounded = SHM_RING_MIN_CAPACITY;
+    while (rounded < capacity && rounded < SHM_RING_MAX_CAPACITY)
+        rounded <<= 1;
+
+    int fd = memfd_create("octopus_ipc_ring", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (fd == -1)
+    {
+        std::cerr << "[ShmRing] memfd_create failed: " << strerror(errno) << std::endl;
+        return -1;
+    }
+
+    // The peer must not be able to shrink the file under our mapping (SIGBUS)
+    size_t size = sizeof(ShmRingHeader) + rounded;
+    if (ftruncate(fd, size) == -1 ||
+        fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL) == -1)
+    {
+        std::cerr << "[ShmRing] sizing ring failed: " << strerror(errno) << std::endl;
+        close(fd);
+        return -1;
+    }
+
+    void *address = mmap(nullptr, sizeof(ShmRingHeader), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (address == MAP_FAILED)
+    {
+        close(fd);
+        return -1;
+    }
+    ShmRingHeader *header = new (address) ShmRingHeader();
+    header->capacity = static_cast<uint32_t>(rounded);
+    header->head.store(0, std::memory_order_relaxed);
+    header->tail.store(0, std::memory_order_relaxed);
+    header->reader_parked.store(1, std::memory_order_relaxed); // The first frame always wakes the reader
+    header->writer_parked.store(0, std::memory_order_relaxed);
+    header->magic = SHM_RING_MAGIC;
+    munmap(address, sizeof(ShmRingHeader));
+    return fd;
+}
+
+bool OctopusShmRing::attach(int memfd)
+{
+    detach();
+
+    struct stat st;
+    if (fstat(memfd, &st) == -1 || static_cast<size_t>(st.st_size) <= sizeof(ShmRingHeader))
+        return false;
+
+    size_t size = static_cast<size_t>(st.st_size);
+    void *address = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, memfd, 0);
+    if (address == MAP_FAILED)
+        return false;
+
+    ShmRingHeader *header = static_cast<ShmRingHeader *>(address);
+    size_t capacity = header->capacity;
+    if (header->magic != SHM_RING_MAGIC || capacity == 0 || (capacity & (capacity - 1)) != 0 ||
+        sizeof(ShmRingHeader) + capacity != size)
+    {
+        munmap(address, size);
+        return false;
+    }
+
+    header_ = header;
+    data_ = static_cast<uint8_t *>(address) + sizeof(ShmRingHeader);
+    capacity_ = capacity;
+    mapping_size_ = size;
+    return true;
+}
+
+void OctopusShmRing::detach()
+{
+    if (!header_)
+        return;
+    munmap(header_, mapping_size_);
+    header_ = nullptr;
+    data_ = nullptr;
+    capacity_ = 0;
+    mapping_size_ = 0;
+}
+
+bool OctopusShmRing::write(const void *data, size_t length)
+{
+    if (!header_)
+        return false;
+
+    uint64_t head = header_->head.load(std::memory_order_relaxed);
+    uint64_t tail = header_->tail.load(std::memory_order_acquire);
+    uint64_t used = head - tail;
+    if (used > capacity_ || capacity_ - used < length)
+        return false;
+
+    size_t offset = head & (capacity_ - 1);
+    size_t first = std::min(length, capacity_ - offset);
+    memcpy(data_ + offset, data, first);
+    memcpy(data_, static_cast<const uint8_t *>(data) + first, length - first);
+
+    header_->head.store(head + length, std::memory_order_release);
+    return true;
+}
+
+ssize_t OctopusShmRing::read(void *buffer, size_t max_length)
+{
+    if (!header_)
+        return -1;
+
+    uint64_t tail = header_->tail.load(std::memory_order_relaxed);
+    uint64_t head = header_->head.load(std::memory_order_acquire);
+    uint64_t available = head - tail;
+    if (available > capacity_)
+        return -1;
+
+    size_t length = std::min<uint64_t>(available, max_length);
+    size_t offset = tail & (capacity_ - 1);
+    size_t first = std::min(length, capacity_ - offset);
+    memcpy(buffer, data_ + offset, first);
+    memcpy(static_cast<uint8_t *>(buffer) + first, data_, length - first);
+
+    header_->tail.store(tail + length, std::memory_order_release);
+    return static_cast<ssize_t>(length);
+}
+
+bool OctopusShmRing::park_reader()
+{
+    // Flag first, then look again: either the writer sees the flag or we see its data
+    header_->reader_parked.store(1, std::memory_order_seq_cst);
+    uint64_t tail = header_->tail.load(std::memory_order_relaxed);
+    if (header_->head.load(std::memory_order_seq_cst) != tail)
+    {
+        header_->reader_parked.store(0, std::memory_order_relaxed);
+        return false;
+    }
+    return true;
+}
+
+bool OctopusShmRing::park_writer(size_t length)
+{
+    header_->writer_parked.store(1, std::memory_order_seq_cst);
+    uint64_t head = header_->head.load(std::memory_order_relaxed);
+    uint64_t used = head - header_->tail.load(std::memory_order_seq_cst);
+    if (used <= capacity_ && capacity_ - used >= length)
+    {
+        header_->writer_parked.store(0, std::memory_order_relaxed);
+        return false;
+    }
+    return true;
+}
+
+bool OctopusShmRing::take_parked_reader()
+{
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    return header_->reader_parked.load(std::memory_order_relaxed) != 0 &&
+           header_->reader_parked.exchange(0, std::memory_order_acq_rel) != 0;
+}
+
+bool OctopusShmRing::take_parked_writer()
+{
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    return header_->writer_parked.load(std::memory_order_relaxed) != 0 &&
+           header_->writer_parked.exchange(0, std::memory_order_acq_rel) != 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+OctopusShmChannel::OctopusShmChannel()
+    : wake_fd_(-1), peer_wake_fd_(-1)
+{
+}
+
+OctopusShmChannel::~OctopusShmChannel()
+{
+    close();
+}
+
+bool OctopusShmChannel::create(size_t capacity, int peer_fds[SHM_CHANNEL_FD_COUNT])
+{
+    close();
+    std::fill(peer_fds, peer_fds + SHM_CHANNEL_FD_COUNT, -1);
+
+    // Peer order: its rx ring (our tx), its tx ring (our rx), its wake fd, our wake fd
+    peer_fds[0] = OctopusShmRing::create(capacity);
+    peer_fds[1] = OctopusShmRing::create(capacity);
+    wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    peer_wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wake_fd_ >= 0)
+        peer_fds[3] = fcntl(wake_fd_, F_DUPFD_CLOEXEC, 0);
+    if (peer_wake_fd_ >= 0)
+        peer_fds[2] = fcntl(peer_wake_fd_, F_DUPFD_CLOEXEC, 0);
+
+    bool ok = std::none_of(peer_fds, peer_fds + SHM_CHANNEL_FD_COUNT, [](int fd)
+                           { return fd < 0; }) &&
+              tx_.attach(peer_fds[0]) && rx_.attach(peer_fds[1]);
+    if (!ok)
+    {
+        std::cerr << "[ShmChannel] create failed: " << strerror(errno) << std::endl;
+        for (int i = 0; i < SHM_CHANNEL_FD_COUNT; ++i)
+        {
+            if (peer_fds[i] >= 0)
+                ::close(peer_fds[i]);
+            peer_fds[i] = -1;
+        }
+        close();
+    }
+    return ok;
+}
+
+bool OctopusShmChannel::attach(const int fds[SHM_CHANNEL_FD_COUNT])
+{
+    close();
+    bool ok = rx_.attach(fds[0]) && tx_.attach(fds[1]);
+
+    // The mappings keep the rings alive, only the eventfds are kept open
+    ::close(fds[0]);
+    ::close(fds[1]);
+    wake_fd_ = fds[2];
+    peer_wake_fd_ = fds[3];
+    if (!ok)
+        close();
+    return ok;
+}
+
+void OctopusShmChannel::close()
+{
+    tx_.detach();
+    rx_.detach();
+    if (wake_fd_ >= 0)
+        ::close(wake_fd_);
+    if (peer_wake_fd_ >= 0)
+        ::close(peer_wake_fd_);
+    wake_fd_ = -1;
+    peer_wake_fd_ = -1;
+}
+
+void OctopusShmChannel::wake_peer()
+{
+    uint64_t one = 1;
+    if (::write(peer_wake_fd_, &one, sizeof(one)) < 0 && errno != EAGAIN)
+        std::cerr << "[ShmChannel] wake failed: " << strerror(errno) << std::endl;
+}
+
+bool OctopusShmChannel::send(const void *data, size_t length)
+{
+    if (!is_open())
+        return false;
+
+    if (!tx_.write(data, length))
+    {
+        // Full: ask the reader for a wakeup, unless it made room in the meantime
+        if (tx_.park_writer(length) || !tx_.write(data, length))
+            return false;
+    }
+
+    if (tx_.take_parked_reader())
+        wake_peer();
+    return true;
+}
+
+ssize_t OctopusShmChannel::receive(void *buffer, size_t max_length)
+{
+    if (!is_open())
+        return -1;
+
+    ssize_t received = rx_.read(buffer, max_length);
+    if (received > 0 && rx_.take_parked_writer())
+        wake_peer();
+    return received;
+}
+
+bool OctopusShmChannel::park()
+{
+    return is_open() && rx_.park_reader();
+}
+
+void OctopusShmChannel::clear_wake()
+{
+    uint64_t count;
+    while (::read(wake_fd_, &count, sizeof(count)) > 0)
+    {
+    }
+}
@@ -0,0 +1,175 @@
+/**
+ * @file octopus_ipc_shm_ring.hpp
+ * @brief Shared memory transport: single producer / single consumer byte rings in memfds.
+ *
+ * An OctopusShmRing carries serialized DataMessage frames in one direction. The producer copies a
+ * whole frame in and publishes it by advancing head, the consumer copies bytes out and advances
+ * tail, neither side ever takes a lock or makes a syscall while the other side keeps up.
+ *
+ * Syscalls are only needed to sleep: a side that ran out of data (reader) or space (writer)
+ * "parks" by setting a flag in the ring header and then waits on its eventfd. The other side
+ * writes the eventfd only if it finds the flag set, so a busy peer is never woken needlessly.
+ *
+ * An OctopusShmChannel pairs two rings and two eventfds into a bidirectional endpoint. The
+ * server creates it and hands the peer its end as four file descriptors (SCM_RIGHTS).
+ *
+ * The peer maps the rings writable, so every index read from the header is validated: a
+ * corrupted ring is reported as an error and never leads to an access outside the mapping.
+ *
+ * @author ak47
+ * @date 2026-10-16
+ */
+#ifndef OCTOPUS_IPC_SHM_RING_HPP
+#define OCTOPUS_IPC_SHM_RING_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <sys/types.h>
+
+#define SHM_RING_MAGIC 0x4F43524Eu            // "OCRN"
+#define SHM_RING_MIN_CAPACITY (128 * 1024)    // Holds at least one largest possible frame
+#define SHM_RING_MAX_CAPACITY (4 * 1024 * 1024)
+#define SHM_RING_DEFAULT_CAPACITY (256 * 1024)
+#define SHM_CHANNEL_FD_COUNT 4                // rx ring, tx ring, own wake eventfd, peer wake eventfd
+
+struct ShmRingHeader
+{
+    uint32_t magic;                            ///< SHM_RING_MAGIC
+    uint32_t capacity;                         ///< Data bytes, a power of two
+    alignas(64) std::atomic<uint64_t> head;    ///< Bytes ever written, advanced by the writer only
+    alignas(64) std::atomic<uint64_t> tail;    ///< Bytes ever read, advanced by the reader only
+    alignas(64) std::atomic<uint32_t> reader_parked; ///< Reader waits on its eventfd for data
+    std::atomic<uint32_t> writer_parked;             ///< Writer waits on its eventfd for space
+};
+
+/**
+ * @class OctopusShmRing
+ * @brief One direction of the shared memory transport. One writer, one reader.
+ */
+class OctopusShmRing
+{
+public:
+    OctopusShmRing();
+    ~OctopusShmRing();
+
+    /**
+     * @brief Creates and initializes a sealed memfd holding a ring.
+     * @param capacity Requested data size, clamped and rounded up to a power of two.
+     * @return The memfd, -1 on failure. The caller owns it.
+     */
+    static int create(size_t capacity);
+
+    /**
+     * @brief Maps a ring created by create(). The fd may be closed afterwards.
+     */
+    bool attach(int memfd);
+    void detach();
+    bool is_attached() const { return header_ != nullptr; }
+    size_t get_capacity() const { return capacity_; }
+
+    /**
+     * @brief Copies a whole frame into the ring.
+     * @return false if the ring has no room for it (or is corrupted), nothing is written then.
+     */
+    bool write(const void *data, size_t length);
+
+    /**
+     * @brief Copies up to max_length available bytes out of the ring.
+     * @return Bytes copied, 0 if empty, -1 if the peer corrupted the indices.
+     */
+    ssize_t read(void *buffer, size_t max_length);
+
+    /**
+     * @brief Reader side: announce that the reader is about to sleep.
+     * @return true if the reader may wait for a wakeup, false if data arrived meanwhile.
+     */
+    bool park_reader();
+
+    /**
+     * @brief Writer side: announce that the writer waits for room for length bytes.
+     * @return true if the writer may wait for a wakeup, false if room appeared meanwhile.
+     */
+    bool park_writer(size_t length);
+
+    /**
+     * @brief Writer side, after write(): true (once) if the reader is parked and must be woken.
+     */
+    bool take_parked_reader();
+
+    /**
+     * @brief Reader side, after read(): true (once) if the writer is parked and must be woken.
+     */
+    bool take_parked_writer();
+
+private:
+    ShmRingHeader *header_;
+    uint8_t *data_;
+    size_t capacity_;
+    size_t mapping_size_;
+};
+
+/**
+ * @class OctopusShmChannel
+ * @brief Bidirectional shared memory endpoint: a tx ring, an rx ring and two eventfds.
+ *
+ * The own eventfd is signalled when the rx ring got data or the tx ring got room again. Sending
+ * and receiving are not thread safe each, but one thread may send while another one receives.
+ */
+class OctopusShmChannel
+{
+public:
+    OctopusShmChannel();
+    ~OctopusShmChannel();
+
+    /**
+     * @brief Creates both rings and eventfds.
+     * @param capacity Data size of each ring.
+     * @param peer_fds Receives the peer end in the order expected by attach(). The caller owns
+     *                 these descriptors and closes them once they were passed on.
+     */
+    bool create(size_t capacity, int peer_fds[SHM_CHANNEL_FD_COUNT]);
+
+    /**
+     * @brief Opens the peer end of a channel. Takes ownership of every descriptor, even on failure.
+     */
+    bool attach(const int fds[SHM_CHANNEL_FD_COUNT]);
+
+    void close();
+    bool is_open() const { return wake_fd_ >= 0; }
+    size_t get_capacity() const { return tx_.get_capacity(); }
+
+    /**
+     * @brief Sends one whole frame.
+     * @return false if the tx ring is full: the own eventfd is signalled once the peer made room.
+     */
+    bool send(const void *data, size_t length);
+
+    /**
+     * @brief Receives the available bytes, frames may be split across calls.
+     * @return Bytes copied, 0 if nothing is pending, -1 if the ring is corrupted.
+     */
+    ssize_t receive(void *buffer, size_t max_length);
+
+    /**
+     * @brief Announce that the receiver is about to wait on get_wake_fd().
+     * @return false if data is pending, receive() again instead of waiting.
+     */
+    bool park();
+
+    /// Eventfd to wait on, readable when data or room arrived.
+    int get_wake_fd() const { return wake_fd_; }
+
+    /// Resets the eventfd after a wakeup.
+    void clear_wake();
+
+private:
+    void wake_peer();
+
+    OctopusShmRing tx_;
+    OctopusShmRing rx_;
+    int wake_fd_;      ///< Signalled by the peer
+    int peer_wake_fd_; ///< Signalled by us
+};
+
+#endif // OCTOPUS_IPC_SHM_RING_HPP
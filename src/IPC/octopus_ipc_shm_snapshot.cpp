@@ -0,0 +1,202 @@
+/**
+ * @file octopus_ipc_shm_snapshot.cpp
+ * @brief Implementation of the seqlock protected shared memory snapshot region.
+ *
+ * @author ak47
+ * @date 2026-10-16
+ */
+#include "octopus_ipc_shm_snapshot.hpp"
+#include <iostream>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+OctopusShmSnapshotWriter::OctopusShmSnapshotWriter()
+    : region_(nullptr)
+{
+}
+
+OctopusShmSnapshotWriter::~OctopusShmSnapshotWriter()
+{
+    close();
+}
+
+bool OctopusShmSnapshotWriter::open(const std::string &name)
+{
+    if (region_)
+        return true;
+
+    // World readable, only the server writes
+    int fd = shm_open(name.c_str(), O_CREAT | O_RDWR | O_CLOEXEC, 0644);
+    if (fd == -1)
+    {
+        std::cerr << "[ShmSnapshot] shm_open " << name << " failed: " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    if (ftruncate(fd, sizeof(ShmSnapshotRegion)) == -1)
+    {
+        std::cerr << "[ShmSnapshot] ftruncate failed: " << strerror(errno) << std::endl;
+        ::close(fd);
+        return false;
+    }
+
+    void *address = mmap(nullptr, sizeof(ShmSnapshotRegion), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (address == MAP_FAILED)
+    {
+        std::cerr << "[ShmSnapshot] mmap failed: " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    region_ = static_cast<ShmSnapshotRegion *>(address);
+    ShmSnapshotHeader &header = region_->header;
+    if (header.magic != SHM_SNAPSHOT_MAGIC || header.layout_version != SHM_SNAPSHOT_LAYOUT_VERSION ||
+        header.slot_count != SHM_SNAPSHOT_SLOT_COUNT || header.slot_capacity != SHM_SNAPSHOT_SLOT_CAPACITY)
+    {
+        // New or foreign layout, start from scratch
+        header.magic = 0;
+        std::atomic_thread_fence(std::memory_order_release);
+        for (ShmSnapshotSlotData &slot : region_->slots)
+        {
+            slot.sequence.store(0, std::memory_order_relaxed);
+            slot.size = 0;
+            slot.version = 0;
+        }
+        header.layout_version = SHM_SNAPSHOT_LAYOUT_VERSION;
+        header.slot_count = SHM_SNAPSHOT_SLOT_COUNT;
+        header.slot_capacity = SHM_SNAPSHOT_SLOT_CAPACITY;
+        std::atomic_thread_fence(std::memory_order_release);
+        header.magic = SHM_SNAPSHOT_MAGIC;
+    }
+    else
+    {
+        // A previous writer may have died in the middle of a publish
+        for (ShmSnapshotSlotData &slot : region_->slots)
+        {
+            uint32_t sequence = slot.sequence.load(std::memory_order_relaxed);
+            if (sequence & 1)
+                slot.sequence.store(sequence + 1, std::memory_order_release);
+        }
+    }
+    return true;
+}
+
+void OctopusShmSnapshotWriter::close()
+{
+    if (!region_)
+        return;
+    munmap(region_, sizeof(ShmSnapshotRegion));
+    region_ = nullptr;
+}
+
+bool OctopusShmSnapshotWriter::publish(uint32_t slot, const void *data, size_t size)
+{
+    if (!region_ || slot >= SHM_SNAPSHOT_SLOT_COUNT || size > SHM_SNAPSHOT_SLOT_CAPACITY)
+        return false;
+
+    ShmSnapshotSlotData &target = region_->slots[slot];
+    uint32_t sequence = target.sequence.load(std::memory_order_relaxed);
+
+    // Odd: readers retry until the copy is complete
+    target.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    memcpy(target.data, data, size);
+    target.size = static_cast<uint32_t>(size);
+    target.version++;
+
+    target.sequence.store(sequence + 2, std::memory_order_release);
+    return true;
+}
+
+OctopusShmSnapshotReader::OctopusShmSnapshotReader()
+    : region_(nullptr)
+{
+}
+
+OctopusShmSnapshotReader::~OctopusShmSnapshotReader()
+{
+    close();
+}
+
+bool OctopusShmSnapshotReader::open(const std::string &name)
+{
+    if (region_)
+        return true;
+
+    int fd = shm_open(name.c_str(), O_RDONLY | O_CLOEXEC, 0);
+    if (fd == -1)
+        return false; // Server not started yet
+
+    struct stat st;
+    if (fstat(fd, &st) == -1 || static_cast<size_t>(st.st_size) < sizeof(ShmSnapshotRegion))
+    {
+        ::close(fd);
+        return false;
+    }
+
+    void *address = mmap(nullptr, sizeof(ShmSnapshotRegion), PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (address == MAP_FAILED)
+        return false;
+
+    const ShmSnapshotRegion *region = static_cast<const ShmSnapshotRegion *>(address);
+    if (region->header.magic != SHM_SNAPSHOT_MAGIC || region->header.layout_version != SHM_SNAPSHOT_LAYOUT_VERSION)
+    {
+        munmap(address, sizeof(ShmSnapshotRegion));
+        return false;
+    }
+
+    region_ = region;
+    return true;
+}
+
+void OctopusShmSnapshotReader::close()
+{
+    if (!region_)
+        return;
+    munmap(const_cast<ShmSnapshotRegion *>(region_), sizeof(ShmSnapshotRegion));
+    region_ = nullptr;
+}
+
+bool OctopusShmSnapshotReader::read(uint32_t slot, void *buffer, size_t size, uint64_t *version) const
+{
+    if (!region_ || slot >= SHM_SNAPSHOT_SLOT_COUNT || size > SHM_SNAPSHOT_SLOT_CAPACITY)
+        return false;
+
+    const ShmSnapshotSlotData &source = region_->slots[slot];
+    for (int attempt = 0; attempt < SHM_SNAPSHOT_READ_RETRIES; ++attempt)
+    {
+        uint32_t before = source.sequence.load(std::memory_order_acquire);
+        if (before & 1)
+            continue; // Writer busy
+
+        uint32_t published_size = source.size;
+        uint64_t published_version = source.version;
+        memcpy(buffer, source.data, size);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (source.sequence.load(std::memory_order_relaxed) != before)
+            continue; // Torn copy
+
+        if (published_size != size)
+            return false; // Never published, or a struct of another size
+        if (version)
+            *version = published_version;
+        return true;
+    }
+    return false;
+}
+
+uint64_t OctopusShmSnapshotReader::get_version(uint32_t slot) const
+{
+    if (!region_ || slot >= SHM_SNAPSHOT_SLOT_COUNT)
+        return 0;
+
+    // The sequence grows by 2 per publish, no torn 64 bit read to worry about
+    return region_->slots[slot].sequence.load(std::memory_order_acquire) / 2;
+}
@@ -0,0 +1,134 @@
+/**
+ * @file octopus_ipc_shm_snapshot.hpp
+ * @brief Shared memory region publishing the latest vehicle state snapshots.
+ *
+ * The IPC server (the single writer) copies every published carinfo / MCU struct into a slot
+ * of a POSIX shared memory object under /dev/shm. Clients map the object read-only and copy a
+ * slot out without any syscall or server round trip.
+ *
+ * Each slot is guarded by a seqlock: the writer makes the sequence odd, copies the data and
+ * makes it even again. A reader copies the data between two reads of the sequence and accepts
+ * the copy only if both reads returned the same even value. Readers never block the writer and
+ * give up after a bounded number of attempts, so a read always completes in bounded time.
+ *
+ * Layout: [ShmSnapshotHeader][ShmSnapshotSlotData x SHM_SNAPSHOT_SLOT_COUNT], every slot on
+ * its own cache lines.
+ *
+ * @author ak47
+ * @date 2026-10-16
+ */
+#ifndef OCTOPUS_IPC_SHM_SNAPSHOT_HPP
+#define OCTOPUS_IPC_SHM_SNAPSHOT_HPP
+
+#include <atomic>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+#define SHM_SNAPSHOT_NAME "/octopus_ipc_snapshot" // Shared memory object, i.e. /dev/shm/octopus_ipc_snapshot
+#define SHM_SNAPSHOT_MAGIC 0x4F435348u            // "OCSH"
+#define SHM_SNAPSHOT_LAYOUT_VERSION 1             // Bumped whenever the layout changes
+#define SHM_SNAPSHOT_SLOT_CAPACITY 1024           // Largest struct a slot can hold
+#define SHM_SNAPSHOT_READ_RETRIES 64              // Attempts of a reader racing the writer before giving up
+
+// Published snapshots, one slot each
+enum ShmSnapshotSlot : uint32_t
+{
+    SHM_SNAPSHOT_METER = 0,              // carinfo_meter_t
+    SHM_SNAPSHOT_INDICATOR,              // carinfo_indicator_t
+    SHM_SNAPSHOT_BATTERY,                // carinfo_battery_t
+    SHM_SNAPSHOT_ERROR,                  // carinfo_error_t
+    SHM_SNAPSHOT_MCU_FLASH_META,         // flash_meta_infor_t
+    SHM_SNAPSHOT_MCU_UPGRADE_PROGRESS,   // mcu_update_progress_t
+    SHM_SNAPSHOT_SLOT_COUNT
+};
+
+struct ShmSnapshotHeader
+{
+    uint32_t magic;          ///< SHM_SNAPSHOT_MAGIC once the region is initialized
+    uint32_t layout_version; ///< SHM_SNAPSHOT_LAYOUT_VERSION
+    uint32_t slot_count;     ///< Number of slots following the header
+    uint32_t slot_capacity;  ///< Data capacity of a slot
+};
+
+struct alignas(64) ShmSnapshotSlotData
+{
+    std::atomic<uint32_t> sequence; ///< Seqlock sequence, odd while the writer is copying
+    uint32_t size;                  ///< Valid bytes in data, 0 until first published
+    uint64_t version;               ///< Number of times the slot was published
+    uint8_t data[SHM_SNAPSHOT_SLOT_CAPACITY];
+};
+
+struct ShmSnapshotRegion
+{
+    alignas(64) ShmSnapshotHeader header;
+    ShmSnapshotSlotData slots[SHM_SNAPSHOT_SLOT_COUNT];
+};
+
+/**
+ * @class OctopusShmSnapshotWriter
+ * @brief Creates the snapshot region and publishes into it. There must be a single writer.
+ */
+class OctopusShmSnapshotWriter
+{
+public:
+    OctopusShmSnapshotWriter();
+    ~OctopusShmSnapshotWriter();
+
+    /**
+     * @brief Creates (or reuses) and maps the shared memory object.
+     *
+     * An existing region is reused rather than recreated, so clients which mapped it before a
+     * server restart keep seeing the updates.
+     */
+    bool open(const std::string &name = SHM_SNAPSHOT_NAME);
+    void close();
+    bool is_open() const { return region_ != nullptr; }
+
+    /**
+     * @brief Copies a struct into a slot and bumps the slot version.
+     * @return false if the region is not open, the slot is unknown or the data does not fit.
+     */
+    bool publish(uint32_t slot, const void *data, size_t size);
+
+private:
+    ShmSnapshotRegion *region_;
+};
+
+/**
+ * @class OctopusShmSnapshotReader
+ * @brief Maps the snapshot region read-only and copies slots out of it.
+ */
+class OctopusShmSnapshotReader
+{
+public:
+    OctopusShmSnapshotReader();
+    ~OctopusShmSnapshotReader();
+
+    bool open(const std::string &name = SHM_SNAPSHOT_NAME);
+    void close();
+    bool is_open() const { return region_ != nullptr; }
+
+    /**
+     * @brief Copies a consistent snapshot of a slot.
+     *
+     * Never blocks: gives up after SHM_SNAPSHOT_READ_RETRIES attempts racing the writer.
+     *
+     * @param slot Slot to read, see ShmSnapshotSlot.
+     * @param buffer Receives the snapshot.
+     * @param size Size of buffer, must equal the published size.
+     * @param version Optional, receives the slot version (0: never published).
+     * @return true if a consistent snapshot was copied.
+     */
+    bool read(uint32_t slot, void *buffer, size_t size, uint64_t *version = nullptr) const;
+
+    /**
+     * @brief Current version of a slot, cheap enough to poll for changes.
+     */
+    uint64_t get_version(uint32_t slot) const;
+
+private:
+    const ShmSnapshotRegion *region_;
+};
+
+#endif // OCTOPUS_IPC_SHM_SNAPSHOT_HPP
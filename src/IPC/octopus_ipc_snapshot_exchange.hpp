@@ -0,0 +1,121 @@
+/**
+ * @file octopus_ipc_snapshot_exchange.hpp
+ * @brief Versioned double-buffered handoff of state structs between threads.
+ *
+ * A writer publishes a whole snapshot into the buffer readers are not directed to, then switches
+ * the readers over to it. Each buffer carries a sequence number (seqlock style: odd while it is
+ * written), so a reader that is still copying a buffer when the writer comes back to it notices
+ * the overwrite and copies the newer buffer instead. Readers never take a lock and never stall the
+ * writer; a reader only retries if the writer completed a publish and started the next one while
+ * it copied.
+ *
+ * Writers are serialized with a mutex, they are expected to be few and short.
+ *
+ * @author ak47
+ * @date 2026-10-16
+ */
+#ifndef OCTOPUS_IPC_SNAPSHOT_EXCHANGE_HPP
+#define OCTOPUS_IPC_SNAPSHOT_EXCHANGE_HPP
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+/**
+ * @class OctopusSnapshotExchange
+ * @brief Single slot of the latest snapshot of T, published whole, read without locks.
+ */
+template <typename T>
+class OctopusSnapshotExchange
+{
+    static_assert(std::is_trivially_copyable<T>::value, "snapshots are copied with memcpy");
+
+public:
+    OctopusSnapshotExchange()
+        : version_(0)
+    {
+    }
+
+    OctopusSnapshotExchange(const OctopusSnapshotExchange &) = delete;
+    OctopusSnapshotExchange &operator=(const OctopusSnapshotExchange &) = delete;
+
+    /**
+     * @brief Publishes a whole snapshot.
+     * @return The version of the snapshot, 1 for the first one.
+     */
+    uint64_t publish(const T &value)
+    {
+        std::lock_guard<std::mutex> lock(writer_mutex_);
+        uint64_t version = version_.load(std::memory_order_relaxed) + 1;
+        Buffer &buffer = buffers_[version & 1];
+
+        // Odd: a reader still copying this buffer from two publishes ago retries
+        uint32_t sequence = buffer.sequence.load(std::memory_order_relaxed);
+        buffer.sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        memcpy(&buffer.value, &value, sizeof(T));
+        buffer.version = version;
+        buffer.sequence.store(sequence + 2, std::memory_order_release);
+
+        version_.store(version, std::memory_order_release);
+        return version;
+    }
+
+    /**
+     * @brief Copies the latest snapshot.
+     * @param value Receives the snapshot.
+     * @param version Optional, receives the version of the copied snapshot.
+     * @return false if nothing was published yet.
+     */
+    bool read(T &value, uint64_t *version = nullptr) const
+    {
+        for (;;)
+        {
+            // Snapshot n lives in buffer n % 2. Only exactly the version read here is accepted: a
+            // newer snapshot completed in the same buffer may not be visible through version_ yet,
+            // and returning it would let the next read go back to an older version.
+            uint64_t latest = version_.load(std::memory_order_acquire);
+            if (latest == 0)
+                return false;
+
+            const Buffer &buffer = buffers_[latest & 1];
+            uint32_t before = buffer.sequence.load(std::memory_order_acquire);
+            if ((before & 1) || buffer.version != latest)
+            {
+                // The writer already came back to this buffer, the other one is complete by now
+                std::this_thread::yield();
+                continue;
+            }
+
+            memcpy(&value, &buffer.value, sizeof(T));
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (buffer.sequence.load(std::memory_order_relaxed) != before)
+                continue; // Torn copy
+
+            if (version)
+                *version = latest;
+            return true;
+        }
+    }
+
+    /// Version of the latest snapshot, 0 if nothing was published yet.
+    uint64_t get_version() const { return version_.load(std::memory_order_acquire); }
+
+private:
+    struct alignas(64) Buffer
+    {
+        std::atomic<uint32_t> sequence{0}; ///< Even when the buffer is complete, odd while it is written
+        uint64_t version = 0;              ///< Version of the snapshot held
+        T value;                           ///< The snapshot
+    };
+
+    Buffer buffers_[2];
+    std::atomic<uint64_t> version_;  ///< Number of snapshots published, the latest is in buffers_[version_ % 2]
+    std::mutex writer_mutex_;        ///< Serializes writers
+};
+
+#endif // OCTOPUS_IPC_SNAPSHOT_EXCHANGE_HPP
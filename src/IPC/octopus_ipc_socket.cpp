@@ -26,10 +26,12 @@
 #include <thread>
 #include <vector>
 #include <cstring>
+#include <algorithm>
 #include <string>
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <poll.h>
+#include <sys/ioctl.h>
 ///////////////////////////////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////////////////////////////
 #define MAX_EVENTS 10 // Maximum number of events
@@ -41,6 +43,60 @@ static void signal_handler(int signum)
     std::exit(-1);
 }
 
+// recvmsg() into the caller's buffer, file descriptors passed along are appended to received_fds
+static ssize_t socket_receive_with_fds(int socket_fd, uint8_t *buffer, size_t capacity, std::vector<int> &received_fds, int flags = 0)
+{
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int) * IPC_SOCKET_MAX_PASSED_FDS)];
+    iovec iov{buffer, capacity};
+    msghdr msg{};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    ssize_t received = recvmsg(socket_fd, &msg, MSG_CMSG_CLOEXEC | flags);
+    if (received <= 0)
+        return received;
+
+    for (cmsghdr *cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg))
+    {
+        if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS)
+        {
+            size_t fd_count = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+            const int *fds = reinterpret_cast<const int *>(CMSG_DATA(cmsg));
+            received_fds.insert(received_fds.end(), fds, fds + fd_count);
+        }
+    }
+
+    // SOCK_SEQPACKET: the rest of a packet larger than the buffer is lost, never hand out a cut frame
+    if (msg.msg_flags & MSG_TRUNC)
+    {
+        errno = EMSGSIZE;
+        return -1;
+    }
+    return received;
+}
+
+// Bytes queued on the socket (FIONREAD), 0 if none or unknown
+static size_t socket_available_bytes(int socket_fd)
+{
+    int available = 0;
+    if (ioctl(socket_fd, FIONREAD, &available) == -1 || available <= 0)
+        return 0;
+    return static_cast<size_t>(available);
+}
+
+// read() of everything queued on the socket in one call
+static ssize_t socket_read_available(int socket_fd, std::vector<uint8_t> &data)
+{
+    // Nothing queued yet (or a hang-up): a chunk, the read tells which
+    size_t available = socket_available_bytes(socket_fd);
+    data.resize(available > 0 ? available : IPC_SOCKET_QUERY_BUFFER_SIZE);
+    ssize_t bytes_read = read(socket_fd, data.data(), data.size());
+    data.resize(bytes_read > 0 ? static_cast<size_t>(bytes_read) : 0);
+    return bytes_read;
+}
+
 // Constructor for the Socket class
 Socket::Socket()
 {
@@ -57,14 +113,24 @@ Socket::Socket()
 void Socket::init_socket_structor()
 {
     // Initialize socket properties
-    socket_path = "/tmp/octopus/ipc_socket";
     domain = AF_UNIX;   // Domain type: Unix domain socket
     type = SOCK_STREAM; // Type: Stream socket (TCP-like behavior)
     protocol = 0;       // Protocol: Default
+    set_socket_path(IPC_SOCKET_STREAM_PATH);
+}
+
+void Socket::set_socket_path(const std::string &path)
+{
+    socket_path = path;
     // Initialize socket address structure for binding
     memset(&addr, 0, sizeof(struct sockaddr_un));
-    addr.sun_family = AF_UNIX;                                      // Set address family to Unix domain
-    strncpy(addr.sun_path, socket_path, sizeof(addr.sun_path) - 1); // Set socket path
+    addr.sun_family = AF_UNIX;                                              // Set address family to Unix domain
+    strncpy(addr.sun_path, socket_path.c_str(), sizeof(addr.sun_path) - 1); // Set socket path
+}
+
+void Socket::set_socket_type(int socket_type)
+{
+    type = socket_type;
 }
 
 void Socket::init_epoll(int socket_fd)
@@ -254,7 +320,6 @@ int Socket::wait_and_accept(int socket_fd)
 // Read the query from the client
 QueryResult Socket::get_query(int socket_fd)
 {
-    char buffer[IPC_SOCKET_QUERY_BUFFER_SIZE];
     struct pollfd pfd = {socket_fd, POLLIN, 0};
 
     int ret = poll(&pfd, 1, 2000); // 2 秒超时
@@ -276,14 +341,14 @@ QueryResult Socket::get_query(int socket_fd)
         return {QueryStatus::Error, {}};
     }
 
-    int query_bytesRead = read(socket_fd, buffer, sizeof(buffer));
-    if (query_bytesRead <= 0)
+    std::vector<uint8_t> data;
+    if (socket_read_available(socket_fd, data) <= 0)
     {
         // std::cerr << "Socket read failed or client disconnected." << std::endl;
         return {QueryStatus::Disconnected, {}};
     }
 
-    return {QueryStatus::Success, std::vector<uint8_t>(buffer, buffer + query_bytesRead)};
+    return {QueryStatus::Success, data};
 }
 
 // Updated function to use epoll for handling client queries
@@ -321,19 +386,168 @@ QueryResult Socket::get_query_with_epoll(int socket_fd, int timeout_ms)
     // Check if we have a readable event
     if (events[0].events & EPOLLIN)
     {
-        char buffer[IPC_SOCKET_QUERY_BUFFER_SIZE];
-        int query_bytesRead = read(socket_fd, buffer, sizeof(buffer));
-        if (query_bytesRead <= 0)
+        std::vector<uint8_t> data;
+        if (socket_read_available(socket_fd, data) <= 0)
         {
             return {QueryStatus::Disconnected, {}};
         }
 
-        return {QueryStatus::Success, std::vector<uint8_t>(buffer, buffer + query_bytesRead)};
+        return {QueryStatus::Success, data};
     }
 
     return {QueryStatus::Error, {}};
 }
 
+// Read the query from a non-blocking client socket (used by the server reactor)
+QueryResult Socket::get_query_nonblocking(int socket_fd)
+{
+    std::vector<uint8_t> data;
+
+    while (true)
+    {
+        ssize_t query_bytesRead = socket_read_available(socket_fd, data);
+        if (query_bytesRead > 0)
+        {
+            return {QueryStatus::Success, data};
+        }
+        if (query_bytesRead == 0)
+        {
+            return {QueryStatus::Disconnected, {}};
+        }
+        if (errno == EINTR)
+        {
+            continue;
+        }
+        if (errno == EAGAIN || errno == EWOULDBLOCK)
+        {
+            return {QueryStatus::Timeout, {}};
+        }
+        return {QueryStatus::Error, {}};
+    }
+}
+
+QueryStatus Socket::get_query_nonblocking(int socket_fd, uint8_t *buffer, size_t capacity, size_t &received, std::vector<int> &received_fds)
+{
+    received = 0;
+    while (true)
+    {
+        ssize_t query_bytesRead = socket_receive_with_fds(socket_fd, buffer, capacity, received_fds, MSG_DONTWAIT);
+        if (query_bytesRead > 0)
+        {
+            received = static_cast<size_t>(query_bytesRead);
+            return QueryStatus::Success;
+        }
+        if (query_bytesRead == 0)
+        {
+            return QueryStatus::Disconnected;
+        }
+        if (errno == EINTR)
+        {
+            continue;
+        }
+        if (errno == EAGAIN || errno == EWOULDBLOCK)
+        {
+            return QueryStatus::Timeout;
+        }
+        return QueryStatus::Error;
+    }
+}
+
+QueryStatus Socket::get_query_nonblocking(int socket_fd, FrameDecoder &decoder, size_t &received, std::vector<int> &received_fds, size_t max_bytes)
+{
+    received = 0;
+    bool filled = false;
+    while (received < max_bytes)
+    {
+        // A short read empties the socket. Bytes arriving after it raise a new epoll wakeup, so
+        // there is no need to read on until EAGAIN.
+        size_t length = std::max<size_t>(decoder.free_space(), IPC_SOCKET_MIN_READ_SIZE);
+        if (filled)
+        {
+            // The last read filled the space, make room for whatever is still queued
+            size_t available = socket_available_bytes(socket_fd);
+            if (available == 0)
+            {
+                return QueryStatus::Success;
+            }
+            length = std::max(length, available);
+        }
+        length = std::min(length, max_bytes - received);
+
+        size_t fd_count = received_fds.size();
+        ssize_t query_bytesRead = socket_receive_with_fds(socket_fd, decoder.prepare(length), length, received_fds, MSG_DONTWAIT);
+        if (query_bytesRead > 0)
+        {
+            decoder.commit(static_cast<size_t>(query_bytesRead));
+            received += static_cast<size_t>(query_bytesRead);
+            // A read also ends at passed file descriptors, bytes may still be queued behind them
+            if (static_cast<size_t>(query_bytesRead) < length && received_fds.size() == fd_count)
+            {
+                return QueryStatus::Success;
+            }
+            filled = true;
+            continue;
+        }
+        if (query_bytesRead == 0)
+        {
+            return QueryStatus::Disconnected;
+        }
+        if (errno == EINTR)
+        {
+            continue;
+        }
+        if (errno == EAGAIN || errno == EWOULDBLOCK)
+        {
+            return received > 0 ? QueryStatus::Success : QueryStatus::Timeout;
+        }
+        return QueryStatus::Error;
+    }
+    return QueryStatus::Success;
+}
+
+bool Socket::set_non_blocking(int socket_fd)
+{
+    int flags = fcntl(socket_fd, F_GETFL, 0);
+    if (flags == -1 || fcntl(socket_fd, F_SETFL, flags | O_NONBLOCK) == -1)
+    {
+        std::cerr << "Socket: Failed to set fd " << socket_fd << " non-blocking: " << strerror(errno) << std::endl;
+        return false;
+    }
+    return true;
+}
+
+int Socket::send_buff_with_fds(int socket_fd, const uint8_t *buffer, int length, const int *fds, int fd_count)
+{
+    if (fd_count <= 0 || fd_count > IPC_SOCKET_MAX_PASSED_FDS)
+        return -1;
+
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int) * IPC_SOCKET_MAX_PASSED_FDS)] = {};
+    iovec iov{const_cast<uint8_t *>(buffer), static_cast<size_t>(length)};
+    msghdr msg{};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = CMSG_SPACE(sizeof(int) * fd_count);
+
+    cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(int) * fd_count);
+    memcpy(CMSG_DATA(cmsg), fds, sizeof(int) * fd_count);
+
+    while (true)
+    {
+        ssize_t sent = sendmsg(socket_fd, &msg, MSG_NOSIGNAL);
+        if (sent >= 0)
+            return static_cast<int>(sent);
+        if (errno != EINTR)
+        {
+            std::cerr << "Socket: sendmsg with fds failed: " << strerror(errno) << std::endl;
+            return -1;
+        }
+    }
+}
+
 // Send a response to the client
 int Socket::send_response(int socket_fd, std::vector<int> &resp_vector)
 {
@@ -439,8 +653,7 @@ int Socket::connect_to_socket(int socket_fd)
 int Socket::connect_to_socket(int socket_fd, std::string address)
 {
     // 设置 socket_path 为新的 address
-    this->socket_path = address.c_str();
-    init_socket_structor();
+    set_socket_path(address);
     return this->connect_to_socket(socket_fd);
 }
 
@@ -466,12 +679,7 @@ bool Socket::send_query(int socket_fd, const std::vector<int> &query_vector)
 
 bool Socket::send_query(int socket_fd, const std::vector<uint8_t> &query_vector)
 {
-    char query_buffer[query_vector.size()]; // Buffer for the query
-    for (int i = 0; i < query_vector.size(); i++)
-    {
-        query_buffer[i] = query_vector[i];
-    }
-    auto write_result = write(socket_fd, query_buffer, sizeof(query_buffer)); // Send the query
+    auto write_result = write(socket_fd, query_vector.data(), query_vector.size()); // Send the query, no staging copy
 
     // Handle errors in sending the query
     if (write_result == -1)
@@ -482,21 +690,80 @@ bool Socket::send_query(int socket_fd, const std::vector<uint8_t> &query_vector)
     }
     return true;
 }
+bool Socket::send_message(int socket_fd, const DataMessage &message)
+{
+    if (message.get_serialized_length() != message.get_total_length())
+        return send_query(socket_fd, message.serializeMessage()); // Trailing checksum, send the whole frame
+
+    uint8_t header[DataMessage::EXTENDED_HEADER_LENGTH];
+    message.serializeHeader(header);
+    size_t header_length = message.get_header_length();
+
+    iovec iov[2] = {{header, header_length},
+                    {const_cast<uint8_t *>(message.data.data()), message.data.size()}};
+    msghdr msg{};
+    msg.msg_iov = iov;
+    msg.msg_iovlen = message.data.empty() ? 1 : 2;
+    return send_all(socket_fd, msg, header_length + message.data.size());
+}
+
+bool Socket::send_frames(int socket_fd, const uint8_t *frames, size_t length)
+{
+    iovec iov = {const_cast<uint8_t *>(frames), length};
+    msghdr msg{};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    return send_all(socket_fd, msg, length);
+}
+
+bool Socket::send_all(int socket_fd, msghdr &msg, size_t remaining)
+{
+    while (remaining > 0)
+    {
+        ssize_t sent = sendmsg(socket_fd, &msg, MSG_NOSIGNAL);
+        if (sent == -1)
+        {
+            if (errno == EINTR)
+                continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                continue;
+            }
+            std::cerr << "Client: Could not write message to socket: " << strerror(errno) << std::endl;
+            close_socket(socket_fd);
+            return false;
+        }
+
+        // Partial write, skip the bytes already sent
+        remaining -= static_cast<size_t>(sent);
+        while (sent > 0)
+        {
+            size_t taken = std::min(static_cast<size_t>(sent), msg.msg_iov->iov_len);
+            msg.msg_iov->iov_base = static_cast<uint8_t *>(msg.msg_iov->iov_base) + taken;
+            msg.msg_iov->iov_len -= taken;
+            sent -= static_cast<ssize_t>(taken);
+            if (msg.msg_iov->iov_len == 0 && msg.msg_iovlen > 1)
+            {
+                msg.msg_iov++;
+                msg.msg_iovlen--;
+            }
+        }
+    }
+    return true;
+}
+
 // Receive the response from the server
 QueryResult Socket::get_response(int socket_fd)
 {
-    uint8_t result_buffer[IPC_SOCKET_RESPONSE_BUFFER_SIZE];
-
-    int resp_bytesRead = read(socket_fd, result_buffer, sizeof(result_buffer));
-    if (resp_bytesRead <= 0)
+    std::vector<uint8_t> data;
+    if (socket_read_available(socket_fd, data) <= 0)
     {
         std::cerr << "Client: Could not read response from server." << std::endl;
         close_socket(socket_fd);
         return {QueryStatus::Disconnected, {}};
     }
 
-    // Efficient conversion without loop
-    std::vector<uint8_t> data(result_buffer, result_buffer + resp_bytesRead);
     return {QueryStatus::Success, data};
 }
 
@@ -525,18 +792,88 @@ QueryResult Socket::get_response_with_epoll(int socket_fd, int timeout_ms)
         return {QueryStatus::Error, {}};
     }
 
-    uint8_t result_buffer[IPC_SOCKET_RESPONSE_BUFFER_SIZE];
-    int bytesRead = read(socket_fd, result_buffer, sizeof(result_buffer));
-
-    if (bytesRead <= 0)
+    std::vector<uint8_t> data;
+    if (socket_read_available(socket_fd, data) <= 0)
     {
         return {QueryStatus::Disconnected, {}};
     }
 
-    std::vector<uint8_t> data(result_buffer, result_buffer + bytesRead);
     return {QueryStatus::Success, data};
 }
 
+QueryStatus Socket::get_response_with_epoll(int socket_fd, int timeout_ms, uint8_t *buffer, size_t capacity, size_t &received, std::vector<int> &received_fds)
+{
+    received = 0;
+    init_epoll(socket_fd); // Lazy init
+    if (epoll_fd == -1)
+    {
+        return QueryStatus::Error;
+    }
+
+    epoll_event events[1];
+
+    int n = epoll_wait(epoll_fd, events, 1, timeout_ms);
+    if (n == -1)
+    {
+        return QueryStatus::Error;
+    }
+    else if (n == 0)
+    {
+        return QueryStatus::Timeout;
+    }
+
+    if (!(events[0].events & EPOLLIN))
+    {
+        return QueryStatus::Error;
+    }
+
+    ssize_t bytesRead = socket_receive_with_fds(socket_fd, buffer, capacity, received_fds);
+    if (bytesRead <= 0)
+    {
+        return QueryStatus::Disconnected;
+    }
+
+    received = static_cast<size_t>(bytesRead);
+    return QueryStatus::Success;
+}
+
+QueryStatus Socket::get_response_with_epoll(int socket_fd, int timeout_ms, FrameDecoder &decoder, size_t &received, std::vector<int> &received_fds)
+{
+    received = 0;
+    init_epoll(socket_fd); // Lazy init
+    if (epoll_fd == -1)
+    {
+        return QueryStatus::Error;
+    }
+
+    epoll_event events[1];
+
+    int n = epoll_wait(epoll_fd, events, 1, timeout_ms);
+    if (n == -1)
+    {
+        return QueryStatus::Error;
+    }
+    else if (n == 0)
+    {
+        return QueryStatus::Timeout;
+    }
+
+    // Edge-triggered: no further wakeup comes for the bytes already queued, read all of them
+    QueryStatus status = get_query_nonblocking(socket_fd, decoder, received, received_fds);
+    if (status == QueryStatus::Success && (events[0].events & (EPOLLHUP | EPOLLRDHUP | EPOLLERR)))
+    {
+        // Nor for a hang-up behind them, read up to it
+        size_t more = 0;
+        QueryStatus tail_status = get_query_nonblocking(socket_fd, decoder, more, received_fds);
+        received += more;
+        if (tail_status != QueryStatus::Timeout)
+        {
+            status = tail_status;
+        }
+    }
+    return status;
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 void Socket::printf_vector_bytes(const std::vector<uint8_t> &vec, int length)
@@ -29,6 +29,7 @@
 #include <chrono>
 #include <thread>
 #include <vector>
+#include <cstdint>
 #include <cstring>
 #include <string>
 #include <sys/stat.h>
@@ -36,11 +37,21 @@
 #include <sys/epoll.h>
 #include <unordered_map>
 #include "octopus_ipc_ptl.hpp" // Include custom IPC Protocol header (if needed)
+#include "octopus_ipc_frame_decoder.hpp"
 /////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 // Constants for buffer sizes
 #define IPC_SOCKET_RESPONSE_BUFFER_SIZE 255
 #define IPC_SOCKET_QUERY_BUFFER_SIZE 255
+#define IPC_SOCKET_MAX_PASSED_FDS 8 // Most file descriptors accepted in one message
+#define IPC_SOCKET_MIN_READ_SIZE 4096 // Smallest read into a frame decoder, the ring grows to provide it
+
+// Server endpoints. The SOCK_SEQPACKET one keeps message boundaries: every packet holds whole
+// frames, a receiver parses them in place and never reassembles a frame across reads.
+#define IPC_SOCKET_STREAM_PATH "/tmp/octopus/ipc_socket"
+#define IPC_SOCKET_SEQPACKET_PATH "/tmp/octopus/ipc_socket_seqpacket"
+// Receive buffer of a SOCK_SEQPACKET socket: the largest frame, a packet is cut beyond the buffer
+#define IPC_SOCKET_PACKET_BUFFER_SIZE (DataMessage::EXTENDED_HEADER_LENGTH + 0xFFFF + 1)
 
 // Structure to store active client information
 struct ClientInfo
@@ -94,7 +105,7 @@ namespace std
 class Socket
 {
 private:
-    const char *socket_path; // Path to the Unix domain socket (the address of the socket)
+    std::string socket_path; // Path to the Unix domain socket (the address of the socket)
     int domain;              // Socket domain (AF_UNIX for Unix domain sockets)
     int type;                // Socket type (SOCK_STREAM for stream-based communication)
     int protocol;            // Protocol (0 for default)
@@ -104,6 +115,9 @@ private:
     std::mutex epoll_mutex;   // Mutex to ensure thread safety during epoll initialization and operations
     bool epoll_initialized;   // Flag to indicate whether epoll has been initialized
 
+    // Writes the iovecs of msg until remaining bytes went out, see send_message()
+    bool send_all(int socket_fd, msghdr &msg, size_t remaining);
+
 public:
     // Constructor: Initializes socket parameters and sets default values
     Socket();
@@ -111,6 +125,13 @@ public:
     // Initializes the socket structure (setting domain, type, protocol, etc.)
     void init_socket_structor();
 
+    // Sets the Unix domain socket path bound by the server or connected to by the client.
+    void set_socket_path(const std::string &path);
+
+    // Sets the type used by open_socket(): SOCK_STREAM (default) or SOCK_SEQPACKET.
+    void set_socket_type(int socket_type);
+    int get_socket_type() const { return type; }
+
     // Initializes epoll for event-driven communication. This method should be called after opening a socket.
     void init_epoll(int socket_fd);
 
@@ -144,12 +165,35 @@ public:
     // Sends a response (buffer) to the client over the specified socket.
     int send_buff(int socket_fd, uint8_t *resp_buffer, int length);
 
+    // Sends a buffer together with file descriptors (SCM_RIGHTS) in one sendmsg().
+    // Returns the number of bytes sent, -1 on error.
+    int send_buff_with_fds(int socket_fd, const uint8_t *buffer, int length, const int *fds, int fd_count);
+
     // Retrieves a query from the client over the specified socket.
     QueryResult get_query(int socket_fd);
 
     // Retrieves a query from the client with epoll for non-blocking event-driven communication.
     QueryResult get_query_with_epoll(int socket_fd, int timeout_ms);
 
+    // Reads whatever the client has sent without waiting (socket must be non-blocking).
+    // Returns Timeout when no data is available yet.
+    QueryResult get_query_nonblocking(int socket_fd);
+
+    // Same as above, reads into the caller's buffer without allocating. received is set to the bytes read,
+    // file descriptors passed along with the data are appended to received_fds. Does not wait on a blocking
+    // socket either. On a SOCK_SEQPACKET socket a call reads one packet, a packet larger than capacity is an Error.
+    QueryStatus get_query_nonblocking(int socket_fd, uint8_t *buffer, size_t capacity, size_t &received, std::vector<int> &received_fds);
+
+    // Stream sockets: reads everything queued straight into the decoder, into its free space (at least
+    // IPC_SOCKET_MIN_READ_SIZE) until a short read, usually one read per call. Only a read filling the space
+    // asks FIONREAD how much is left. Stops after max_bytes. received is the number of bytes appended.
+    // Bytes read before a hang-up or an error are appended as well: decode them before acting on the status.
+    QueryStatus get_query_nonblocking(int socket_fd, FrameDecoder &decoder, size_t &received, std::vector<int> &received_fds,
+                                      size_t max_bytes = SIZE_MAX);
+
+    // Switches the specified socket to non-blocking mode.
+    bool set_non_blocking(int socket_fd);
+
     //////////////////////////////////////////////////////////////////////////////////////////////////////
     // Client-side socket functions (for connecting to server and sending queries)
 
@@ -165,12 +209,29 @@ public:
     // Sends a query to the server (client-side) using the specified socket file descriptor.
     bool send_query(int socket_fd, const std::vector<uint8_t> &query_vector);
 
+    // Sends a message with the header and the data as separate pieces of one sendmsg(), neither is
+    // copied into a frame first. Partial writes are resumed, the socket is closed on failure.
+    bool send_message(int socket_fd, const DataMessage &message);
+
+    // Sends serialized frames (e.g. one container frame) with a single sendmsg(), resumed and
+    // closed on failure like send_message().
+    bool send_frames(int socket_fd, const uint8_t *frames, size_t length);
+
     // Retrieves the response from the server for the specified socket.
     QueryResult get_response(int socket_fd);
 
     // Retrieves the response from the server with epoll for non-blocking event-driven communication.
     QueryResult get_response_with_epoll(int socket_fd, int timeout_ms = 100);
 
+    // Same as above, reads into the caller's buffer without allocating. received is set to the bytes read,
+    // file descriptors passed along with the data are appended to received_fds. On a SOCK_SEQPACKET
+    // socket a call reads one packet, a packet larger than capacity is an Error.
+    QueryStatus get_response_with_epoll(int socket_fd, int timeout_ms, uint8_t *buffer, size_t capacity, size_t &received, std::vector<int> &received_fds);
+
+    // Same as above for stream sockets, every queued byte is read into the decoder (see get_query_nonblocking()).
+    // The epoll registration is edge-triggered: the socket is always drained before returning.
+    QueryStatus get_response_with_epoll(int socket_fd, int timeout_ms, FrameDecoder &decoder, size_t &received, std::vector<int> &received_fds);
+
     // Prints the contents of a byte vector (used for debugging and logging).
     void printf_vector_bytes(const std::vector<uint8_t> &vec, int length);
 
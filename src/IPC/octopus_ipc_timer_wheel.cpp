@@ -0,0 +1,58 @@
+/**
+ * @file octopus_ipc_timer_wheel.cpp
+ * @brief Implementation of the hashed timer wheel.
+ *
+ * @author ak47
+ * @date 2026-10-16
+ */
+#include "octopus_ipc_timer_wheel.hpp"
+#include <algorithm>
+#include <iterator>
+
+OctopusTimerWheel::OctopusTimerWheel(uint32_t tick_ms, size_t slot_count, uint64_t now_ms)
+    : slots_(std::max<size_t>(slot_count, 1)),
+      tick_ms_(std::max<uint32_t>(tick_ms, 1)),
+      current_tick_(now_ms / std::max<uint32_t>(tick_ms, 1)),
+      timer_count_(0)
+{
+}
+
+void OctopusTimerWheel::schedule(uint64_t expire_ms, TimerCallback callback)
+{
+    // Never in the past: an already expired timer fires on the next tick
+    uint64_t expire_tick = std::max((expire_ms + tick_ms_ - 1) / tick_ms_, current_tick_ + 1);
+    slots_[expire_tick % slots_.size()].push_back({expire_tick, std::move(callback)});
+    timer_count_++;
+}
+
+size_t OctopusTimerWheel::advance(uint64_t now_ms)
+{
+    uint64_t target_tick = now_ms / tick_ms_;
+    size_t fired = 0;
+
+    // After a long stall one revolution visits every slot, no need to spin through the rest
+    if (target_tick > current_tick_ + slots_.size())
+        current_tick_ = target_tick - slots_.size();
+
+    std::vector<Timer> expired;
+    while (current_tick_ < target_tick)
+    {
+        current_tick_++;
+        std::vector<Timer> &slot = slots_[current_tick_ % slots_.size()];
+
+        // Keep the timers due in a later revolution, collect the expired ones
+        auto keep_end = std::partition(slot.begin(), slot.end(), [&](const Timer &timer)
+                                       { return timer.expire_tick > target_tick; });
+        std::move(keep_end, slot.end(), std::back_inserter(expired));
+        slot.erase(keep_end, slot.end());
+    }
+
+    // Callbacks run last, they may schedule new timers
+    timer_count_ -= expired.size();
+    for (Timer &timer : expired)
+    {
+        timer.callback();
+        fired++;
+    }
+    return fired;
+}
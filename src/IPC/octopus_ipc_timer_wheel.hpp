@@ -0,0 +1,70 @@
+/**
+ * @file octopus_ipc_timer_wheel.hpp
+ * @brief Hashed timer wheel for large numbers of short, coarse timers.
+ *
+ * Timers are hashed by their expiry tick into a fixed ring of slots. Scheduling is O(1), and
+ * advancing the wheel only visits the slots of the ticks that elapsed, however many timers are
+ * armed. Timers further away than one revolution simply stay in their slot for more rounds.
+ *
+ * The wheel is not thread safe and does not own a clock or a thread: its owner calls advance()
+ * with the current time, e.g. from a timerfd handler in a reactor.
+ *
+ * @author ak47
+ * @date 2026-10-16
+ */
+#ifndef OCTOPUS_IPC_TIMER_WHEEL_HPP
+#define OCTOPUS_IPC_TIMER_WHEEL_HPP
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+
+/**
+ * @class OctopusTimerWheel
+ * @brief Single level hashed timer wheel with a fixed tick.
+ */
+class OctopusTimerWheel
+{
+public:
+    using TimerCallback = std::function<void()>;
+
+    /**
+     * @brief Construct the wheel.
+     * @param tick_ms Resolution of the wheel in milliseconds.
+     * @param slot_count Number of slots, one revolution covers tick_ms * slot_count.
+     * @param now_ms Current time in milliseconds.
+     */
+    OctopusTimerWheel(uint32_t tick_ms, size_t slot_count, uint64_t now_ms);
+
+    /**
+     * @brief Arms a one-shot timer.
+     * @param expire_ms Absolute expiry time in milliseconds, rounded up to the next tick.
+     * @param callback Called from advance() once the timer expired.
+     */
+    void schedule(uint64_t expire_ms, TimerCallback callback);
+
+    /**
+     * @brief Runs the callbacks of every timer expired up to now_ms.
+     * @return Number of callbacks run.
+     */
+    size_t advance(uint64_t now_ms);
+
+    size_t size() const { return timer_count_; }
+    bool empty() const { return timer_count_ == 0; }
+    uint32_t get_tick_ms() const { return tick_ms_; }
+
+private:
+    struct Timer
+    {
+        uint64_t expire_tick;   ///< Absolute tick the timer expires on
+        TimerCallback callback; ///< Action to run
+    };
+
+    std::vector<std::vector<Timer>> slots_; ///< Timers hashed by expire_tick % slot count
+    uint32_t tick_ms_;                      ///< Wheel resolution
+    uint64_t current_tick_;                 ///< Last tick processed by advance()
+    size_t timer_count_;                    ///< Number of armed timers
+};
+
+#endif // OCTOPUS_IPC_TIMER_WHEEL_HPP
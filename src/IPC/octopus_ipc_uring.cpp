@@ -0,0 +1,446 @@
+/**
+ * @file octopus_ipc_uring.cpp
+ * @brief Implementation of the raw system call io_uring ring.
+ *
+ * @author ak47
+ * @date 2026-10-16
+ */
+#include "octopus_ipc_uring.hpp"
+#include <iostream>
+#include <algorithm>
+#include <cstring>
+#include <cstdio>
+#include <cerrno>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/utsname.h>
+#if defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#endif
+#endif
+
+// Multishot accept and receive are the oldest features relied on (headers of Linux 6.0)
+#if defined(IORING_RECV_MULTISHOT) && defined(IORING_ACCEPT_MULTISHOT) && defined(__NR_io_uring_setup)
+#define URING_SUPPORTED 1
+#endif
+
+#define URING_MIN_KERNEL_MAJOR 6 // Multishot recvmsg with provided buffer rings
+#define URING_MIN_KERNEL_MINOR 0
+
+OctopusUring::OctopusUring()
+    : ring_fd_(-1),
+      features_(0),
+      sq_ring_(nullptr), sq_ring_size_(0),
+      cq_ring_(nullptr), cq_ring_size_(0),
+      sqes_(nullptr), sqes_size_(0),
+      sq_head_(nullptr), sq_tail_(nullptr), sq_array_(nullptr),
+      sq_mask_(0), sq_entries_(0), sq_local_tail_(0),
+      cq_head_(nullptr), cq_tail_(nullptr), cq_mask_(0), cqes_(nullptr),
+      buffer_ring_(nullptr), buffer_ring_size_(0),
+      buffer_count_(0), buffer_size_(0), buffer_group_(0), buffer_tail_(0)
+{
+}
+
+OctopusUring::~OctopusUring()
+{
+    close();
+}
+
+void OctopusUring::close()
+{
+    // Closing the ring also unregisters the provided buffers
+    if (ring_fd_ >= 0)
+        ::close(ring_fd_);
+    if (sqes_)
+        munmap(sqes_, sqes_size_);
+    if (cq_ring_ && cq_ring_ != sq_ring_)
+        munmap(cq_ring_, cq_ring_size_);
+    if (sq_ring_)
+        munmap(sq_ring_, sq_ring_size_);
+    if (buffer_ring_)
+        munmap(buffer_ring_, buffer_ring_size_);
+
+    ring_fd_ = -1;
+    sqes_ = cq_ring_ = sq_ring_ = buffer_ring_ = nullptr;
+    buffers_.clear();
+    buffers_.shrink_to_fit();
+}
+
+#ifdef URING_SUPPORTED
+
+bool OctopusUring::open(unsigned entries)
+{
+    if (ring_fd_ >= 0)
+        return true;
+
+    utsname name;
+    int major = 0, minor = 0;
+    if (uname(&name) == 0)
+        sscanf(name.release, "%d.%d", &major, &minor);
+    if (major < URING_MIN_KERNEL_MAJOR || (major == URING_MIN_KERNEL_MAJOR && minor < URING_MIN_KERNEL_MINOR))
+    {
+        std::cerr << "[Uring] Kernel " << name.release << " lacks multishot receives." << std::endl;
+        return false;
+    }
+
+    io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    params.flags = IORING_SETUP_CQSIZE | IORING_SETUP_COOP_TASKRUN;
+    params.cq_entries = entries * 4; // Multishot operations complete many times per submission
+    int fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+    if (fd < 0 && errno == EINVAL)
+    {
+        // Kernel without cooperative task running
+        memset(&params, 0, sizeof(params));
+        params.flags = IORING_SETUP_CQSIZE;
+        params.cq_entries = entries * 4;
+        fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+    }
+    if (fd < 0)
+    {
+        // ENOSYS: not built in, EPERM: disabled (kernel.io_uring_disabled, seccomp)
+        std::cerr << "[Uring] io_uring_setup failed: " << strerror(errno) << std::endl;
+        return false;
+    }
+    ring_fd_ = fd;
+    features_ = params.features;
+
+    sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    if (features_ & IORING_FEAT_SINGLE_MMAP)
+        sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+
+    void *address = mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    if (address == MAP_FAILED)
+    {
+        std::cerr << "[Uring] mmap of the submission ring failed: " << strerror(errno) << std::endl;
+        close();
+        return false;
+    }
+    sq_ring_ = address;
+
+    if (features_ & IORING_FEAT_SINGLE_MMAP)
+    {
+        cq_ring_ = sq_ring_;
+    }
+    else
+    {
+        address = mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+        if (address == MAP_FAILED)
+        {
+            std::cerr << "[Uring] mmap of the completion ring failed: " << strerror(errno) << std::endl;
+            close();
+            return false;
+        }
+        cq_ring_ = address;
+    }
+
+    sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+    address = mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+    if (address == MAP_FAILED)
+    {
+        std::cerr << "[Uring] mmap of the submission entries failed: " << strerror(errno) << std::endl;
+        close();
+        return false;
+    }
+    sqes_ = address;
+
+    uint8_t *sq = static_cast<uint8_t *>(sq_ring_);
+    uint8_t *cq = static_cast<uint8_t *>(cq_ring_);
+    sq_head_ = reinterpret_cast<unsigned *>(sq + params.sq_off.head);
+    sq_tail_ = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+    sq_array_ = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+    sq_mask_ = *reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+    sq_entries_ = params.sq_entries;
+    sq_local_tail_ = *sq_tail_;
+    cq_head_ = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+    cq_tail_ = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+    cq_mask_ = *reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+    cqes_ = cq + params.cq_off.cqes;
+
+    // Submission entry i always sits in array slot i
+    for (unsigned i = 0; i < sq_entries_; ++i)
+        sq_array_[i] = i;
+    return true;
+}
+
+bool OctopusUring::register_buffers(uint16_t group, unsigned count, unsigned size)
+{
+    if (ring_fd_ < 0 || count == 0 || (count & (count - 1)) != 0 || count > 32768)
+        return false;
+
+    buffer_ring_size_ = count * sizeof(io_uring_buf);
+    void *address = mmap(nullptr, buffer_ring_size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (address == MAP_FAILED)
+    {
+        std::cerr << "[Uring] mmap of the buffer ring failed: " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    io_uring_buf_reg registration;
+    memset(&registration, 0, sizeof(registration));
+    registration.ring_addr = reinterpret_cast<uintptr_t>(address);
+    registration.ring_entries = count;
+    registration.bgid = group;
+    if (syscall(__NR_io_uring_register, ring_fd_, IORING_REGISTER_PBUF_RING, &registration, 1) < 0)
+    {
+        std::cerr << "[Uring] Registering the buffer ring failed: " << strerror(errno) << std::endl;
+        munmap(address, buffer_ring_size_);
+        return false;
+    }
+
+    buffer_ring_ = address;
+    buffer_count_ = count;
+    buffer_size_ = size;
+    buffer_group_ = group;
+    buffer_tail_ = 0;
+    buffers_.assign(static_cast<size_t>(count) * size, 0);
+    for (unsigned i = 0; i < count; ++i)
+        recycle_buffer(static_cast<uint16_t>(i));
+    return true;
+}
+
+void OctopusUring::recycle_buffer(uint16_t buffer_id)
+{
+    // Not io_uring_buf_ring::bufs: in C++ its flexible array sits behind an empty struct of size 1.
+    // The ring tail overlays resv of the first entry.
+    io_uring_buf *ring = static_cast<io_uring_buf *>(buffer_ring_);
+    io_uring_buf &buffer = ring[buffer_tail_ & (buffer_count_ - 1)];
+    buffer.addr = reinterpret_cast<uintptr_t>(get_buffer(buffer_id));
+    buffer.len = buffer_size_;
+    buffer.bid = buffer_id;
+    buffer_tail_++;
+    __atomic_store_n(&ring[0].resv, buffer_tail_, __ATOMIC_RELEASE);
+}
+
+bool OctopusUring::reserve(unsigned count)
+{
+    if (sq_local_tail_ - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE) + count <= sq_entries_)
+        return true;
+    if (submit_and_wait(0) < 0)
+        return false;
+    return sq_local_tail_ - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE) + count <= sq_entries_;
+}
+
+void *OctopusUring::get_sqe()
+{
+    unsigned head = __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+    if (sq_local_tail_ - head >= sq_entries_)
+    {
+        // Full: hand the prepared entries to the kernel to make room
+        if (submit_and_wait(0) < 0)
+            return nullptr;
+        head = __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+        if (sq_local_tail_ - head >= sq_entries_)
+            return nullptr;
+    }
+
+    io_uring_sqe *sqe = static_cast<io_uring_sqe *>(sqes_) + (sq_local_tail_ & sq_mask_);
+    memset(sqe, 0, sizeof(*sqe));
+    sq_local_tail_++;
+    return sqe;
+}
+
+bool OctopusUring::prep_poll(int fd, uint32_t events, uint64_t user_data)
+{
+    io_uring_sqe *sqe = static_cast<io_uring_sqe *>(get_sqe());
+    if (!sqe)
+        return false;
+#if __BYTE_ORDER == __BIG_ENDIAN
+    events = (events << 16) | (events >> 16);
+#endif
+    sqe->opcode = IORING_OP_POLL_ADD;
+    sqe->fd = fd;
+    sqe->poll32_events = events;
+    sqe->user_data = user_data;
+    return true;
+}
+
+bool OctopusUring::prep_poll_update(uint64_t poll_user_data, uint32_t events, uint64_t user_data)
+{
+    io_uring_sqe *sqe = static_cast<io_uring_sqe *>(get_sqe());
+    if (!sqe)
+        return false;
+#if __BYTE_ORDER == __BIG_ENDIAN
+    events = (events << 16) | (events >> 16);
+#endif
+    sqe->opcode = IORING_OP_POLL_REMOVE;
+    sqe->fd = -1;
+    sqe->addr = poll_user_data;
+    sqe->len = IORING_POLL_UPDATE_EVENTS;
+    sqe->poll32_events = events;
+    sqe->user_data = user_data;
+    return true;
+}
+
+bool OctopusUring::prep_accept(int fd, uint64_t user_data)
+{
+    io_uring_sqe *sqe = static_cast<io_uring_sqe *>(get_sqe());
+    if (!sqe)
+        return false;
+    sqe->opcode = IORING_OP_ACCEPT;
+    sqe->fd = fd;
+    sqe->accept_flags = SOCK_CLOEXEC;
+    sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+    sqe->user_data = user_data;
+    return true;
+}
+
+bool OctopusUring::prep_recvmsg(int fd, msghdr *msg, uint64_t user_data)
+{
+    io_uring_sqe *sqe = static_cast<io_uring_sqe *>(get_sqe());
+    if (!sqe)
+        return false;
+    sqe->opcode = IORING_OP_RECVMSG;
+    sqe->fd = fd;
+    sqe->addr = reinterpret_cast<uintptr_t>(msg);
+    sqe->len = 1;
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = buffer_group_;
+    sqe->user_data = user_data;
+    return true;
+}
+
+bool OctopusUring::prep_read(int fd, void *buffer, size_t length, uint64_t user_data)
+{
+    io_uring_sqe *sqe = static_cast<io_uring_sqe *>(get_sqe());
+    if (!sqe)
+        return false;
+    sqe->opcode = IORING_OP_READ;
+    sqe->fd = fd;
+    sqe->addr = reinterpret_cast<uintptr_t>(buffer);
+    sqe->len = static_cast<uint32_t>(length);
+    sqe->off = static_cast<uint64_t>(-1); // Current position, the fd is not seekable
+    sqe->user_data = user_data;
+    return true;
+}
+
+bool OctopusUring::prep_send(int fd, const void *data, size_t length, bool link, uint64_t user_data)
+{
+    io_uring_sqe *sqe = static_cast<io_uring_sqe *>(get_sqe());
+    if (!sqe)
+        return false;
+    sqe->opcode = IORING_OP_SEND;
+    sqe->fd = fd;
+    sqe->addr = reinterpret_cast<uintptr_t>(data);
+    sqe->len = static_cast<uint32_t>(length);
+    sqe->msg_flags = MSG_NOSIGNAL | MSG_WAITALL; // A short send would break the chain
+    sqe->flags = link ? IOSQE_IO_LINK : 0;
+    sqe->user_data = user_data;
+    return true;
+}
+
+bool OctopusUring::prep_cancel(uint64_t target_user_data, uint64_t user_data)
+{
+    io_uring_sqe *sqe = static_cast<io_uring_sqe *>(get_sqe());
+    if (!sqe)
+        return false;
+    sqe->opcode = IORING_OP_ASYNC_CANCEL;
+    sqe->fd = -1;
+    sqe->addr = target_user_data;
+    sqe->cancel_flags = IORING_ASYNC_CANCEL_ALL;
+    sqe->user_data = user_data;
+    return true;
+}
+
+int OctopusUring::submit_and_wait(unsigned wait_count)
+{
+    // Everything prepared but not consumed by the kernel yet
+    unsigned to_submit = sq_local_tail_ - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+    __atomic_store_n(sq_tail_, sq_local_tail_, __ATOMIC_RELEASE);
+    if (to_submit == 0 && wait_count == 0)
+        return 0;
+
+    unsigned flags = (wait_count > 0) ? IORING_ENTER_GETEVENTS : 0;
+    long result = syscall(__NR_io_uring_enter, ring_fd_, to_submit, wait_count, flags, nullptr, 0);
+    return (result < 0) ? -errno : static_cast<int>(result);
+}
+
+size_t OctopusUring::reap(OctopusUringCompletion *completions, size_t max)
+{
+    unsigned head = *cq_head_;
+    unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+    size_t count = 0;
+    for (; head != tail && count < max; ++head, ++count)
+    {
+        const io_uring_cqe &cqe = static_cast<const io_uring_cqe *>(cqes_)[head & cq_mask_];
+        completions[count] = {cqe.user_data, cqe.res, cqe.flags};
+    }
+    __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+    return count;
+}
+
+int OctopusUring::get_buffer_id(uint32_t flags)
+{
+    return (flags & IORING_CQE_F_BUFFER) ? static_cast<int>(flags >> IORING_CQE_BUFFER_SHIFT) : -1;
+}
+
+bool OctopusUring::has_more(uint32_t flags)
+{
+    return (flags & IORING_CQE_F_MORE) != 0;
+}
+
+bool OctopusUring::parse_recvmsg(const uint8_t *buffer, size_t length, const msghdr &msg,
+                                 const uint8_t **payload, size_t *payload_length, std::vector<int> &fds)
+{
+    // [io_uring_recvmsg_out][name: msg_namelen][control: msg_controllen][payload]
+    size_t header_length = sizeof(io_uring_recvmsg_out) + msg.msg_namelen + msg.msg_controllen;
+    if (length < header_length)
+        return false;
+
+    io_uring_recvmsg_out out;
+    memcpy(&out, buffer, sizeof(out));
+    *payload = buffer + header_length;
+    *payload_length = std::min<size_t>(out.payloadlen, length - header_length);
+
+    if (out.controllen > 0)
+    {
+        msghdr control{};
+        control.msg_control = const_cast<uint8_t *>(buffer + sizeof(io_uring_recvmsg_out) + msg.msg_namelen);
+        control.msg_controllen = std::min<size_t>(out.controllen, msg.msg_controllen);
+        for (cmsghdr *cmsg = CMSG_FIRSTHDR(&control); cmsg; cmsg = CMSG_NXTHDR(&control, cmsg))
+        {
+            if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS)
+                continue;
+            size_t count = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+            const uint8_t *data = CMSG_DATA(cmsg);
+            for (size_t i = 0; i < count; ++i)
+            {
+                int fd;
+                memcpy(&fd, data + i * sizeof(int), sizeof(int));
+                fds.push_back(fd);
+            }
+        }
+    }
+    return true;
+}
+
+#else // Headers without multishot io_uring: always fall back to epoll
+
+bool OctopusUring::open(unsigned)
+{
+    std::cerr << "[Uring] Built without io_uring support." << std::endl;
+    return false;
+}
+
+bool OctopusUring::register_buffers(uint16_t, unsigned, unsigned) { return false; }
+void OctopusUring::recycle_buffer(uint16_t) {}
+bool OctopusUring::reserve(unsigned) { return false; }
+void *OctopusUring::get_sqe() { return nullptr; }
+bool OctopusUring::prep_poll(int, uint32_t, uint64_t) { return false; }
+bool OctopusUring::prep_poll_update(uint64_t, uint32_t, uint64_t) { return false; }
+bool OctopusUring::prep_accept(int, uint64_t) { return false; }
+bool OctopusUring::prep_recvmsg(int, msghdr *, uint64_t) { return false; }
+bool OctopusUring::prep_read(int, void *, size_t, uint64_t) { return false; }
+bool OctopusUring::prep_send(int, const void *, size_t, bool, uint64_t) { return false; }
+bool OctopusUring::prep_cancel(uint64_t, uint64_t) { return false; }
+int OctopusUring::submit_and_wait(unsigned) { return -ENOSYS; }
+size_t OctopusUring::reap(OctopusUringCompletion *, size_t) { return 0; }
+int OctopusUring::get_buffer_id(uint32_t) { return -1; }
+bool OctopusUring::has_more(uint32_t) { return false; }
+bool OctopusUring::parse_recvmsg(const uint8_t *, size_t, const msghdr &, const uint8_t **, size_t *, std::vector<int> &) { return false; }
+
+#endif // URING_SUPPORTED
@@ -0,0 +1,147 @@
+/**
+ * @file octopus_ipc_uring.hpp
+ * @brief Minimal io_uring ring driven with raw system calls (no liburing).
+ *
+ * Wraps the submission and completion rings of one io_uring instance and a ring of provided
+ * receive buffers. Only the operations the reactor needs are exposed: poll, multishot accept,
+ * multishot recvmsg into provided buffers, read, (linked) send and cancel.
+ *
+ * The kernel ABI stays in the implementation file. When the headers or the running kernel lack
+ * what is needed (multishot receives need Linux 6.0), open() fails and the caller keeps using
+ * epoll.
+ *
+ * Not thread safe: a ring is driven by a single thread.
+ *
+ * @author ak47
+ * @date 2026-10-16
+ */
+#ifndef OCTOPUS_IPC_URING_HPP
+#define OCTOPUS_IPC_URING_HPP
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <sys/socket.h>
+
+// One entry of the completion ring, copied out of the shared memory
+struct OctopusUringCompletion
+{
+    uint64_t user_data; ///< Value passed when the operation was prepared
+    int32_t res;        ///< Result, -errno on failure
+    uint32_t flags;     ///< IORING_CQE_F_* flags
+};
+
+/**
+ * @class OctopusUring
+ * @brief One io_uring instance with its rings mapped, plus an optional provided buffer ring.
+ */
+class OctopusUring
+{
+public:
+    OctopusUring();
+    ~OctopusUring();
+
+    OctopusUring(const OctopusUring &) = delete;
+    OctopusUring &operator=(const OctopusUring &) = delete;
+
+    /**
+     * @brief Creates the ring and maps it.
+     * @param entries Submission queue size, the completion queue gets four times as many.
+     * @return false if io_uring is unavailable, the reason is logged.
+     */
+    bool open(unsigned entries);
+    void close();
+    bool is_open() const { return ring_fd_ >= 0; }
+
+    /**
+     * @brief Registers count buffers of size bytes as provided buffer group group.
+     * @param count Number of buffers, a power of two.
+     */
+    bool register_buffers(uint16_t group, unsigned count, unsigned size);
+
+    /**
+     * @brief Returns a provided buffer picked by the kernel to the ring.
+     */
+    void recycle_buffer(uint16_t buffer_id);
+
+    /**
+     * @brief Makes sure count operations can be prepared without an intermediate submit, so a
+     *        linked chain reaches the kernel in one piece.
+     */
+    bool reserve(unsigned count);
+
+    uint8_t *get_buffer(uint16_t buffer_id) { return buffers_.data() + static_cast<size_t>(buffer_id) * buffer_size_; }
+
+    /// Single shot poll, res is the ready event mask.
+    bool prep_poll(int fd, uint32_t events, uint64_t user_data);
+    /// Changes the event mask of an armed poll in place.
+    bool prep_poll_update(uint64_t poll_user_data, uint32_t events, uint64_t user_data);
+    /// Multishot accept, one completion per accepted connection (res is the new fd).
+    bool prep_accept(int fd, uint64_t user_data);
+    /// Multishot recvmsg into the provided buffers of the registered group.
+    bool prep_recvmsg(int fd, msghdr *msg, uint64_t user_data);
+    bool prep_read(int fd, void *buffer, size_t length, uint64_t user_data);
+    /// link: the next prepared operation only starts once this one fully succeeded.
+    bool prep_send(int fd, const void *data, size_t length, bool link, uint64_t user_data);
+    /// Cancels every operation submitted with target_user_data.
+    bool prep_cancel(uint64_t target_user_data, uint64_t user_data);
+
+    /**
+     * @brief Submits the prepared operations and waits for wait_count completions.
+     * @return Number of operations submitted, -errno on failure.
+     */
+    int submit_and_wait(unsigned wait_count);
+
+    /**
+     * @brief Moves up to max completions out of the completion ring.
+     * @return Number of completions copied.
+     */
+    size_t reap(OctopusUringCompletion *completions, size_t max);
+
+    /// Provided buffer a completion consumed, -1 if none.
+    static int get_buffer_id(uint32_t flags);
+    /// The operation stays armed and will complete again (multishot).
+    static bool has_more(uint32_t flags);
+
+    /**
+     * @brief Locates the payload and passed descriptors in a multishot recvmsg buffer.
+     * @param msg The msghdr the recvmsg was prepared with.
+     * @param fds Receives the SCM_RIGHTS descriptors.
+     * @return false if the buffer layout is invalid.
+     */
+    static bool parse_recvmsg(const uint8_t *buffer, size_t length, const msghdr &msg,
+                              const uint8_t **payload, size_t *payload_length, std::vector<int> &fds);
+
+private:
+    void *get_sqe();
+
+    int ring_fd_;
+    unsigned features_;
+    void *sq_ring_;        ///< Mapped submission ring
+    size_t sq_ring_size_;
+    void *cq_ring_;        ///< Mapped completion ring, may be sq_ring_ (single mmap)
+    size_t cq_ring_size_;
+    void *sqes_;           ///< Mapped submission entries
+    size_t sqes_size_;
+
+    unsigned *sq_head_;
+    unsigned *sq_tail_;
+    unsigned *sq_array_;
+    unsigned sq_mask_;
+    unsigned sq_entries_;
+    unsigned sq_local_tail_; ///< Entries prepared, published to the kernel on submit
+    unsigned *cq_head_;
+    unsigned *cq_tail_;
+    unsigned cq_mask_;
+    void *cqes_;
+
+    void *buffer_ring_;            ///< Provided buffer ring shared with the kernel
+    size_t buffer_ring_size_;
+    unsigned buffer_count_;
+    unsigned buffer_size_;
+    uint16_t buffer_group_;
+    uint16_t buffer_tail_;         ///< Local tail of the provided buffer ring
+    std::vector<uint8_t> buffers_; ///< Storage of the provided buffers
+};
+
+#endif // OCTOPUS_IPC_URING_HPP
@@ -0,0 +1,120 @@
+/**
+ * @file octopus_test_outbound_queue.cpp
+ * @brief Slow reader test of the latest-value mailboxes of OutboundQueue.
+ *
+ * State topics are pushed at a high rate into the queue of a socket nobody reads. The queued bytes
+ * must stay bounded by one pending value per mailbox plus the frame the socket took part of,
+ * however many values are pushed. Once the reader drains, it must get the newest value of every
+ * topic. Runs with and without container packing.
+ *
+ * @author ak47
+ * @date 2026-10-16
+ */
+#include "octopus_ipc_outbound_queue.hpp"
+#include "octopus_ipc_frame_decoder.hpp"
+#include <iostream>
+#include <algorithm>
+#include <map>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/socket.h>
+
+#define TEST_TOPIC_COUNT 4        // State topics, one mailbox each
+#define TEST_PUSH_COUNT 200000    // Values pushed per topic
+#define TEST_PAYLOAD_SIZE 64      // Payload of a state frame
+#define TEST_SOCKET_BUFFER 4096   // Send buffer of the unread socket
+
+static OutboundFrame test_make_frame(uint8_t msg_id, uint32_t value)
+{
+    DataMessage message;
+    message.msg_header = DataMessage::_HEADER_;
+    message.msg_group = MSG_GROUP_CAR;
+    message.msg_id = msg_id;
+    message.request_id = 0;
+    std::vector<uint8_t> payload(TEST_PAYLOAD_SIZE, 0);
+    for (int i = 0; i < 4; ++i)
+        payload[i] = static_cast<uint8_t>(value >> (24 - 8 * i));
+    message.data = payload;
+    message.msg_length = static_cast<uint16_t>(payload.size());
+    return make_outbound_frame(message.serializeMessage());
+}
+
+static bool test_slow_reader(bool containers)
+{
+    int sockets[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, sockets) == -1)
+    {
+        std::cerr << "socketpair failed" << std::endl;
+        return false;
+    }
+    int buffer_size = TEST_SOCKET_BUFFER;
+    setsockopt(sockets[0], SOL_SOCKET, SO_SNDBUF, &buffer_size, sizeof(buffer_size));
+    fcntl(sockets[0], F_SETFL, O_NONBLOCK);
+    fcntl(sockets[1], F_SETFL, O_NONBLOCK);
+
+    OutboundQueue queue(1024 * 1024, SlowConsumerPolicy::DropOldest);
+    queue.set_containers(containers);
+    const size_t frame_size = test_make_frame(0, 0)->size();
+    const size_t bound = (TEST_TOPIC_COUNT + 1) * frame_size;
+    size_t max_queued = 0;
+    bool ok = true;
+
+    // Nobody reads: the socket fills up and every further value has to replace a pending one
+    for (uint32_t value = 1; value <= TEST_PUSH_COUNT && ok; ++value)
+    {
+        for (uint8_t topic = 0; topic < TEST_TOPIC_COUNT; ++topic)
+            queue.push_latest(test_make_frame(topic, value), topic);
+        if (queue.flush(sockets[0]) == OutboundFlushResult::Error)
+        {
+            std::cerr << "flush failed" << std::endl;
+            ok = false;
+        }
+        max_queued = std::max(max_queued, queue.get_queued_bytes());
+        if (queue.get_queued_bytes() > bound)
+        {
+            std::cerr << "queued " << queue.get_queued_bytes() << " bytes after " << value
+                      << " pushes, bound " << bound << std::endl;
+            ok = false;
+        }
+    }
+
+    // Drain: the last value of every topic must arrive
+    FrameDecoder decoder;
+    std::map<uint8_t, uint32_t> latest;
+    uint8_t buffer[TEST_SOCKET_BUFFER * 4];
+    for (;;)
+    {
+        OutboundFlushResult result = queue.flush(sockets[0]);
+        ssize_t length = read(sockets[1], buffer, sizeof(buffer));
+        if (length > 0)
+        {
+            decoder.feed(buffer, static_cast<size_t>(length));
+            DataMessageView view;
+            while (decoder.next(view))
+                latest[view.msg_id] = (view.data[0] << 24) | (view.data[1] << 16) | (view.data[2] << 8) | view.data[3];
+        }
+        else if (result != OutboundFlushResult::Pending)
+            break;
+    }
+    for (uint8_t topic = 0; topic < TEST_TOPIC_COUNT; ++topic)
+    {
+        if (latest[topic] != TEST_PUSH_COUNT)
+        {
+            std::cerr << "topic " << int(topic) << " ended with value " << latest[topic] << std::endl;
+            ok = false;
+        }
+    }
+
+    std::cout << (containers ? "containers: " : "plain frames: ") << "max queued " << max_queued
+              << " bytes, bound " << bound << (ok ? " OK" : " FAILED") << std::endl;
+    close(sockets[0]);
+    close(sockets[1]);
+    return ok;
+}
+
+int main()
+{
+    bool ok = test_slow_reader(false);
+    ok = test_slow_reader(true) && ok;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,91 @@
+/**
+ * @file octopus_test_snapshot_exchange.cpp
+ * @brief Torn read stress test of OctopusSnapshotExchange.
+ *
+ * Writer threads publish self-consistent snapshots (every word holds the same stamp) as fast as
+ * they can while reader threads copy them. Every copy must be whole, and the versions a reader
+ * sees must never go backwards.
+ *
+ * @author ak47
+ * @date 2026-10-16
+ */
+#include "octopus_ipc_snapshot_exchange.hpp"
+#include <iostream>
+#include <vector>
+#include <atomic>
+#include <thread>
+
+#define TEST_WRITER_COUNT 2             // Concurrent publishers
+#define TEST_READER_COUNT 4             // Concurrent readers
+#define TEST_PUBLISH_COUNT 500000       // Snapshots published by each writer
+#define TEST_SNAPSHOT_WORDS 60          // Size of a snapshot, larger than a cache line
+
+struct TestSnapshot
+{
+    uint64_t stamp;
+    uint64_t words[TEST_SNAPSHOT_WORDS];
+    uint64_t check; // ~stamp
+};
+
+int main()
+{
+    OctopusSnapshotExchange<TestSnapshot> exchange;
+    std::atomic<int> writers_running{TEST_WRITER_COUNT};
+    std::atomic<uint64_t> torn_reads{0};
+    std::atomic<uint64_t> version_regressions{0};
+    std::atomic<uint64_t> reads{0};
+
+    std::vector<std::thread> threads;
+    for (int w = 0; w < TEST_WRITER_COUNT; ++w)
+    {
+        threads.emplace_back([&, w]()
+                             {
+            TestSnapshot snapshot;
+            for (uint64_t i = 1; i <= TEST_PUBLISH_COUNT; ++i)
+            {
+                uint64_t stamp = (i << 8) | static_cast<uint64_t>(w);
+                snapshot.stamp = stamp;
+                for (uint64_t &word : snapshot.words)
+                    word = stamp;
+                snapshot.check = ~stamp;
+                exchange.publish(snapshot);
+            }
+            writers_running--; });
+    }
+
+    for (int r = 0; r < TEST_READER_COUNT; ++r)
+    {
+        threads.emplace_back([&]()
+                             {
+            TestSnapshot snapshot;
+            uint64_t last_version = 0;
+            uint64_t count = 0;
+            while (writers_running.load() > 0)
+            {
+                uint64_t version;
+                if (!exchange.read(snapshot, &version))
+                    continue;
+                count++;
+
+                bool whole = snapshot.check == ~snapshot.stamp;
+                for (uint64_t word : snapshot.words)
+                    whole = whole && word == snapshot.stamp;
+                if (!whole)
+                    torn_reads++;
+                if (version < last_version)
+                    version_regressions++;
+                last_version = version;
+            }
+            reads += count; });
+    }
+
+    for (std::thread &thread : threads)
+        thread.join();
+
+    uint64_t expected_version = static_cast<uint64_t>(TEST_WRITER_COUNT) * TEST_PUBLISH_COUNT;
+    bool ok = torn_reads == 0 && version_regressions == 0 && exchange.get_version() == expected_version;
+    std::cout << "snapshot exchange: " << reads << " reads, " << torn_reads << " torn, "
+              << version_regressions << " version regressions, version " << exchange.get_version()
+              << " of " << expected_version << (ok ? " OK" : " FAILED") << std::endl;
+    return ok ? 0 : 1;
+}